@@ -2,6 +2,7 @@
 #extension GL_EXT_buffer_reference : require
 #extension GL_EXT_buffer_reference2 : require
 #extension GL_EXT_shader_explicit_arithmetic_types_int64 : require
+#extension GL_EXT_nonuniform_qualifier : require
 
 
 const float M_PI = 3.1415926538;
@@ -29,8 +30,9 @@ struct Material {
 struct Object_data {
     mat4 world_matrix;
     mat4 normal_matrix;
+    uint64_t dynamic_verticies;
+    uint dynamic_first_vertex;
     uint material_offset;
-    vec3 padding;
 };
 
 struct Light{
@@ -45,16 +47,18 @@ layout(buffer_reference, std430) readonly buffer ObjectBuffer { Object_data data
 layout(buffer_reference, std430) readonly buffer MaterialBuffer { Material data[]; };
 layout(buffer_reference, std430) readonly buffer CameraBuffer { Camera_data data[]; };
 layout(buffer_reference, std430) readonly buffer LightBuffer { Light data[]; };
+layout(buffer_reference, std430) readonly buffer InstanceBuffer { uint ids[]; };
 
-layout(set = 0, binding = 0) uniform sampler2D textures[1000];
+layout(set = 0, binding = 0) uniform samplerCube samplerCubeMap;
 
-layout(set = 0, binding = 1) uniform samplerCube samplerCubeMap;
+layout(set = 0, binding = 1) uniform sampler2D textures[];
 
 layout(push_constant) uniform constants {
     ObjectBuffer objBuffer;
     MaterialBuffer matBuffer;
     CameraBuffer camBuffer;
     LightBuffer lightBuffer;
+    InstanceBuffer instanceBuffer;
     uint camera_id;
     uint nbLight;   
 }pc;
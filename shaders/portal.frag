@@ -35,9 +35,9 @@ layout(set = 0, binding = 0) uniform UBO {
 layout(set = 0, binding = 1) uniform Mat { Material[1000] materials; }
 m;
 
-layout(set = 0, binding = 2) uniform sampler2D textures[1000];
+layout(set = 0 , binding = 2) uniform samplerCube samplerCubeMap;
 
-layout(set = 0 , binding = 3) uniform samplerCube samplerCubeMap;
+layout(set = 0, binding = 3) uniform sampler2D textures[];
 
 
 layout(set = 1, binding = 0) uniform sampler2D portalTextures[10];
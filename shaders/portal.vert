@@ -1,4 +1,5 @@
 #version 450
+#extension GL_EXT_nonuniform_qualifier : require
 
 layout(location = 0) in vec3 position;
 layout(location = 1) in vec3 normal;
@@ -34,9 +35,9 @@ layout(set = 0, binding = 1) uniform Mat {
 }
 m;
 
-layout(set = 0, binding = 2) uniform sampler2D textures[1000];
+layout(set = 0, binding = 2) uniform samplerCube samplerCubeMap;
 
-layout(set = 0, binding = 3) uniform samplerCube samplerCubeMap;
+layout(set = 0, binding = 3) uniform sampler2D textures[];
 
 layout(set = 1, binding = 0) uniform sampler2D portalTextures[10];
 
@@ -28,7 +28,8 @@ struct Camera_data {
 struct Object_data {
     mat4 world_matrix;
     mat4 normal_matrix;
-    vec3 padding;
+    uint64_t dynamic_verticies;
+    uint dynamic_first_vertex;
     uint material_offset;
 };
 
@@ -43,16 +44,18 @@ struct Light{
 layout(buffer_reference, std430) readonly buffer ObjectBuffer { Object_data data[]; };
 layout(buffer_reference, std430) readonly buffer MaterialBuffer { Material data[]; };
 layout(buffer_reference, std430) readonly buffer CameraBuffer { Camera_data data[]; };
+layout(buffer_reference, std430) readonly buffer InstanceBuffer { uint ids[]; };
 layout(buffer_reference, std430) readonly buffer LightBuffer { Light data[]; };
 
-layout(set = 0, binding = 0) uniform sampler2D textures[1000];
+layout(set = 0, binding = 0) uniform samplerCube samplerCubeMap;
 
-layout(set = 0, binding = 1) uniform samplerCube samplerCubeMap;
+layout(set = 0, binding = 1) uniform sampler2D textures[];
 
 layout(push_constant) uniform constants {
     ObjectBuffer objBuffer;
     MaterialBuffer matBuffer;
     CameraBuffer camBuffer;
+    InstanceBuffer instanceBuffer;
     uint camera_id;
 }pc;
 
@@ -2,6 +2,8 @@
 #extension GL_EXT_buffer_reference : require
 #extension GL_EXT_buffer_reference2 : require
 #extension GL_EXT_shader_explicit_arithmetic_types_int64 : require
+#extension GL_EXT_scalar_block_layout : require
+#extension GL_EXT_nonuniform_qualifier : require
 layout(location = 0) in vec3 position;
 layout(location = 1) in vec3 normal;
 layout(location = 2) in vec2 uv;
@@ -31,28 +33,44 @@ struct Camera_data {
 struct Object_data {
     mat4 world_matrix;
     mat4 normal_matrix;
-    vec3 padding;
+    uint64_t dynamic_verticies;
+    uint dynamic_first_vertex;
     uint material_offset;
 };
 
+// positions and normals of a deforming mesh for this frame
+struct DynamicVertex {
+    vec3 position;
+    vec3 normal;
+};
+
 
 layout(buffer_reference, std430) readonly buffer ObjectBuffer { Object_data data[]; };
 layout(buffer_reference, std430) readonly buffer MaterialBuffer { Material data[]; };
 layout(buffer_reference, std430) readonly buffer CameraBuffer { Camera_data data[]; };
+layout(buffer_reference, std430) readonly buffer InstanceBuffer { uint ids[]; };
+layout(buffer_reference, scalar) readonly buffer DynamicVertexBuffer { DynamicVertex data[]; };
 
-layout(set = 0, binding = 0) uniform sampler2D textures[1000];
+layout(set = 0, binding = 0) uniform samplerCube samplerCubeMap;
 
-layout(set = 0, binding = 1) uniform samplerCube samplerCubeMap;
+layout(set = 0, binding = 1) uniform sampler2D textures[];
 
 layout(push_constant) uniform constants {
     ObjectBuffer objBuffer;
     MaterialBuffer matBuffer;
     CameraBuffer camBuffer;
+    InstanceBuffer instanceBuffer;
     uint camera_id;
 }pc;
 
 void main() {
-    vec4 positionWorld = pc.objBuffer.data[gl_InstanceIndex].world_matrix * vec4(position, 1.0);
+    uint object_id = pc.instanceBuffer.ids[gl_InstanceIndex];
+    Object_data obj = pc.objBuffer.data[object_id];
+    vec3 vertex_position = position;
+    if (obj.dynamic_verticies != 0) {
+        vertex_position = DynamicVertexBuffer(obj.dynamic_verticies).data[gl_VertexIndex - obj.dynamic_first_vertex].position;
+    }
+    vec4 positionWorld = obj.world_matrix * vec4(vertex_position, 1.0);
 
     // 
 
@@ -100,7 +100,7 @@ void App::init(Device *p_device, DynamicRenderPass *p_deferred_renderpass, Dynam
         m_light_accelerations.push_back(glm::vec3(0, 0, 0));
         m_light_speeds.push_back(glm::vec3(0, 0, 0));
     }
-    s->updateLightBuffer();
+    s->commitSnapshot();
     std::vector<std::shared_ptr<Light>> &P = s->getLights();
     for (int i = 0; i < MAX_LIGHTS; ++i) {
         P[i]->updateOnchangeFunc();
@@ -148,29 +148,16 @@ void App::update(float p_delta_time, CommandBuffer &p_cmd_buffer, Window &p_wind
             P[i]->transform.pos->z = -P[i]->transform.pos->z;
         }
     }
-    s->updateLightBuffer();
+    s->updateSim(p_delta_time, m_sim_time, m_tick);
+    m_sim_time += p_delta_time;
+    m_tick++;
 
-    if (glfwGetKey(p_window_obj, GLFW_KEY_P) == GLFW_PRESS) {
-        CommandBuffer render_cmd_buffer =
-
-            std::move(CommandPoolHandler::getCommandPool(m_device, m_device->getRenderQueue())->createCommandBuffer(1)[0]);
-        render_cmd_buffer.beginCommandBuffer();
+    // hand the new state to the render thread, p_delta_time is the fixed tick of the engine
+    s->commitSnapshot(p_delta_time);
 
-        DynamicRenderPass temp =
-            DynamicRenderPass(m_device, {8192, 8192}, {VK_FORMAT_R8G8B8A8_UNORM, VK_FORMAT_R8G8B8A8_UNORM}, 1, DEPTH, nullptr, nullptr);
-        RenderData r;
-        r.frame_index = 0;
-        r.camera_id = 0;
-        r.render_pass = &temp;
-        // s->getMainCamera()->extent = {1,1};
-        temp.beginRenderPass(render_cmd_buffer, 0);
-        s->renderDeffered(render_cmd_buffer, r);
-        temp.endRenderPass(render_cmd_buffer);
-        render_cmd_buffer.endCommandBuffer();
-        render_cmd_buffer.submitCommandBuffer({}, {}, nullptr, true);
-
-
-        temp.savedRenderPass(0);
+    // the scene buffers belong to the render thread, the capture is recorded there with the next frame
+    if (glfwGetKey(p_window_obj, GLFW_KEY_P) == GLFW_PRESS) {
+        m_capture_requested = true;
     }
 
     if(glfwGetKey(p_window_obj, GLFW_KEY_C) == GLFW_PRESS){
@@ -191,8 +178,31 @@ void App::renderDeferredFrame(float p_deltat_time, CommandBuffer &p_cmd_buffer,
         r.update_culling = true;
         update_culling[p_render_index] = false;
     }
+    s->acquireSnapshot(p_render_index);
     s->updateCameraBuffer(p_render_index);
+    s->simulateGPU(p_cmd_buffer, r);
 
+    // uses the buffers of this frame, it is executed before the frame is recorded
+    if (m_capture_requested.exchange(false)) {
+        CommandBuffer render_cmd_buffer =
+
+            std::move(CommandPoolHandler::getCommandPool(m_device, m_device->getRenderQueue())->createCommandBuffer(1)[0]);
+        render_cmd_buffer.beginCommandBuffer();
+
+        DynamicRenderPass temp =
+            DynamicRenderPass(m_device, {8192, 8192}, {VK_FORMAT_R8G8B8A8_UNORM, VK_FORMAT_R8G8B8A8_UNORM}, 1, DEPTH, nullptr, nullptr);
+        RenderData capture_data;
+        capture_data.frame_index = p_render_index;
+        capture_data.camera_id = 0;
+        capture_data.render_pass = &temp;
+        temp.beginRenderPass(render_cmd_buffer, 0);
+        s->renderDeffered(render_cmd_buffer, capture_data);
+        temp.endRenderPass(render_cmd_buffer);
+        render_cmd_buffer.endCommandBuffer();
+        render_cmd_buffer.submitCommandBuffer({}, {}, nullptr, true);
+
+        temp.savedRenderPass(0);
+    }
 
     s->renderDeffered(p_cmd_buffer, r);
     s->renderShadowMaps(p_cmd_buffer, r);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <atomic>
 #include <cstdint>
 #include <glm/fwd.hpp>
 #include <mutex>
@@ -40,6 +41,10 @@ class App : public IApp {
    Scene *s;
    MainController m_movement_controller;
    std::array<bool, MAX_FRAMES_IN_FLIGHT> update_culling = {true, true};
+   float m_sim_time = 0.f;
+   uint32_t m_tick = 0;
+   // set by the update thread, the capture is done by the render thread
+   std::atomic<bool> m_capture_requested{false};
    std::mutex m;
 
 
@@ -6,5 +6,6 @@ namespace TTe {
 
 
 std::unordered_map<std::pair<std::thread::id, VkQueue>, CommandBufferPool*, CommandPoolHandler::PairHash> CommandPoolHandler::s_command_pools;
+std::mutex CommandPoolHandler::s_command_pools_mutex;
 
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <mutex>
 #include <thread>
 #include <unordered_map>
 #include <utility>
@@ -10,7 +11,9 @@
 namespace TTe {
 class CommandPoolHandler {
    public:
+    // one pool per thread and queue, job workers get their own pool the first time they record
     static CommandBufferPool *getCommandPool(Device *p_device, const VkQueue &p_queue) {
+        std::lock_guard<std::mutex> lock(s_command_pools_mutex);
         std::thread::id this_id = std::this_thread::get_id();
         if (s_command_pools.find({this_id, p_queue}) == s_command_pools.end()) {
             s_command_pools[{this_id, p_queue}] = new CommandBufferPool(p_device, p_queue);
@@ -19,6 +22,7 @@ class CommandPoolHandler {
     }
 
     static void cleanUnusedPools(){
+        std::lock_guard<std::mutex> lock(s_command_pools_mutex);
         std::vector<std::pair<std::thread::id, VkQueue>> to_delete;
         for (auto &it : s_command_pools) {
             if( it.second->cmd_buffer_count == 0){
@@ -32,6 +36,7 @@ class CommandPoolHandler {
     }
 
     static void destroyCommandPools() {
+        std::lock_guard<std::mutex> lock(s_command_pools_mutex);
         for (auto &it : s_command_pools) {
             
             delete it.second;
@@ -50,6 +55,7 @@ class CommandPoolHandler {
     };
     static std::unordered_map<std::pair<std::thread::id, VkQueue>, CommandBufferPool *, PairHash> s_command_pools;
    private:
+    static std::mutex s_command_pools_mutex;
    
 };
 }  // namespace TTe
\ No newline at end of file
@@ -2,10 +2,10 @@
 #include "command_buffer.hpp"
 
 #include <cstdint>
-#include <thread>
 
 #include "../synchronisation/fence.hpp"
 #include "commandBuffer/commandPool_handler.hpp"
+#include "jobs/job_system.hpp"
 #include "structs_vk.hpp"
 #include "synchronisation/semaphore.hpp"
 
@@ -213,7 +213,8 @@ void CommandBuffer::submitCommandBuffer(
     if (p_wait_for_execution) {
         waitAndDestroy(this, semaphore, m_index);
     } else {
-        std::thread(CommandBuffer::waitAndDestroy, this, semaphore, m_index).detach();
+        uint32_t index = m_index;
+        JobSystem::runBlocking([this, semaphore, index]() { waitAndDestroy(this, semaphore, index); });
     }
 }
 
@@ -8,10 +8,11 @@
 
 namespace TTe {
 
-DescriptorSet::DescriptorSet(Device *p_device, std::shared_ptr<DescriptorSetLayout> p_descriptor_set_layout)
+DescriptorSet::DescriptorSet(
+    Device *p_device, std::shared_ptr<DescriptorSetLayout> p_descriptor_set_layout, uint32_t p_variable_descriptor_count)
     : m_descriptor_set_layout(p_descriptor_set_layout), m_device(p_device) {
     m_descriptor_buffer = Buffer(
-        m_device, m_descriptor_set_layout->getLayoutSize(), 1,
+        m_device, m_descriptor_set_layout->getLayoutSize(p_variable_descriptor_count), 1,
         VK_BUFFER_USAGE_RESOURCE_DESCRIPTOR_BUFFER_BIT_EXT | VK_BUFFER_USAGE_SAMPLER_DESCRIPTOR_BUFFER_BIT_EXT |
             VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
         Buffer::BufferType::DYNAMIC);
@@ -19,7 +19,9 @@ class DescriptorSet {
    public:
     // Constructor
     DescriptorSet() = default;
-    DescriptorSet(Device *p_device, std::shared_ptr<DescriptorSetLayout> p_descriptor_set_layout);
+    // the descriptor buffer holds p_variable_descriptor_count descriptors in the variable binding of the layout, all by default
+    DescriptorSet(
+        Device *p_device, std::shared_ptr<DescriptorSetLayout> p_descriptor_set_layout, uint32_t p_variable_descriptor_count = UINT32_MAX);
 
     // Destructor
     ~DescriptorSet() = default;
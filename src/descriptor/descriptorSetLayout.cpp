@@ -3,6 +3,7 @@
 
 
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 
@@ -11,10 +12,14 @@
 
 namespace TTe {
 std::unordered_map<std::vector<uint32_t>, std::weak_ptr<DescriptorSetLayout>> DescriptorSetLayout::s_descriptor_set_layout_cache;
+std::mutex DescriptorSetLayout::s_cache_mutex;
 
 DescriptorSetLayout::DescriptorSetLayout(
-    Device *p_device, std::map<uint32_t, VkDescriptorSetLayoutBinding> p_layout_bindings, std::vector<uint32_t> p_id)
-    : m_device(p_device), m_layout_bindings(p_layout_bindings), m_id(p_id) {
+    Device *p_device,
+    std::map<uint32_t, VkDescriptorSetLayoutBinding> p_layout_bindings,
+    uint32_t p_variable_binding,
+    std::vector<uint32_t> p_id)
+    : m_device(p_device), m_layout_bindings(p_layout_bindings), m_variable_binding(p_variable_binding), m_id(p_id) {
     std::vector<VkDescriptorSetLayoutBinding> bindings_vector;
 
     std::vector<VkDescriptorBindingFlags> bins_flag;
@@ -22,6 +27,7 @@ DescriptorSetLayout::DescriptorSetLayout(
     for (auto &binding : m_layout_bindings) {
         bindings_vector.push_back(binding.second);
         bins_flag.push_back(VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT);
+        if (binding.first == m_variable_binding) bins_flag.back() |= VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT;
     }
 
     auto extended_info = make<VkDescriptorSetLayoutBindingFlagsCreateInfo>();
@@ -43,14 +49,17 @@ DescriptorSetLayout::DescriptorSetLayout(
 
 DescriptorSetLayout::~DescriptorSetLayout() {
     vkDestroyDescriptorSetLayout(*m_device, m_descriptor_set_layout, nullptr);
-    s_descriptor_set_layout_cache.erase(m_id);
+    std::lock_guard<std::mutex> lock(s_cache_mutex);
+    // an equal layout may already replace this one in the cache
+    auto cached = s_descriptor_set_layout_cache.find(m_id);
+    if (cached != s_descriptor_set_layout_cache.end() && cached->second.expired()) s_descriptor_set_layout_cache.erase(cached);
 }
 
 std::shared_ptr<DescriptorSetLayout> DescriptorSetLayout::createDescriptorSetLayout(
-    Device *p_device, std::map<uint32_t, VkDescriptorSetLayoutBinding> p_layout_bindings, uint32_t p_set_id) {
-    std::shared_ptr<DescriptorSetLayout> return_value;
+    Device *p_device, std::map<uint32_t, VkDescriptorSetLayoutBinding> p_layout_bindings, uint32_t p_variable_binding) {
+    // the content of the layout, the set number is not part of it
     std::vector<uint32_t> id;
-    id.push_back(p_set_id);
+    id.push_back(p_variable_binding);
     for (auto &binding : p_layout_bindings) {
         id.push_back(binding.second.binding);
         id.push_back(binding.second.descriptorCount);
@@ -58,13 +67,16 @@ std::shared_ptr<DescriptorSetLayout> DescriptorSetLayout::createDescriptorSetLay
         id.push_back(binding.second.stageFlags);
         id.push_back(binding.second.descriptorType);
     }
-    if (s_descriptor_set_layout_cache.find(id) == s_descriptor_set_layout_cache.end()) {
-        std::shared_ptr<DescriptorSetLayout> return_value = std::make_shared<DescriptorSetLayout>(p_device, p_layout_bindings, id);
-        s_descriptor_set_layout_cache[id] = return_value;
-        return return_value;
+    std::lock_guard<std::mutex> lock(s_cache_mutex);
+    auto cached = s_descriptor_set_layout_cache.find(id);
+    if (cached != s_descriptor_set_layout_cache.end()) {
+        if (std::shared_ptr<DescriptorSetLayout> return_value = cached->second.lock()) return return_value;
     }
 
-    return s_descriptor_set_layout_cache[id].lock();
+    std::shared_ptr<DescriptorSetLayout> return_value =
+        std::make_shared<DescriptorSetLayout>(p_device, p_layout_bindings, p_variable_binding, id);
+    s_descriptor_set_layout_cache[id] = return_value;
+    return return_value;
 }
 
 void DescriptorSetLayout::getLayoutSizeAndOffsets() {
@@ -77,6 +89,27 @@ void DescriptorSetLayout::getLayoutSizeAndOffsets() {
     }
 }
 
+VkDeviceSize DescriptorSetLayout::getLayoutSize(uint32_t p_variable_descriptor_count) {
+    if (m_variable_binding == s_no_variable_binding) return m_layout_size;
+    const VkDescriptorSetLayoutBinding &binding = m_layout_bindings[m_variable_binding];
+    p_variable_descriptor_count = std::min(p_variable_descriptor_count, binding.descriptorCount);
+    VkDeviceSize size =
+        m_layout_offsets[m_variable_binding] + p_variable_descriptor_count * getSizeOfDescriptorType(binding.descriptorType);
+    return alignedVkSize(std::max<VkDeviceSize>(size, 1), m_device->getDeviceDescProps().descriptorBufferOffsetAlignment);
+}
+
+bool DescriptorSetLayout::contains(const DescriptorSetLayout &p_other) const {
+    for (auto &binding : p_other.m_layout_bindings) {
+        auto own = m_layout_bindings.find(binding.first);
+        if (own == m_layout_bindings.end() || own->second.descriptorType != binding.second.descriptorType ||
+            (own->second.stageFlags & binding.second.stageFlags) != binding.second.stageFlags ||
+            own->second.descriptorCount < binding.second.descriptorCount) {
+            return false;
+        }
+    }
+    return true;
+}
+
 const size_t &DescriptorSetLayout::getSizeOfDescriptorType(VkDescriptorType p_descriptor_type) {
     switch (p_descriptor_type) {
         case VK_DESCRIPTOR_TYPE_SAMPLER:
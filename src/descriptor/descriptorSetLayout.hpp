@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <vector>
 
@@ -12,12 +13,22 @@
 namespace TTe {
 class DescriptorSetLayout {
    public:
-    DescriptorSetLayout(Device *p_device, std::map<uint32_t, VkDescriptorSetLayoutBinding> p_layout_bindings, std::vector<uint32_t> p_id);
+    // descriptors of a runtime array (textures[]) and no variable binding
+    static constexpr uint32_t s_runtime_array_capacity = 1000;
+    static constexpr uint32_t s_no_variable_binding = UINT32_MAX;
 
+    DescriptorSetLayout(
+        Device *p_device,
+        std::map<uint32_t, VkDescriptorSetLayoutBinding> p_layout_bindings,
+        uint32_t p_variable_binding,
+        std::vector<uint32_t> p_id);
+
+    // layouts are shared by content : the same bindings give the same layout, whatever the set, the shader or the pipeline.
+    // p_variable_binding, the last binding, holds a runtime array whose descriptor count is chosen by each descriptor set
     static std::shared_ptr<DescriptorSetLayout> createDescriptorSetLayout(
         Device *p_device,
         std::map<uint32_t, VkDescriptorSetLayoutBinding> p_layout_bindings,
-        uint32_t p_set_id);
+        uint32_t p_variable_binding = s_no_variable_binding);
     
     // delete copy constructor
     DescriptorSetLayout(const DescriptorSetLayout &) = delete;
@@ -34,7 +45,13 @@ class DescriptorSetLayout {
     
     std::map<uint32_t, VkDescriptorSetLayoutBinding> getLayoutBindings() const { return m_layout_bindings; }
     std::vector<uint32_t> getId() const { return m_id; }
+    uint32_t getVariableBinding() const { return m_variable_binding; }
     const VkDeviceSize& getLayoutSize() const { return m_layout_size; }
+    // size of a descriptor set holding p_variable_descriptor_count descriptors in its variable binding
+    VkDeviceSize getLayoutSize(uint32_t p_variable_descriptor_count);
+
+    // every binding of p_other is a binding of this layout, of the same type, visible to its stages and as large
+    bool contains(const DescriptorSetLayout &p_other) const;
     std::unordered_map<uint32_t, VkDeviceSize> &getLayoutOffsets() { return m_layout_offsets; }
     
     
@@ -44,6 +61,8 @@ class DescriptorSetLayout {
    private:
 
     static std::unordered_map<std::vector<uint32_t>, std::weak_ptr<DescriptorSetLayout>> s_descriptor_set_layout_cache;
+    // the shaders reloaded on the job system workers create layouts too
+    static std::mutex s_cache_mutex;
 
     void getLayoutSizeAndOffsets();
     
@@ -52,6 +71,7 @@ class DescriptorSetLayout {
     VkDescriptorSetLayout m_descriptor_set_layout;
 
     std::map<uint32_t, VkDescriptorSetLayoutBinding> m_layout_bindings;
+    uint32_t m_variable_binding = s_no_variable_binding;
     std::vector<uint32_t> m_id;
 
     VkDeviceSize m_layout_size = 0;
@@ -3,6 +3,7 @@
 
 
 
+#include <algorithm>
 #include <chrono>
 #include <iostream>
 #include <thread>
@@ -12,6 +13,9 @@
 #include "device.hpp"
 #include "imgui.h"
 #include "imgui_impl_glfw.h"
+#include "jobs/job_system.hpp"
+#include "shader/hot_reload.hpp"
+#include "shader/shader_manager.hpp"
 #include "utils.hpp"
 
 #define IMGUI_IMPL_VULKAN_USE_VOLK
@@ -21,6 +25,12 @@ namespace TTe {
 
 Engine::~Engine() {
     vkDeviceWaitIdle(m_device);
+    // no reload job may compile once the shader manager is shut down
+    HotReload::shutdown();
+    // writes the shaders compiled by this run to the cache file
+    ShaderManager::shutdown();
+    // the pending command buffer releases are queued on the job system
+    JobSystem::shutdown();
     delete m_app;
     Image::destroySamplers(&m_device);
     ImGui_ImplVulkan_Shutdown();
@@ -30,6 +40,17 @@ Engine::~Engine() {
 }
 
 void Engine::init() {
+    JobSystem::init();
+    // every shader is compiled on the workers before the pipelines of the app are created, one by one
+#ifdef DEFAULT_APP_PATH
+    ShaderManager::init("shaders/spirv/shader_cache.bin");
+    ShaderManager::precompile(std::filesystem::path("shaders"));
+#else
+    ShaderManager::init("TTengine-2/shaders/spirv/shader_cache.bin");
+    ShaderManager::precompile(std::filesystem::path("TTengine-2/shaders"));
+#endif
+    // the pipelines created by the app are rebuilt when their sources are saved
+    HotReload::init();
     Image::createsamplers(&m_device);
     
     for (unsigned int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
@@ -168,11 +189,17 @@ void Engine::renderLoop(Engine &p_engine) {
         if (!p_engine.startFrame(p_aquire_frame_semaphore, p_fence)) {
             continue;
         }
+
+        // the reloaded shaders are swapped between two frames, when the update thread is not recording either
+        bool update_idle = p_engine.m_resize_mutex.try_lock();
+        HotReload::update(update_idle);
+        if (update_idle) p_engine.m_resize_mutex.unlock();
        
         ImGui_ImplVulkan_NewFrame();
         ImGui_ImplGlfw_NewFrame();
 
         ImGui::NewFrame();
+        HotReload::drawErrors();
         // ImGui::ShowDemoWindow();
 
         // DEFERRED RENDERING
@@ -220,20 +247,24 @@ void Engine::renderLoop(Engine &p_engine) {
 }
 
 void Engine::updateLoop(Engine &p_engine) {
-    auto start = std::chrono::high_resolution_clock::now();
+    FixedTimestep &scheduler = p_engine.m_update_scheduler;
+    scheduler.start();
 
     while (!p_engine.m_window.shouldClose()) {
         glfwPollEvents();
-        if (p_engine.m_resize_mutex.try_lock()) {
-        
-            auto new_time = std::chrono::high_resolution_clock::now();
-            float delta_time = std::chrono::duration<float, std::chrono::seconds::period>(new_time - start).count();
-            start = new_time;
-
-            // p_engine.m_update_cmd_buffer.beginCommandBuffer();
-            p_engine.m_app->update(delta_time, p_engine.m_update_cmd_buffer, p_engine.m_window);
+        scheduler.accumulate();
+
+        // ticks are kept in the accumulator while a resize holds the mutex
+        if (scheduler.hasTick() && p_engine.m_resize_mutex.try_lock()) {
+            while (scheduler.step()) {
+                p_engine.m_app->update(scheduler.getTickDuration(), p_engine.m_update_cmd_buffer, p_engine.m_window);
+            }
             p_engine.m_resize_mutex.unlock();
         }
+
+        // sleep until the next tick but still wake up for window events
+        double wait_time = std::chrono::duration<double>(scheduler.nextTickTime() - FixedTimestep::Clock::now()).count();
+        glfwWaitEventsTimeout(std::max(wait_time, 0.001));
     }
 }
 
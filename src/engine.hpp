@@ -10,6 +10,7 @@
 #include "commandBuffer/command_buffer.hpp"
 #include "device.hpp"
 #include "dynamic_renderpass.hpp"
+#include "fixed_timestep.hpp"
 #include "swapchain.hpp"
 #include "synchronisation/semaphore.hpp"
 #include "utils.hpp"
@@ -35,6 +36,9 @@ class Engine {
     void init();
     void run();
 
+    // rate of IApp::update calls, must be set before run()
+    void setTickRate(float p_tick_rate, uint32_t p_max_catch_up_steps = 5) { m_update_scheduler.setTickRate(p_tick_rate, p_max_catch_up_steps); }
+
    private:
 
    
@@ -55,6 +59,8 @@ class Engine {
 
     std::mutex m_resize_mutex;
 
+    FixedTimestep m_update_scheduler{60.f, 5};
+
     IApp *m_app;
     Window m_window{512, 512, m_app->name};
     Device m_device{m_window};
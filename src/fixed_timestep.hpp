@@ -0,0 +1,55 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+namespace TTe {
+
+// accumulates real time and hands it out in fixed ticks, so the simulation does not depend on the machine speed
+class FixedTimestep {
+   public:
+    using Clock = std::chrono::steady_clock;
+
+    FixedTimestep(float p_tick_rate = 60.f, uint32_t p_max_catch_up_steps = 5) { setTickRate(p_tick_rate, p_max_catch_up_steps); }
+
+    void setTickRate(float p_tick_rate, uint32_t p_max_catch_up_steps = 5) {
+        m_tick_duration = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / p_tick_rate));
+        m_max_catch_up_steps = std::max(p_max_catch_up_steps, 1u);
+    }
+
+    void start(Clock::time_point p_now = Clock::now()) {
+        m_last_time = p_now;
+        m_accumulator = Clock::duration::zero();
+    }
+
+    // add the elapsed time, after a long stall (debugger, resize...) the late ticks are dropped instead of freezing the loop
+    void accumulate(Clock::time_point p_now = Clock::now()) {
+        m_accumulator += p_now - m_last_time;
+        m_last_time = p_now;
+        m_accumulator = std::min(m_accumulator, m_tick_duration * m_max_catch_up_steps);
+    }
+
+    // consume one tick if enough time was accumulated
+    bool step() {
+        if (m_accumulator < m_tick_duration) return false;
+        m_accumulator -= m_tick_duration;
+        return true;
+    }
+
+    bool hasTick() const { return m_accumulator >= m_tick_duration; }
+
+    // the render thread interpolates from the commit time of the snapshots (Scene::getInterpolationAlpha), the accumulator
+    // belongs to the update thread
+    float getTickDuration() const { return std::chrono::duration<float>(m_tick_duration).count(); }
+
+    Clock::time_point nextTickTime() const { return m_last_time + (m_tick_duration - m_accumulator); }
+
+   private:
+    Clock::duration m_tick_duration;
+    Clock::duration m_accumulator = Clock::duration::zero();
+    Clock::time_point m_last_time = Clock::now();
+    uint32_t m_max_catch_up_steps = 5;
+};
+
+}  // namespace TTe
@@ -0,0 +1,254 @@
+#include "job_system.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <iostream>
+
+namespace TTe {
+
+std::vector<std::unique_ptr<JobSystem::WorkerQueue>> JobSystem::s_queues;
+std::vector<std::thread> JobSystem::s_workers;
+std::atomic<uint32_t> JobSystem::s_nb_queued{0};
+std::atomic<bool> JobSystem::s_running{false};
+std::atomic<bool> JobSystem::s_initialized{false};
+std::mutex JobSystem::s_init_mutex;
+
+std::mutex JobSystem::s_sleep_mutex;
+std::condition_variable JobSystem::s_sleep_cv;
+
+std::thread JobSystem::s_blocking_thread;
+std::deque<JobSystem::Job> JobSystem::s_blocking_jobs;
+std::mutex JobSystem::s_blocking_mutex;
+std::condition_variable JobSystem::s_blocking_cv;
+
+thread_local int32_t JobSystem::s_worker_index = -1;
+
+void JobSystem::init(uint32_t p_nb_workers) {
+    std::lock_guard<std::mutex> lock(s_init_mutex);
+    if (s_initialized.load(std::memory_order_acquire)) return;
+
+    if (p_nb_workers == 0) {
+        uint32_t nb_hardware_threads = std::thread::hardware_concurrency();
+        p_nb_workers = nb_hardware_threads > 3 ? nb_hardware_threads - 2 : 1;
+    }
+
+    s_queues.clear();
+    for (uint32_t i = 0; i < p_nb_workers + 1; i++) {
+        s_queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    s_running.store(true, std::memory_order_release);
+
+    for (uint32_t i = 0; i < p_nb_workers; i++) {
+        s_workers.emplace_back(&JobSystem::workerLoop, i);
+    }
+    s_blocking_thread = std::thread(&JobSystem::blockingLoop);
+    s_initialized.store(true, std::memory_order_release);
+}
+
+void JobSystem::shutdown() {
+    std::lock_guard<std::mutex> lock(s_init_mutex);
+    if (!s_initialized.load(std::memory_order_acquire)) return;
+
+    {
+        std::lock_guard<std::mutex> sleep_lock(s_sleep_mutex);
+        std::lock_guard<std::mutex> blocking_lock(s_blocking_mutex);
+        s_running.store(false, std::memory_order_release);
+    }
+    s_sleep_cv.notify_all();
+    s_blocking_cv.notify_all();
+
+    for (auto &worker : s_workers) {
+        worker.join();
+    }
+    s_workers.clear();
+    s_blocking_thread.join();
+    s_initialized.store(false, std::memory_order_release);
+}
+
+uint32_t JobSystem::getWorkerCount() {
+    if (!s_initialized.load(std::memory_order_acquire)) init();
+    return static_cast<uint32_t>(s_queues.size() - 1);
+}
+
+void JobSystem::run(Job p_job, JobCounter *p_counter) {
+    if (!s_initialized.load(std::memory_order_acquire)) init();
+
+    if (p_counter) {
+        p_counter->m_pending.fetch_add(1, std::memory_order_relaxed);
+    }
+    push({std::move(p_job), p_counter});
+}
+
+void JobSystem::wait(JobCounter &p_counter) {
+    while (!p_counter.done()) {
+        Task task;
+        if (tryPop(task)) {
+            execute(task);
+        } else {
+            // the last jobs are running on other threads
+            std::this_thread::yield();
+        }
+    }
+
+    std::exception_ptr exception;
+    {
+        std::lock_guard<std::mutex> lock(p_counter.m_exception_mutex);
+        std::swap(exception, p_counter.m_exception);
+    }
+    if (exception) std::rethrow_exception(exception);
+}
+
+void JobSystem::parallelForRange(uint32_t p_begin, uint32_t p_end, uint32_t p_grain, const std::function<void(uint32_t, uint32_t)> &p_func) {
+    if (p_begin >= p_end) return;
+
+    uint32_t count = p_end - p_begin;
+    if (p_grain == 0) {
+        p_grain = std::max(count / ((getWorkerCount() + 1) * 4), 1u);
+    }
+    if (count <= p_grain) {
+        p_func(p_begin, p_end);
+        return;
+    }
+
+    JobCounter counter;
+    std::exception_ptr exception;
+    std::mutex exception_mutex;
+
+    uint32_t chunk_begin = p_begin;
+    while (chunk_begin < p_end) {
+        uint32_t chunk_end = chunk_begin + std::min(p_grain, p_end - chunk_begin);
+        run(
+            [&, chunk_begin, chunk_end]() {
+                try {
+                    p_func(chunk_begin, chunk_end);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(exception_mutex);
+                    if (!exception) exception = std::current_exception();
+                }
+            },
+            &counter);
+        chunk_begin = chunk_end;
+    }
+    wait(counter);
+
+    if (exception) std::rethrow_exception(exception);
+}
+
+void JobSystem::runBlocking(Job p_job) {
+    if (!s_initialized.load(std::memory_order_acquire)) init();
+
+    {
+        std::lock_guard<std::mutex> lock(s_blocking_mutex);
+        s_blocking_jobs.push_back(std::move(p_job));
+    }
+    s_blocking_cv.notify_one();
+}
+
+void JobSystem::workerLoop(uint32_t p_index) {
+    s_worker_index = static_cast<int32_t>(p_index);
+
+    while (true) {
+        Task task;
+        if (tryPop(task)) {
+            execute(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(s_sleep_mutex);
+        if (!s_running.load(std::memory_order_acquire) && s_nb_queued.load(std::memory_order_acquire) == 0) break;
+        s_sleep_cv.wait(
+            lock, [] { return s_nb_queued.load(std::memory_order_acquire) > 0 || !s_running.load(std::memory_order_acquire); });
+    }
+}
+
+void JobSystem::blockingLoop() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(s_blocking_mutex);
+            s_blocking_cv.wait(lock, [] { return !s_blocking_jobs.empty() || !s_running.load(std::memory_order_acquire); });
+            if (s_blocking_jobs.empty()) break;
+
+            job = std::move(s_blocking_jobs.front());
+            s_blocking_jobs.pop_front();
+        }
+        try {
+            job();
+        } catch (const std::exception &e) {
+            std::cerr << "blocking job failed : " << e.what() << std::endl;
+        }
+    }
+}
+
+void JobSystem::push(Task &&p_task) {
+    uint32_t queue_index = s_worker_index >= 0 ? static_cast<uint32_t>(s_worker_index) : static_cast<uint32_t>(s_queues.size() - 1);
+    {
+        std::lock_guard<std::mutex> lock(s_queues[queue_index]->mutex);
+        s_queues[queue_index]->tasks.push_back(std::move(p_task));
+    }
+    s_nb_queued.fetch_add(1, std::memory_order_release);
+
+    // take the lock so a worker can not miss the notification between its check and its wait
+    { std::lock_guard<std::mutex> lock(s_sleep_mutex); }
+    s_sleep_cv.notify_one();
+}
+
+bool JobSystem::tryPop(Task &p_task) {
+    uint32_t nb_queues = static_cast<uint32_t>(s_queues.size());
+
+    // newest job of our own queue first, it is the most likely to be hot in cache
+    if (s_worker_index >= 0) {
+        WorkerQueue &queue = *s_queues[s_worker_index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty()) {
+            p_task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+            s_nb_queued.fetch_sub(1, std::memory_order_acq_rel);
+            return true;
+        }
+    }
+
+    // then steal the oldest job of the other queues
+    uint32_t start = s_worker_index >= 0 ? static_cast<uint32_t>(s_worker_index) + 1 : 0;
+    for (uint32_t i = 0; i < nb_queues; i++) {
+        uint32_t victim = (start + i) % nb_queues;
+        if (static_cast<int32_t>(victim) == s_worker_index) continue;
+
+        WorkerQueue &queue = *s_queues[victim];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty()) {
+            p_task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            s_nb_queued.fetch_sub(1, std::memory_order_acq_rel);
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobSystem::execute(Task &p_task) {
+    // an exception must not leave the worker nor skip the counter, the waiter would never return
+    try {
+        p_task.job();
+    } catch (...) {
+        if (p_task.counter) {
+            std::lock_guard<std::mutex> lock(p_task.counter->m_exception_mutex);
+            if (!p_task.counter->m_exception) p_task.counter->m_exception = std::current_exception();
+        } else {
+            try {
+                throw;
+            } catch (const std::exception &e) {
+                std::cerr << "job failed : " << e.what() << std::endl;
+            } catch (...) {
+                std::cerr << "job failed" << std::endl;
+            }
+        }
+    }
+    // release the captures before signaling, the waiter may destroy them as soon as the counter reaches zero
+    p_task.job = nullptr;
+    if (p_task.counter) {
+        p_task.counter->m_pending.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
+
+}  // namespace TTe
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace TTe {
+
+// number of jobs not finished yet, JobSystem::wait on it to join a batch of jobs. The first exception thrown by one of
+// its jobs is kept and rethrown by JobSystem::wait
+class JobCounter {
+   public:
+    JobCounter() = default;
+    JobCounter(const JobCounter &) = delete;
+    JobCounter &operator=(const JobCounter &) = delete;
+
+    bool done() const { return m_pending.load(std::memory_order_acquire) == 0; }
+
+   private:
+    std::atomic<uint32_t> m_pending{0};
+    std::mutex m_exception_mutex;
+    std::exception_ptr m_exception;
+
+    friend class JobSystem;
+};
+
+// fixed pool of worker threads shared by the whole engine (loading, simulation, ...),
+// each worker pushes and pops its own jobs at the back of its deque and steals from the front of the others when idle
+class JobSystem {
+   public:
+    using Job = std::function<void()>;
+
+    // p_nb_workers = 0 : one worker per hardware thread, minus the update and render threads
+    static void init(uint32_t p_nb_workers = 0);
+    // run the jobs still queued then join every thread
+    static void shutdown();
+
+    static uint32_t getWorkerCount();
+
+    // an exception thrown by a job without counter is only logged
+    static void run(Job p_job, JobCounter *p_counter = nullptr);
+
+    // block until every job of p_counter is finished, the calling thread executes queued jobs meanwhile.
+    // Rethrows the first exception thrown by one of them
+    static void wait(JobCounter &p_counter);
+
+    // call p_func(chunk_begin, chunk_end) on chunks of p_grain indices of [p_begin, p_end[ and wait for all of them,
+    // p_grain = 0 picks a grain giving a few chunks per worker. The first exception thrown by a chunk is rethrown here
+    static void parallelForRange(uint32_t p_begin, uint32_t p_end, uint32_t p_grain, const std::function<void(uint32_t, uint32_t)> &p_func);
+
+    // same as parallelForRange, p_func is called once per index
+    template <typename F>
+    static void parallelFor(uint32_t p_begin, uint32_t p_end, uint32_t p_grain, F &&p_func) {
+        parallelForRange(p_begin, p_end, p_grain, [&p_func](uint32_t p_chunk_begin, uint32_t p_chunk_end) {
+            for (uint32_t i = p_chunk_begin; i < p_chunk_end; i++) p_func(i);
+        });
+    }
+
+    // for jobs that block on something else than the CPU (GPU fences, semaphores...) and would stall a worker,
+    // they are executed in submission order on a single dedicated thread
+    static void runBlocking(Job p_job);
+
+   private:
+    struct Task {
+        Job job;
+        JobCounter *counter = nullptr;
+    };
+
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    static void workerLoop(uint32_t p_index);
+    static void blockingLoop();
+
+    static void push(Task &&p_task);
+    static bool tryPop(Task &p_task);
+    static void execute(Task &p_task);
+
+    // one queue per worker, the last one receives the jobs pushed from threads outside the pool
+    static std::vector<std::unique_ptr<WorkerQueue>> s_queues;
+    static std::vector<std::thread> s_workers;
+    static std::atomic<uint32_t> s_nb_queued;
+    static std::atomic<bool> s_running;
+    // stays set while shutdown drains the queues, so jobs pushing other jobs do not restart the pool
+    static std::atomic<bool> s_initialized;
+    static std::mutex s_init_mutex;
+
+    static std::mutex s_sleep_mutex;
+    static std::condition_variable s_sleep_cv;
+
+    static std::thread s_blocking_thread;
+    static std::deque<Job> s_blocking_jobs;
+    static std::mutex s_blocking_mutex;
+    static std::condition_variable s_blocking_cv;
+
+    // index of the worker running on this thread, -1 outside the pool
+    static thread_local int32_t s_worker_index;
+};
+
+}  // namespace TTe
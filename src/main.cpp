@@ -1,11 +1,104 @@
 #include <cstdio>
 #include <cstdlib>
 #include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 #include "app.hpp"
+#include "commandBuffer/commandPool_handler.hpp"
+#include "device.hpp"
 #include "engine.hpp"
+#include "jobs/job_system.hpp"
+#include "sceneV2/animatic/simulation/LectureMSS.h"
+#include "sceneV2/animatic/simulation/ObjetSimuleMSS.h"
+#include "sceneV2/animatic/skeleton/BVH.h"
+#include "sceneV2/animatic/skeleton/animation_crowd.hpp"
+#include "sceneV2/animatic/skeleton/compressed_clip.hpp"
+#include "shader/shader_manager.hpp"
+#include "window.hpp"
+
+// runs a headless mode with the job system, its exceptions are reported as a failure
+template <typename F>
+static int runHeadless(F &&p_mode) {
+    TTe::JobSystem::init();
+    int result = EXIT_SUCCESS;
+    try {
+        p_mode();
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << '\n';
+        result = EXIT_FAILURE;
+    }
+    TTe::JobSystem::shutdown();
+    return result;
+}
+
+// headless measure of the crowd animation : --crowd-benchmark <nb characters> <bvh files...>
+static int crowdBenchmark(int argc, char **argv) {
+    return runHeadless([&]() {
+        std::vector<std::string> filenames(argv + 3, argv + argc);
+        TTe::AnimationCrowd::benchmark(TTe::AnimationLibrary::load(filenames), std::stoul(argv[2]), 100);
+    });
+}
+
+// headless report of the clip compression : --clip-compression <joint position tolerance> <bvh files...>
+static int clipCompression(int argc, char **argv) {
+    return runHeadless([&]() {
+        std::vector<std::string> filenames(argv + 3, argv + argc);
+        std::vector<TTe::AnimationClip> clips;
+        for (const TTe::BVH &bvh : TTe::BVH::loadAll(filenames, true)) clips.emplace_back(bvh);
+        TTe::CompressedClip::benchmark(clips, std::stof(argv[2]));
+    });
+}
+
+// headless comparison of the BVH parsers : --bvh-benchmark <bvh files...>
+static int bvhBenchmark(int argc, char **argv) {
+    return runHeadless([&]() { TTe::BVH::benchmarkParsers(std::vector<std::string>(argv + 2, argv + argc)); });
+}
+
+// conversion of mass-spring files and measure of the text and binary loads :
+// --mss-convert <points> <masses> <textures> <faces> <binary output>
+static int mssConvert(char **argv) {
+    return runHeadless([&]() { TTe::ConvertitEtMesureMSS(argv[2], argv[3], argv[4], argv[5], argv[6]); });
+}
+
+// headless measure of the cloth self-collision on synthetic grids : --cloth-selfcollision-benchmark [resolutions...],
+// 64 and 256 by default
+static int clothSelfCollisionBenchmark(int argc, char **argv) {
+    return runHeadless([&]() {
+        std::vector<uint32_t> resolutions;
+        for (int i = 2; i < argc; i++) resolutions.push_back(std::stoul(argv[i]));
+        if (resolutions.empty()) resolutions = {64, 256};
+        for (uint32_t resolution : resolutions) TTe::ObjetSimuleMSS::MesureAutoCollision(resolution);
+    });
+}
+
+// comparison of the GPU cloth solver with the explicit CPU solver : --cloth-gpu-parity <param file> [nb steps], 100 steps by
+// default. Fails above 1e-4 of position error, runs without a GPU under lavapipe (VK_ICD_FILENAMES) and xvfb-run
+static int clothGPUParity(int argc, char **argv) {
+    return runHeadless([&]() {
+        TTe::Window window(64, 64, "cloth gpu parity");
+        TTe::Device device(window);
+#ifdef DEFAULT_APP_PATH
+        TTe::ShaderManager::init("shaders/spirv/shader_cache.bin");
+#else
+        TTe::ShaderManager::init("TTengine-2/shaders/spirv/shader_cache.bin");
+#endif
+        float error = TTe::ObjetSimuleMSS::TestPariteGPU(&device, argv[2], argc > 3 ? std::stoul(argv[3]) : 100);
+        TTe::ShaderManager::shutdown();
+        TTe::CommandPoolHandler::destroyCommandPools();
+        if (error > 1e-4f) throw std::runtime_error("cloth gpu parity failed : " + std::to_string(error));
+    });
+}
+
+int main(int argc, char **argv) {
+    if (argc > 3 && std::string(argv[1]) == "--crowd-benchmark") return crowdBenchmark(argc, argv);
+    if (argc > 3 && std::string(argv[1]) == "--clip-compression") return clipCompression(argc, argv);
+    if (argc > 2 && std::string(argv[1]) == "--bvh-benchmark") return bvhBenchmark(argc, argv);
+    if (argc > 6 && std::string(argv[1]) == "--mss-convert") return mssConvert(argv);
+    if (argc > 1 && std::string(argv[1]) == "--cloth-selfcollision-benchmark") return clothSelfCollisionBenchmark(argc, argv);
+    if (argc > 2 && std::string(argv[1]) == "--cloth-gpu-parity") return clothGPUParity(argc, argv);
 
-int main() {
     fflush(stdout);
     TTe::App *app = new TTe::App();
     TTe::Engine engine{app};
@@ -17,4 +110,4 @@ int main() {
         return EXIT_FAILURE;
     }
     return EXIT_SUCCESS;
-}
\ No newline at end of file
+}
@@ -13,6 +13,9 @@ class IIndirectRenderable {
     virtual void render(CommandBuffer &cmd, RenderData &renderData) = 0;
     void setMaterialOffset(uint offset) { materialOffset = offset; }
     virtual std::vector<MeshBlock> getMeshBlock(uint32_t p_nb_max_triangle) = 0;
+    // renderables returning the same mesh share one set of mesh blocks and are drawn instanced,
+    // nullptr if the geometry is owned by the object (cloth, skinned mesh...)
+    virtual Mesh *getInstancedMesh() { return nullptr; }
    private:
    protected:
     uint materialOffset;
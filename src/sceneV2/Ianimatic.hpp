@@ -5,11 +5,30 @@
 #include <vector>
 
 #include "sceneV2/Icollider.hpp"
+#include "sceneV2/mesh.hpp"
 
 namespace TTe {
+class Node;
 class IAnimatic {
    public:
-    virtual void simulation(glm::vec3 gravite, float viscosite, uint32_t tick, float dt, float t, std::vector<std::shared_ptr<ICollider>> &m_collision_objects) = 0;
+    // Scene::updateSim runs each step on every animated object in parallel, an object only touches its own data
+    // and the next step starts once every object finished the previous one
+    virtual void simulation(glm::vec3 gravite, float viscosite, uint32_t tick, float dt, float t) = 0;
+    // every object finished its simulation step, the colliders are at their position for this tick
+    virtual void collision(std::vector<std::shared_ptr<ICollider>> &) {}
+    // every collision is resolved, update the vertices (normals...) deduced from the simulated positions
+    virtual void updateDeformedMesh() {}
+    // kinematic objects (skeletons...) are stepped before the others, which can be attached to them or collide with them
+    virtual bool isKinematic() const { return false; }
+    // nodes read by the simulation outside of the object's subtree (joints of a skin...), resolved with it before each step
+    virtual void getExternalNodes(std::vector<Node *> &) {}
+    // mesh deformed by the simulation, its vertices are copied in the scene snapshot after each update
+    virtual Mesh *getDynamicMesh() { return nullptr; }
+    // mesh deformed on the GPU (skinning...) : address of its positions and normals (DynamicVertexGPU), read by the vertex
+    // shaders instead of the vertex buffer from the first vertex written in the parameter, 0 if the object has none
+    virtual uint64_t getGPUDynamicVerticies(uint32_t &) { return 0; }
+    // objects simulated on the GPU record the steps produced by the update thread, called on the render thread before drawing
+    virtual void recordGPUSimulation(CommandBuffer &, uint32_t) {}
    private:
    protected:
 };
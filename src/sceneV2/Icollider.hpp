@@ -1,12 +1,33 @@
 #pragma once
 
 #include <glm/fwd.hpp>
+#include <span>
+#include <vector>
+
+#include "struct.hpp"
+
 namespace TTe {
 class ICollider {
    public:
     virtual void collisionPos(glm::vec3 &pos, glm::vec3 &vitesse) = 0;
 
+    // called once per tick, after the colliders moved and before any query : cache the matrices and bounds used below
+    virtual void updateCollider() {}
+
+    // world space bounds of the collider, points outside of them are never moved by collide
+    virtual BoundingBox getColliderBounds() const { return BoundingBox::infinite(); }
+
+    // shapes used by the GPU simulations, a collider without GPU version is ignored by them
+    virtual void getGPUColliders(std::vector<ColliderGPU> &) const {}
+
+    // resolve the collision of a batch of points, p_velocities[i] is the velocity of p_positions[i]
+    virtual void collide(std::span<glm::vec3> p_positions, std::span<glm::vec3> p_velocities) {
+        for (size_t i = 0; i < p_positions.size(); i++) {
+            collisionPos(p_positions[i], p_velocities[i]);
+        }
+    }
+
    private:
    protected:
 };
-}  // namespace TTe
\ No newline at end of file
+}  // namespace TTe
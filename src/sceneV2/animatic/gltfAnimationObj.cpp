@@ -0,0 +1,49 @@
+#include "gltfAnimationObj.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <glm/gtc/quaternion.hpp>
+
+#include "math/quaternion_convertor.hpp"
+
+namespace TTe {
+
+void GLTFAnimationObj::addChannel(Channel p_channel) {
+    if (p_channel.target == nullptr || p_channel.times.empty() || p_channel.values.size() < p_channel.times.size()) return;
+    m_duration = std::max(m_duration, p_channel.times.back());
+    m_channels.push_back(std::move(p_channel));
+}
+
+void GLTFAnimationObj::simulation(glm::vec3, float, uint32_t, float, float t) {
+    float time = m_duration > 0.f ? std::fmod(t, m_duration) : 0.f;
+
+    for (Channel &channel : m_channels) {
+        // first key after the time, the value is clamped before the first key and after the last one
+        size_t next = std::upper_bound(channel.times.begin(), channel.times.end(), time) - channel.times.begin();
+        size_t previous = next == 0 ? 0 : next - 1;
+        next = std::min(next, channel.times.size() - 1);
+
+        float alpha = 0.f;
+        if (!channel.step && next != previous) {
+            alpha = (time - channel.times[previous]) / (channel.times[next] - channel.times[previous]);
+        }
+        const glm::vec4 &a = channel.values[previous];
+        const glm::vec4 &b = channel.values[next];
+
+        switch (channel.path) {
+            case Path::TRANSLATION:
+                channel.target->transform.pos = glm::mix(glm::vec3(a), glm::vec3(b), alpha);
+                break;
+            case Path::ROTATION: {
+                glm::quat rotation = glm::slerp(glm::quat(a.w, a.x, a.y, a.z), glm::quat(b.w, b.x, b.y, b.z), alpha);
+                channel.target->transform.rot = quatToEulerZXY(rotation);
+                break;
+            }
+            case Path::SCALE:
+                channel.target->transform.scale = glm::mix(glm::vec3(a), glm::vec3(b), alpha);
+                break;
+        }
+    }
+}
+
+}  // namespace TTe
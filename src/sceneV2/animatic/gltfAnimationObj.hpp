@@ -0,0 +1,39 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+
+#include "sceneV2/Ianimatic.hpp"
+#include "sceneV2/node.hpp"
+
+namespace TTe {
+
+// animation of a glTF file : each channel drives the translation, rotation or scale of a node of the scene, sampled at the
+// scene time and looping. Kinematic, the joints of the skins are at their pose of the tick before the skinned meshes read them
+class GLTFAnimationObj : public Node, public IAnimatic {
+   public:
+    enum class Path { TRANSLATION, ROTATION, SCALE };
+
+    struct Channel {
+        std::shared_ptr<Node> target;
+        Path path = Path::TRANSLATION;
+        // STEP keeps the value of the previous key, LINEAR interpolates (slerp for the rotations)
+        bool step = false;
+        std::vector<float> times;
+        // xyz, or the quaternion as stored by glTF (x, y, z, w)
+        std::vector<glm::vec4> values;
+    };
+
+    void addChannel(Channel p_channel);
+    float getDuration() const { return m_duration; }
+
+    void simulation(glm::vec3 gravite, float viscosite, uint32_t tick, float dt, float t) override;
+    bool isKinematic() const override { return true; }
+
+   private:
+    std::vector<Channel> m_channels;
+    float m_duration = 0.f;
+};
+
+}  // namespace TTe
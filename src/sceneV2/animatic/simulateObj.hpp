@@ -27,6 +27,7 @@ class SimulateObj : public Node, public IIndirectRenderable, public IAnimatic {
         this->_Fich_Points = other._Fich_Points;
         this->_Interaction = other._Interaction;
         this->_Friction = other._Friction;
+        this->P = other.P;
         this->V = other.V;
         this->A = other.A;
         this->Force = other.Force;
@@ -44,6 +45,7 @@ class SimulateObj : public Node, public IIndirectRenderable, public IAnimatic {
             this->_Fich_Points = other._Fich_Points;
             this->_Interaction = other._Interaction;
             this->_Friction = other._Friction;
+            this->P = other.P;
             this->V = other.V;
             this->A = other.A;
             this->Force = other.Force;
@@ -63,6 +65,7 @@ class SimulateObj : public Node, public IIndirectRenderable, public IAnimatic {
             this->_Fich_Points = other._Fich_Points;
             this->_Interaction = other._Interaction;
             this->_Friction = other._Friction;
+            this->P = other.P;
             this->V = other.V;
             this->A = other.A;
             this->Force = other.Force;
@@ -78,6 +81,7 @@ class SimulateObj : public Node, public IIndirectRenderable, public IAnimatic {
         this->_Fich_Points = other._Fich_Points;
         this->_Interaction = other._Interaction;
         this->_Friction = other._Friction;
+        this->P = other.P;
         this->V = other.V;
         this->A = other.A;
         this->Force = other.Force;
@@ -104,10 +108,14 @@ class SimulateObj : public Node, public IIndirectRenderable, public IAnimatic {
 
     /*! Gestion des collisions */
     virtual void Collision(std::vector<std::shared_ptr<ICollider>> &m_collision_objects) = 0;
+    virtual void collision(std::vector<std::shared_ptr<ICollider>> &m_collision_objects) override { Collision(m_collision_objects); }
 
     virtual void applyForcem_gravity(float t, glm::vec3 g) = 0;
     virtual void solveExplicit(float visco, float deltaT) = 0;
 
+    /*! Maillage deforme, recopie dans le snapshot de la scene pour le thread de rendu */
+    virtual Mesh *getDynamicMesh() override { return &mesh; }
+
     /*! Interaction avec l utilisateur */
     void Interaction(glm::ivec2 MousePos);
 
@@ -129,6 +137,9 @@ class SimulateObj : public Node, public IIndirectRenderable, public IAnimatic {
     /// 1=la particule repart aussi vite, 0=elle s'arrete
     float _Friction = 1.0f;
 
+    /// Declaration du tableau des positions (recopiees dans le maillage par updateVertex)
+    std::vector<glm::vec3> P;
+
     /// Declaration du tableau des vitesses
     std::vector<glm::vec3> V;
 
@@ -0,0 +1,338 @@
+/** \file AutoCollision.cpp
+ \brief Auto-collision des tissus (sommet-triangle et arete-arete) avec une table de hachage spatiale.
+ */
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <glm/geometric.hpp>
+#include <glm/glm.hpp>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+#include "ObjetSimuleMSS.h"
+#include "jobs/job_system.hpp"
+
+namespace TTe {
+
+/**
+ * Coordonnees barycentriques du point du triangle (a, b, c) le plus proche de p (Ericson, Real-Time Collision Detection 5.1.5).
+ */
+static glm::vec3 barycentrePlusProche(const glm::vec3 &p, const glm::vec3 &a, const glm::vec3 &b, const glm::vec3 &c) {
+    glm::vec3 ab = b - a;
+    glm::vec3 ac = c - a;
+    glm::vec3 ap = p - a;
+    float d1 = glm::dot(ab, ap);
+    float d2 = glm::dot(ac, ap);
+    if (d1 <= 0.f && d2 <= 0.f) return {1.f, 0.f, 0.f};
+
+    glm::vec3 bp = p - b;
+    float d3 = glm::dot(ab, bp);
+    float d4 = glm::dot(ac, bp);
+    if (d3 >= 0.f && d4 <= d3) return {0.f, 1.f, 0.f};
+
+    float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.f && d1 >= 0.f && d3 <= 0.f) {
+        float v = d1 / (d1 - d3);
+        return {1.f - v, v, 0.f};
+    }
+
+    glm::vec3 cp = p - c;
+    float d5 = glm::dot(ab, cp);
+    float d6 = glm::dot(ac, cp);
+    if (d6 >= 0.f && d5 <= d6) return {0.f, 0.f, 1.f};
+
+    float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.f && d2 >= 0.f && d6 <= 0.f) {
+        float w = d2 / (d2 - d6);
+        return {1.f - w, 0.f, w};
+    }
+
+    float va = d3 * d6 - d5 * d4;
+    if (va <= 0.f && (d4 - d3) >= 0.f && (d5 - d6) >= 0.f) {
+        float w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+        return {0.f, 1.f - w, w};
+    }
+
+    float denom = 1.f / (va + vb + vc);
+    float v = vb * denom;
+    float w = vc * denom;
+    return {1.f - v - w, v, w};
+}
+
+/**
+ * Parametres (s, t) des points les plus proches des segments [p1, q1] et [p2, q2] (Ericson 5.1.9).
+ */
+static glm::vec2 parametresPlusProches(const glm::vec3 &p1, const glm::vec3 &q1, const glm::vec3 &p2, const glm::vec3 &q2) {
+    const float eps = 1e-12f;
+    glm::vec3 d1 = q1 - p1;
+    glm::vec3 d2 = q2 - p2;
+    glm::vec3 r = p1 - p2;
+    float a = glm::dot(d1, d1);
+    float e = glm::dot(d2, d2);
+    float f = glm::dot(d2, r);
+
+    if (a <= eps && e <= eps) return {0.f, 0.f};
+    if (a <= eps) return {0.f, glm::clamp(f / e, 0.f, 1.f)};
+
+    float c = glm::dot(d1, r);
+    if (e <= eps) return {glm::clamp(-c / a, 0.f, 1.f), 0.f};
+
+    float b = glm::dot(d1, d2);
+    float denom = a * e - b * b;
+    float s = (denom != 0.f) ? glm::clamp((b * f - c * e) / denom, 0.f, 1.f) : 0.f;
+    float t = (b * s + f) / e;
+    if (t < 0.f) {
+        t = 0.f;
+        s = glm::clamp(-c / a, 0.f, 1.f);
+    } else if (t > 1.f) {
+        t = 1.f;
+        s = glm::clamp((b - c) / a, 0.f, 1.f);
+    }
+    return {s, t};
+}
+
+/**
+ * Modification de la quantite relative sum_k poids[k] * X[ids[k]] de delta,
+ * repartie entre les sommets selon leurs poids et l inverse de leurs masses (les sommets fixes ne bougent pas).
+ */
+static void repartitCorrection(
+    std::vector<glm::vec3> &X, const std::array<uint32_t, 4> &ids, const std::array<float, 4> &poids, const std::array<float, 4> &inv_masses,
+    const glm::vec3 &delta) {
+    float denom = 0.f;
+    for (int k = 0; k < 4; k++) denom += poids[k] * poids[k] * inv_masses[k];
+    if (denom <= 0.f) return;
+
+    glm::vec3 lambda = delta / denom;
+    for (int k = 0; k < 4; k++) X[ids[k]] += poids[k] * inv_masses[k] * lambda;
+}
+
+/**
+ * Auto-collision du tissu.
+ * Les contacts sont detectes en parallele a partir des tables de hachage des sommets et des milieux d aretes,
+ * puis resolus un par un dans un ordre fixe : correction des positions jusqu a l epaisseur du tissu,
+ * suppression de la vitesse relative d approche et frottement sur la vitesse tangentielle.
+ */
+void ObjetSimuleMSS::AutoCollision() {
+    const uint32_t nb_sommets = P.size();
+    const uint32_t nb_triangles = mesh.indicies.size() / 3;
+    const float h = _Epaisseur;
+    if (nb_sommets == 0 || nb_triangles == 0 || h <= 0.f) return;
+
+    /// Aretes uniques du maillage : ce sont les ressorts du MSS (une arete par ressort, triees)
+    if (_Aretes.empty()) _Aretes = _SystemeMasseRessort->_RessortParticules;
+    const uint32_t nb_aretes = _Aretes.size();
+
+    std::vector<glm::vec3> &X = _PosAuto;
+    X.resize(nb_sommets);
+    _MilieuxAretes.resize(nb_aretes);
+
+    /// Positions courantes, milieux des aretes et plus grande arete (taille des cellules)
+    JobSystem::parallelFor(0, nb_sommets, 0, [&](uint32_t i) { X[i] = P[i]; });
+
+    float longueur_max = 0.f;
+    std::mutex mutex;
+    JobSystem::parallelForRange(0, nb_aretes, 0, [&](uint32_t begin, uint32_t end) {
+        float longueur_locale = 0.f;
+        for (uint32_t e = begin; e < end; e++) {
+            glm::vec3 a = X[_Aretes[e].x];
+            glm::vec3 b = X[_Aretes[e].y];
+            _MilieuxAretes[e] = (a + b) * 0.5f;
+            longueur_locale = std::max(longueur_locale, glm::length(b - a));
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        longueur_max = std::max(longueur_max, longueur_locale);
+    });
+
+    float taille_cellule = std::max(longueur_max, 2.f * h);
+    _HashSommets.build(X, taille_cellule);
+    _HashAretes.build(_MilieuxAretes, taille_cellule);
+
+    /** Detection (parallele) **/
+    _ContactsST.clear();
+    _ContactsAA.clear();
+
+    /// Sommet - triangle
+    JobSystem::parallelForRange(0, nb_triangles, 64, [&](uint32_t begin, uint32_t end) {
+        std::vector<glm::uvec2> contacts;
+        for (uint32_t f = begin; f < end; f++) {
+            uint32_t a = mesh.indicies[3 * f];
+            uint32_t b = mesh.indicies[3 * f + 1];
+            uint32_t c = mesh.indicies[3 * f + 2];
+
+            BoundingBox box = BoundingBox::empty();
+            box.expand(X[a]);
+            box.expand(X[b]);
+            box.expand(X[c]);
+            box.pmin -= glm::vec3(h);
+            box.pmax += glm::vec3(h);
+
+            _HashSommets.query(box, [&](uint32_t p) {
+                if (p == a || p == b || p == c || !box.contains(X[p])) return;
+                glm::vec3 bary = barycentrePlusProche(X[p], X[a], X[b], X[c]);
+                glm::vec3 q = bary.x * X[a] + bary.y * X[b] + bary.z * X[c];
+                if (glm::length(X[p] - q) < h) contacts.push_back(glm::uvec2(p, f));
+            });
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        _ContactsST.insert(_ContactsST.end(), contacts.begin(), contacts.end());
+    });
+
+    /// Arete - arete, chaque paire n est testee que depuis sa plus petite arete
+    JobSystem::parallelForRange(0, nb_aretes, 256, [&](uint32_t begin, uint32_t end) {
+        std::vector<glm::uvec2> contacts;
+        for (uint32_t e1 = begin; e1 < end; e1++) {
+            glm::uvec2 arete1 = _Aretes[e1];
+            BoundingBox box = BoundingBox::empty();
+            box.expand(X[arete1.x]);
+            box.expand(X[arete1.y]);
+            // le milieu d une arete est a au plus une demi-longueur de chacun de ses points
+            box.pmin -= glm::vec3(h + longueur_max * 0.5f);
+            box.pmax += glm::vec3(h + longueur_max * 0.5f);
+
+            _HashAretes.query(box, [&](uint32_t e2) {
+                if (e2 <= e1) return;
+                glm::uvec2 arete2 = _Aretes[e2];
+                if (arete1.x == arete2.x || arete1.x == arete2.y || arete1.y == arete2.x || arete1.y == arete2.y) return;
+
+                glm::vec2 st = parametresPlusProches(X[arete1.x], X[arete1.y], X[arete2.x], X[arete2.y]);
+                // les extremites sont traitees par les contacts sommet - triangle
+                if (st.x <= 1e-3f || st.x >= 1.f - 1e-3f || st.y <= 1e-3f || st.y >= 1.f - 1e-3f) return;
+                glm::vec3 c1 = glm::mix(X[arete1.x], X[arete1.y], st.x);
+                glm::vec3 c2 = glm::mix(X[arete2.x], X[arete2.y], st.y);
+                if (glm::length(c1 - c2) < h) contacts.push_back(glm::uvec2(e1, e2));
+            });
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        _ContactsAA.insert(_ContactsAA.end(), contacts.begin(), contacts.end());
+    });
+
+    /// Ordre fixe : le resultat ne depend pas du decoupage en taches, les doublons (collisions de hachage) sont retires
+    auto inferieur = [](const glm::uvec2 &l, const glm::uvec2 &r) { return l.x < r.x || (l.x == r.x && l.y < r.y); };
+    std::sort(_ContactsST.begin(), _ContactsST.end(), inferieur);
+    _ContactsST.erase(std::unique(_ContactsST.begin(), _ContactsST.end()), _ContactsST.end());
+    std::sort(_ContactsAA.begin(), _ContactsAA.end(), inferieur);
+    _ContactsAA.erase(std::unique(_ContactsAA.begin(), _ContactsAA.end()), _ContactsAA.end());
+
+    /** Reponse (sequentielle, proportionnelle au nombre de contacts) **/
+    auto inverseMasse = [&](uint32_t i) { return _SystemeMasseRessort->_InvMasses[i]; };
+
+    auto reponse = [&](const std::array<uint32_t, 4> &ids, const std::array<float, 4> &poids, glm::vec3 n, float distance) {
+        std::array<float, 4> inv_masses = {inverseMasse(ids[0]), inverseMasse(ids[1]), inverseMasse(ids[2]), inverseMasse(ids[3])};
+
+        /// Separation jusqu a l epaisseur du tissu
+        repartitCorrection(X, ids, poids, inv_masses, n * (h - distance));
+
+        /// Vitesse relative : plus d approche, frottement sur la partie tangentielle
+        glm::vec3 v_rel(0.f);
+        for (int k = 0; k < 4; k++) v_rel += poids[k] * V[ids[k]];
+        float v_n = glm::dot(v_rel, n);
+        if (v_n < 0.f) {
+            glm::vec3 v_t = v_rel - v_n * n;
+            repartitCorrection(V, ids, poids, inv_masses, -v_n * n - _FrottementAuto * v_t);
+        }
+    };
+
+    for (const glm::uvec2 &contact : _ContactsST) {
+        uint32_t p = contact.x;
+        uint32_t a = mesh.indicies[3 * contact.y];
+        uint32_t b = mesh.indicies[3 * contact.y + 1];
+        uint32_t c = mesh.indicies[3 * contact.y + 2];
+
+        // les contacts precedents ont pu deplacer les sommets
+        glm::vec3 bary = barycentrePlusProche(X[p], X[a], X[b], X[c]);
+        glm::vec3 diff = X[p] - (bary.x * X[a] + bary.y * X[b] + bary.z * X[c]);
+        float distance = glm::length(diff);
+        if (distance >= h) continue;
+
+        glm::vec3 n;
+        if (distance > 1e-6f) {
+            n = diff / distance;
+        } else {
+            n = glm::cross(X[b] - X[a], X[c] - X[a]);
+            if (glm::length(n) < 1e-12f) continue;
+            n = glm::normalize(n);
+        }
+        reponse({p, a, b, c}, {1.f, -bary.x, -bary.y, -bary.z}, n, distance);
+    }
+
+    for (const glm::uvec2 &contact : _ContactsAA) {
+        glm::uvec2 arete1 = _Aretes[contact.x];
+        glm::uvec2 arete2 = _Aretes[contact.y];
+
+        glm::vec2 st = parametresPlusProches(X[arete1.x], X[arete1.y], X[arete2.x], X[arete2.y]);
+        glm::vec3 diff = glm::mix(X[arete1.x], X[arete1.y], st.x) - glm::mix(X[arete2.x], X[arete2.y], st.y);
+        float distance = glm::length(diff);
+        if (distance >= h) continue;
+
+        glm::vec3 n;
+        if (distance > 1e-6f) {
+            n = diff / distance;
+        } else {
+            n = glm::cross(X[arete1.y] - X[arete1.x], X[arete2.y] - X[arete2.x]);
+            if (glm::length(n) < 1e-12f) continue;
+            n = glm::normalize(n);
+        }
+        reponse({arete1.x, arete1.y, arete2.x, arete2.y}, {1.f - st.x, st.x, -(1.f - st.y), -st.y}, n, distance);
+    }
+
+    /// Recopie des positions corrigees
+    if (!_ContactsST.empty() || !_ContactsAA.empty()) {
+        JobSystem::parallelFor(0, nb_sommets, 0, [&](uint32_t i) { P[i] = X[i]; });
+    }
+}
+
+/**
+ * Mesure de l auto-collision.
+ * Le tissu (1 m de cote) est plie en deux, les deux moities sont a une demi-epaisseur l une de l autre :
+ * chaque sommet est en contact avec l autre moitie. L epaisseur est la moitie du pas de la grille, plus epaisse
+ * les sommets voisins dans le plan seraient aussi en contact. Les positions et vitesses sont remises a chaque pas
+ * pour mesurer toujours la meme configuration.
+ */
+void ObjetSimuleMSS::MesureAutoCollision(uint32_t resolution, uint32_t nb_pas) {
+    resolution = std::max(resolution, 4u);
+    nb_pas = std::max(nb_pas, 1u);
+
+    ObjetSimuleMSS tissu;
+    MSS mss;
+    tissu._SystemeMasseRessort = &mss;
+
+    const float pas_grille = 1.f / float(resolution - 1);
+    tissu._Epaisseur = 0.5f * pas_grille;
+    const uint32_t pli = resolution / 2;
+    for (uint32_t j = 0; j < resolution; j++) {
+        for (uint32_t i = 0; i < resolution; i++) {
+            glm::vec3 pos = j < pli ? glm::vec3(i * pas_grille, 0.f, j * pas_grille)
+                                    : glm::vec3(i * pas_grille, 0.5f * tissu._Epaisseur, (2 * pli - 1 - j) * pas_grille);
+            mss.AddParticule(pos, 1.f);
+        }
+    }
+    for (uint32_t j = 0; j + 1 < resolution; j++) {
+        for (uint32_t i = 0; i + 1 < resolution; i++) {
+            uint32_t a = j * resolution + i;
+            std::array<uint32_t, 6> faces = {a, a + 1, a + resolution, a + 1, a + resolution + 1, a + resolution};
+            tissu.mesh.indicies.insert(tissu.mesh.indicies.end(), faces.begin(), faces.end());
+            mss.MakeFace(faces[0], faces[1], faces[2]);
+            mss.MakeFace(faces[3], faces[4], faces[5]);
+        }
+    }
+    mss.ConstruitTopologie();
+
+    double duree_totale = 0.0;
+    for (uint32_t pas = 0; pas < nb_pas; pas++) {
+        tissu.P = mss._Positions;
+        tissu.V.assign(mss._Positions.size(), glm::vec3(0.f, -1.f, 0.f));
+
+        auto debut = std::chrono::high_resolution_clock::now();
+        tissu.AutoCollision();
+        duree_totale += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - debut).count();
+    }
+
+    std::cout << "Auto-collision " << resolution << "x" << resolution << " (" << mss.GetNbParticule() << " sommets, "
+              << tissu.mesh.indicies.size() / 3 << " triangles) : " << duree_totale / nb_pas << " ms par pas, "
+              << tissu._ContactsST.size() << " contacts sommet-triangle, " << tissu._ContactsAA.size() << " contacts arete-arete"
+              << std::endl;
+}
+
+}  // namespace TTe
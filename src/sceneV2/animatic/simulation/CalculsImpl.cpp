@@ -70,7 +70,7 @@ void SolveurImpl::Solve(float visco,
                         std::vector<glm::vec3> &Force,
                         std::vector<glm::vec3> &A,
                         std::vector<glm::vec3> &V,
-                        std::vector<Vertex> &P,
+                        std::vector<glm::vec3> &P,
                         std::vector<float> &M,
                         glm::vec3 gravite,
                         MSS * _SystemeMasseRessort)
@@ -278,7 +278,7 @@ void SolveurImpl::CalculVitesse(float visco,
  */
 void SolveurImpl::CalculPosition(int nb_som,
                                  std::vector<glm::vec3> &V,
-                                 std::vector<Vertex> &P)
+                                 std::vector<glm::vec3> &P)
 {
    
     
@@ -35,10 +35,12 @@ Programme calculant pour chaque particule i d un MSS son etat au pas de temps su
 #include <glm/matrix.hpp>
 #include <iostream>
 #include <memory>
+#include <span>
 
 // #include "ObjetSimule.h"
 #include "MSS.h"
 #include "ObjetSimuleMSS.h"
+#include "jobs/job_system.hpp"
 #include "sceneV2/Icollider.hpp"
 // #include "Viewer.h"
 
@@ -50,21 +52,29 @@ namespace TTe {
  * Calcul des forces appliquees sur les particules du systeme masses-ressorts.
  */
 void ObjetSimuleMSS::CalculForceSpring() {
-    // #pragma omp parallel for schedule(dynamic, 1)
-    // #pragma omp parallel for
-    for (auto &ressort : _SystemeMasseRessort->GetRessortList()) {
-        Particule *particule1 = ressort->GetParticuleA();
-        Particule *particule2 = ressort->GetParticuleB();
-
-        glm::vec3 direction = mesh.verticies[particule2->GetId()].pos - mesh.verticies[particule1->GetId()].pos;
-
-        glm::vec3 direction_norm = glm::normalize(direction);
-        glm::vec3 Fe = ressort->GetRaideur() * (glm::length(direction) - (ressort->GetLrepos() * 0.75f)) * direction_norm;
-        glm::vec3 Fv =
-            ressort->GetAmortissement() * glm::dot((V[particule1->GetId()] - V[particule2->GetId()]), direction_norm) * direction_norm;
-        this->Force[particule1->GetId()] += Fe + Fv;
-        this->Force[particule2->GetId()] -= Fe + Fv;
-    }
+    const MSS &mss = *_SystemeMasseRessort;
+
+    /// Chaque particule somme les forces de ses propres ressorts (voisins ranges par particule) :
+    /// pas d ecriture concurrente, les particules sont reparties par paquets entre les threads
+    JobSystem::parallelForRange(0, P.size(), 1024, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i) {
+            glm::vec3 force(0.0f);
+            for (uint32_t k = mss._DebutVoisins[i]; k < mss._DebutVoisins[i + 1]; ++k) {
+                uint32_t j = mss._Voisins[k];
+                uint32_t r = mss._RessortsVoisins[k];
+
+                glm::vec3 direction = P[j] - P[i];
+                float longueur = glm::length(direction);
+                if (longueur == 0.0f) continue;
+
+                glm::vec3 direction_norm = direction / longueur;
+                glm::vec3 Fe = mss._RessortRaideur[r] * (longueur - (mss._RessortLrepos[r] * 0.75f)) * direction_norm;
+                glm::vec3 Fv = mss._RessortAmortissement[r] * glm::dot((V[i] - V[j]), direction_norm) * direction_norm;
+                force += Fe + Fv;
+            }
+            Force[i] += force;
+        }
+    });
 
     /// f = somme_i (ki * (l(i,j)-l_0(i,j)) * uij ) + (nuij * (vi - vj) * uij) + (m*g) + force_ext
 
@@ -77,17 +87,13 @@ void ObjetSimuleMSS::applyForcem_gravity(float t, glm::vec3 g) {
     g = glm::inverse(wNormalMatrix()) * glm::vec4(g, 0.0);
     glm::vec3 wind = glm::inverse(wNormalMatrix()) * glm::normalize(glm::vec3(1.0, 0.0, 1.0)) * 5.f * glm::sin(t);
     // #pragma omp parallel for
-    for (int i = 0; i < mesh.verticies.size(); ++i) {
-        if (attachedNodes.find(i) != attachedNodes.end()) {
-            glm::vec3 pos = attachedNodes[i]->wMatrix()[3];
-            mesh.verticies[i].pos = pos;
-        }
-        if (M[i] == 0.0) {
-            A[i] = glm::vec3(0.0, 0.0, 0.0);
+    for (auto &attache : attachedNodes) {
+        P[attache.first] = attache.second->wMatrix()[3];
+    }
 
-            continue;
-        }
-        A[i] = (Force[i] + g + wind) / M[i] ;
+    const std::vector<float> &inv_masses = _SystemeMasseRessort->_InvMasses;
+    for (int i = 0; i < P.size(); ++i) {
+        A[i] = (Force[i] + g + wind) * inv_masses[i];
         Force[i] = glm::vec3(0.0, 0.0, 0.0);
     }
 }
@@ -97,9 +103,9 @@ void ObjetSimuleMSS::solveExplicit(float visco, float deltaT) {
 
     // #pragma omp parallel for schedule(dynamic, 1)
     // #pragma omp parallel for
-    for (int i = 0; i < mesh.verticies.size(); ++i) {
+    for (int i = 0; i < P.size(); ++i) {
         V[i] = (V[i] + deltaT * A[i]) * visco;
-        mesh.verticies[i].pos = mesh.verticies[i].pos + deltaT * V[i];
+        P[i] = P[i] + deltaT * V[i];
     }
 }
 
@@ -107,24 +113,61 @@ void ObjetSimuleMSS::solveExplicit(float visco, float deltaT) {
  * Gestion des collisions avec le sol.
  */
 void ObjetSimuleMSS::Collision(std::vector<std::shared_ptr<ICollider>> &m_collision_objects) {
-    glm::mat4 wMatrix = this->wMatrix();
-    glm::mat4 wInvMatrix = glm::inverse(this->wMatrix());
-
 	// time the execution
 	// auto start = std::chrono::high_resolution_clock::now();
 
-	
+    /// Solveur GPU : les colliders sont envoyes avec le pas, la reponse est calculee dans cloth_step.comp
+    if (_Integration == "gpu") {
+        for (auto &collisionObject : m_collision_objects) {
+            collisionObject->getGPUColliders(_PasGPU.colliders);
+        }
+        _SolveurGPU->AjoutPas(std::move(_PasGPU));
+        return;
+    }
 
-#pragma omp parallel for
-    for (int i = 0; i < mesh.verticies.size(); ++i) {
-        if (M[i] == 0 || i % 2 == 0) continue;
+    /// XPBD : les collisions sont des contraintes projetees a chaque sous-pas
+    if (_Integration == "xpbd") {
+        _SolveurXPBD->Solve(_PasXPBD, P, V, attachedNodes, m_collision_objects);
+        if (_AutoCollision) AutoCollision();
+        return;
+    }
 
-        for (auto &collisionObject : m_collision_objects) {
-            // mesh.verticies[i].pos = wMatrix * glm::vec4(mesh.verticies[i].pos, 1);
-            collisionObject->collisionPos(mesh.verticies[i].pos, V[i]);
-            // mesh.verticies[i].pos = wInvMatrix * glm::vec4(mesh.verticies[i].pos, 1);
+    /// Boite englobante du tissu : les colliders qui ne la touchent pas sont ignores
+    BoundingBox bounds = BoundingBox::empty();
+    for (auto &position : P) {
+        bounds.expand(position);
+    }
+
+    for (auto &collisionObject : m_collision_objects) {
+        BoundingBox collider_bounds = collisionObject->getColliderBounds();
+        if (!collider_bounds.overlaps(bounds)) continue;
+
+        /// Rassemble les sommets libres dans la boite du collider
+        _CollisionIds.clear();
+        _CollisionPos.clear();
+        _CollisionVit.clear();
+        for (uint32_t i = 0; i < P.size(); ++i) {
+            if (_SystemeMasseRessort->_InvMasses[i] == 0) continue;
+            if (!collider_bounds.contains(P[i])) continue;
+            _CollisionIds.push_back(i);
+            _CollisionPos.push_back(P[i]);
+            _CollisionVit.push_back(V[i]);
+        }
+
+        /// Reponse par paquets de sommets
+        JobSystem::parallelForRange(0, _CollisionIds.size(), 256, [&](uint32_t begin, uint32_t end) {
+            collisionObject->collide(
+                std::span<glm::vec3>(_CollisionPos).subspan(begin, end - begin), std::span<glm::vec3>(_CollisionVit).subspan(begin, end - begin));
+        });
+
+        for (uint32_t k = 0; k < _CollisionIds.size(); ++k) {
+            P[_CollisionIds[k]] = _CollisionPos[k];
+            V[_CollisionIds[k]] = _CollisionVit[k];
         }
     }
+
+    /// Collisions du tissu avec lui meme
+    if (_AutoCollision) AutoCollision();
 	auto end = std::chrono::high_resolution_clock::now();
 	// auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
 	// std::cout << "Collision time: " << duration.count() << "\n";
@@ -0,0 +1,296 @@
+/** \file LectureMSS.cpp
+ \brief Lecture des fichiers de donnees d un systeme masses-ressorts : fichiers texte projetes en memoire et format binaire.
+ */
+
+#include "LectureMSS.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+namespace TTe {
+
+namespace {
+
+/// Entete d un fichier .mssb, suivie des positions, masses, coordonnees de texture et indices
+struct EnteteMSSB {
+    char magie[4];
+    uint32_t version;
+    uint32_t nb_sommets;
+    uint32_t nb_indices;
+};
+
+constexpr char s_magie_mssb[4] = {'M', 'S', 'S', 'B'};
+constexpr uint32_t s_version_mssb = 1;
+
+/*! Fichier projete en memoire en lecture seule */
+class FichierProjete {
+   public:
+    explicit FichierProjete(const std::filesystem::path &chemin) : _Chemin(chemin.string()) {
+        int fd = open(chemin.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("Erreur d ouverture du fichier : " + _Chemin);
+
+        struct stat infos;
+        if (fstat(fd, &infos) != 0) {
+            close(fd);
+            throw std::runtime_error("Erreur de lecture du fichier : " + _Chemin);
+        }
+        _Taille = infos.st_size;
+
+        if (_Taille > 0) {
+            void *donnees = mmap(nullptr, _Taille, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (donnees == MAP_FAILED) {
+                close(fd);
+                throw std::runtime_error("Erreur de projection en memoire du fichier : " + _Chemin);
+            }
+            madvise(donnees, _Taille, MADV_SEQUENTIAL);
+            _Donnees = static_cast<const char *>(donnees);
+        }
+        close(fd);
+    }
+
+    ~FichierProjete() {
+        if (_Donnees) munmap(const_cast<char *>(_Donnees), _Taille);
+    }
+
+    FichierProjete(const FichierProjete &) = delete;
+    FichierProjete &operator=(const FichierProjete &) = delete;
+
+    const char *debut() const { return _Donnees; }
+    const char *fin() const { return _Donnees + _Taille; }
+    size_t taille() const { return _Taille; }
+    const std::string &chemin() const { return _Chemin; }
+
+   private:
+    std::string _Chemin;
+    const char *_Donnees = nullptr;
+    size_t _Taille = 0;
+};
+
+/*! Lecture des nombres separes par des blancs d un fichier texte */
+class LecteurTexte {
+   public:
+    explicit LecteurTexte(const FichierProjete &fichier) : _Fichier(fichier), _Pos(fichier.debut()), _Fin(fichier.fin()) {}
+
+    /*! Lecture de la valeur suivante, faux en fin de fichier */
+    template <typename T>
+    bool suivant(T &valeur) {
+        while (_Pos != _Fin && (*_Pos == ' ' || *_Pos == '\n' || *_Pos == '\r' || *_Pos == '\t')) ++_Pos;
+        if (_Pos == _Fin) return false;
+
+        auto [fin_valeur, erreur] = std::from_chars(_Pos, _Fin, valeur);
+        if (erreur != std::errc()) erreurLigne("valeur invalide");
+        _Pos = fin_valeur;
+        return true;
+    }
+
+    [[noreturn]] void erreurLigne(const std::string &message) const {
+        size_t ligne = 1 + std::count(_Fichier.debut(), _Pos, '\n');
+        throw std::runtime_error(_Fichier.chemin() + " ligne " + std::to_string(ligne) + " : " + message);
+    }
+
+   private:
+    const FichierProjete &_Fichier;
+    const char *_Pos;
+    const char *_Fin;
+};
+
+/*! Lecture de toutes les valeurs d un fichier texte */
+template <typename T>
+std::vector<T> litValeurs(LecteurTexte &lecteur, size_t reserve) {
+    std::vector<T> valeurs;
+    valeurs.reserve(reserve);
+    T valeur;
+    while (lecteur.suivant(valeur)) valeurs.push_back(valeur);
+    return valeurs;
+}
+
+/*! Verification des nombres de valeurs par sommet et des indices des faces, en nommant le fichier en cause */
+void verifie(
+    const DonneesMSS &donnees, const std::string &fichier_masses, const std::string &fichier_uv, const std::string &fichier_faces) {
+    size_t nb_sommets = donnees.positions.size();
+    if (donnees.masses.size() != nb_sommets) {
+        throw std::runtime_error(
+            fichier_masses + " : " + std::to_string(donnees.masses.size()) + " masses pour " + std::to_string(nb_sommets) + " sommets");
+    }
+    if (donnees.uv.size() != nb_sommets) {
+        throw std::runtime_error(
+            fichier_uv + " : " + std::to_string(donnees.uv.size()) + " coordonnees de texture pour " + std::to_string(nb_sommets) +
+            " sommets");
+    }
+    if (donnees.indices.size() % 3 != 0) {
+        throw std::runtime_error(fichier_faces + " : " + std::to_string(donnees.indices.size()) + " indices, pas un multiple de 3");
+    }
+    for (size_t i = 0; i < donnees.indices.size(); i++) {
+        if (donnees.indices[i] >= nb_sommets) {
+            throw std::runtime_error(
+                fichier_faces + " : face " + std::to_string(i / 3) + " utilise le sommet " + std::to_string(donnees.indices[i]) + " sur " +
+                std::to_string(nb_sommets));
+        }
+    }
+}
+
+}  // namespace
+
+/**
+ * Lecture des fichiers texte.
+ */
+DonneesMSS LitMSSTexte(
+    const std::filesystem::path &points, const std::filesystem::path &masses, const std::filesystem::path &textures,
+    const std::filesystem::path &faces) {
+    DonneesMSS donnees;
+
+    /* Positions, precedees du nombre de sommets */
+    {
+        FichierProjete fichier(points);
+        LecteurTexte lecteur(fichier);
+        uint32_t nb_sommets = 0;
+        if (!lecteur.suivant(nb_sommets)) lecteur.erreurLigne("nombre de sommets manquant");
+
+        std::vector<float> coords = litValeurs<float>(lecteur, size_t(nb_sommets) * 3);
+        if (coords.size() != size_t(nb_sommets) * 3) {
+            throw std::runtime_error(
+                fichier.chemin() + " : " + std::to_string(nb_sommets) + " sommets annonces, " + std::to_string(coords.size()) +
+                " coordonnees lues");
+        }
+        donnees.positions.resize(nb_sommets);
+        for (uint32_t i = 0; i < nb_sommets; i++) donnees.positions[i] = glm::vec3(coords[3 * i], coords[3 * i + 1], coords[3 * i + 2]);
+    }
+    size_t nb_sommets = donnees.positions.size();
+
+    /* Masses */
+    {
+        FichierProjete fichier(masses);
+        LecteurTexte lecteur(fichier);
+        donnees.masses = litValeurs<float>(lecteur, nb_sommets);
+    }
+
+    /* Coordonnees de texture */
+    if (!textures.empty() && std::filesystem::exists(textures)) {
+        FichierProjete fichier(textures);
+        LecteurTexte lecteur(fichier);
+        std::vector<float> coords = litValeurs<float>(lecteur, nb_sommets * 2);
+        if (coords.size() % 2 != 0) {
+            throw std::runtime_error(
+                fichier.chemin() + " : nombre impair de coordonnees de texture (" + std::to_string(coords.size()) + ")");
+        }
+        donnees.uv.resize(coords.size() / 2);
+        for (size_t i = 0; i < donnees.uv.size(); i++) donnees.uv[i] = glm::vec2(coords[2 * i], coords[2 * i + 1]);
+    } else {
+        donnees.uv.assign(nb_sommets, glm::vec2(0.f));
+    }
+
+    /* Faces */
+    {
+        FichierProjete fichier(faces);
+        LecteurTexte lecteur(fichier);
+        donnees.indices = litValeurs<uint32_t>(lecteur, nb_sommets * 6);
+    }
+
+    verifie(donnees, masses.string(), textures.string(), faces.string());
+    return donnees;
+}
+
+/**
+ * Lecture d un fichier binaire : verification de l entete et de la taille puis copie des tableaux.
+ */
+DonneesMSS LitMSSBinaire(const std::filesystem::path &chemin) {
+    FichierProjete fichier(chemin);
+
+    EnteteMSSB entete;
+    if (fichier.taille() < sizeof(entete)) throw std::runtime_error(fichier.chemin() + " : fichier binaire tronque");
+    std::memcpy(&entete, fichier.debut(), sizeof(entete));
+    if (std::memcmp(entete.magie, s_magie_mssb, sizeof(s_magie_mssb)) != 0) {
+        throw std::runtime_error(fichier.chemin() + " : ce n est pas un fichier .mssb");
+    }
+    if (entete.version != s_version_mssb) {
+        throw std::runtime_error(fichier.chemin() + " : version " + std::to_string(entete.version) + " non geree");
+    }
+
+    size_t n = entete.nb_sommets;
+    size_t taille_attendue =
+        sizeof(entete) + n * (sizeof(glm::vec3) + sizeof(float) + sizeof(glm::vec2)) + size_t(entete.nb_indices) * sizeof(uint32_t);
+    if (fichier.taille() != taille_attendue) {
+        throw std::runtime_error(
+            fichier.chemin() + " : " + std::to_string(fichier.taille()) + " octets, " + std::to_string(taille_attendue) + " attendus");
+    }
+
+    DonneesMSS donnees;
+    donnees.positions.resize(n);
+    donnees.masses.resize(n);
+    donnees.uv.resize(n);
+    donnees.indices.resize(entete.nb_indices);
+
+    const char *pos = fichier.debut() + sizeof(entete);
+    auto copie = [&pos](auto &tableau) {
+        size_t taille = tableau.size() * sizeof(tableau[0]);
+        std::memcpy(tableau.data(), pos, taille);
+        pos += taille;
+    };
+    copie(donnees.positions);
+    copie(donnees.masses);
+    copie(donnees.uv);
+    copie(donnees.indices);
+
+    verifie(donnees, fichier.chemin(), fichier.chemin(), fichier.chemin());
+    return donnees;
+}
+
+/**
+ * Ecriture d un fichier binaire.
+ */
+void EcritMSSBinaire(const std::filesystem::path &chemin, const DonneesMSS &donnees) {
+    verifie(donnees, chemin.string(), chemin.string(), chemin.string());
+
+    EnteteMSSB entete;
+    std::memcpy(entete.magie, s_magie_mssb, sizeof(s_magie_mssb));
+    entete.version = s_version_mssb;
+    entete.nb_sommets = donnees.positions.size();
+    entete.nb_indices = donnees.indices.size();
+
+    std::ofstream fichier(chemin, std::ios::binary);
+    if (!fichier) throw std::runtime_error("Erreur d ouverture du fichier : " + chemin.string());
+
+    fichier.write(reinterpret_cast<const char *>(&entete), sizeof(entete));
+    fichier.write(reinterpret_cast<const char *>(donnees.positions.data()), donnees.positions.size() * sizeof(glm::vec3));
+    fichier.write(reinterpret_cast<const char *>(donnees.masses.data()), donnees.masses.size() * sizeof(float));
+    fichier.write(reinterpret_cast<const char *>(donnees.uv.data()), donnees.uv.size() * sizeof(glm::vec2));
+    fichier.write(reinterpret_cast<const char *>(donnees.indices.data()), donnees.indices.size() * sizeof(uint32_t));
+    if (!fichier) throw std::runtime_error("Erreur d ecriture du fichier : " + chemin.string());
+}
+
+/**
+ * Conversion et mesure des temps de chargement.
+ */
+void ConvertitEtMesureMSS(
+    const std::filesystem::path &points, const std::filesystem::path &masses, const std::filesystem::path &textures,
+    const std::filesystem::path &faces, const std::filesystem::path &binaire, uint32_t nb_lectures) {
+    EcritMSSBinaire(binaire, LitMSSTexte(points, masses, textures, faces));
+    nb_lectures = std::max(nb_lectures, 1u);
+
+    /* Le resultat est garde pour que la lecture ne soit pas eliminee par le compilateur */
+    size_t nb_sommets = 0;
+    auto mesure = [&](auto &&lecture) {
+        auto debut = std::chrono::high_resolution_clock::now();
+        for (uint32_t i = 0; i < nb_lectures; i++) nb_sommets = lecture().positions.size();
+        std::chrono::duration<double, std::milli> duree = std::chrono::high_resolution_clock::now() - debut;
+        return duree.count() / nb_lectures;
+    };
+
+    double duree_texte = mesure([&] { return LitMSSTexte(points, masses, textures, faces); });
+    double duree_binaire = mesure([&] { return LitMSSBinaire(binaire); });
+
+    std::cout << "Lecture de " << nb_sommets << " sommets : texte " << duree_texte << " ms, binaire " << duree_binaire << " ms ("
+              << duree_texte / std::max(duree_binaire, 1e-6) << "x), converti dans " << binaire.string() << std::endl;
+}
+
+}  // namespace TTe
@@ -0,0 +1,54 @@
+//
+//  LectureMSS.h
+//
+//  Lecture des fichiers de donnees d un systeme masses-ressorts (texte ou binaire).
+//
+
+#ifndef Lecture_MSS_h
+#define Lecture_MSS_h
+
+/** Librairies de base **/
+#include <cstdint>
+#include <filesystem>
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+
+namespace TTe {
+
+/// Donnees d un tissu : une position, une masse et une coordonnee de texture par sommet, trois indices par face
+struct DonneesMSS {
+    std::vector<glm::vec3> positions;
+    std::vector<float> masses;
+    std::vector<glm::vec2> uv;
+    std::vector<uint32_t> indices;
+};
+
+/*
+ * Les fichiers texte (nombre de sommets puis positions, masses, coordonnees de texture, faces)
+ * sont projetes en memoire et lus avec std::from_chars.
+ * Le format binaire (.mssb) contient une entete puis les tableaux de DonneesMSS tels quels,
+ * il est charge par une simple copie.
+ * Les nombres de valeurs et les indices des faces sont verifies : une erreur leve std::runtime_error
+ * en indiquant le fichier (et la ligne pour les fichiers texte).
+ */
+
+/*! Lecture des fichiers texte, le fichier des textures est optionnel (coordonnees nulles) */
+DonneesMSS LitMSSTexte(
+    const std::filesystem::path &points, const std::filesystem::path &masses, const std::filesystem::path &textures,
+    const std::filesystem::path &faces);
+
+/*! Lecture d un fichier binaire */
+DonneesMSS LitMSSBinaire(const std::filesystem::path &chemin);
+
+/*! Ecriture d un fichier binaire (conversion des fichiers texte) */
+void EcritMSSBinaire(const std::filesystem::path &chemin, const DonneesMSS &donnees);
+
+/*! Conversion des fichiers texte en binaire puis mesure des deux lectures (moyenne sur nb_lectures) */
+void ConvertitEtMesureMSS(
+    const std::filesystem::path &points, const std::filesystem::path &masses, const std::filesystem::path &textures,
+    const std::filesystem::path &faces, const std::filesystem::path &binaire, uint32_t nb_lectures = 10);
+
+}  // namespace TTe
+
+#endif
@@ -30,6 +30,8 @@
 /** Librairies de base **/
 #include <math.h> 
 
+#include <algorithm>
+
 // Fichiers de gkit2light
 
 
@@ -40,79 +42,87 @@
 namespace TTe {
 
 
-
-
 /**
-* Calcul de la longueur au repos d un ressort.
+ * Ajout d une particule : position initiale et inverse de sa masse.
  */
-void Ressort::SetLrepos()
+uint32_t MSS::AddParticule(const glm::vec3 &pos, float masse)
 {
-    // Calcul de la longueur du ressort entre les deux particules :
-    // Distance entre les particules A et B constituant le ressort
-    // l(A,B) = sqrt( (xA-xB)2 + (yA-yB)2 + (zA-zB)2)
-    _Spring->_L0 = length(GetParticuleA()->GetPosition() - GetParticuleB()->GetPosition());
+    _Positions.push_back(pos);
+    _InvMasses.push_back(masse == 0.f ? 0.f : 1.f / masse);
+    return _InvMasses.size() - 1;
 }
 
 
 /**
 * Modification du systeme masses-ressorts : creation d une face (= 3 aretes).
  */
-void MSS::MakeFace(Particule *p1, Particule *p2, Particule *p3, Spring *R)
+void MSS::MakeFace(uint32_t p1, uint32_t p2, uint32_t p3)
 {
 	/* Une face est constituee de trois aretes */
 	// Construction de l arete entre p1 et p2
-	MakeEdge(p1, p2, R);
+	MakeEdge(p1, p2);
 	
 	// Construction de l arete entre p2 et p3
-	MakeEdge(p2, p3, R);
+	MakeEdge(p2, p3);
 	
 	// Construction de l arete entre p3 et p1
-	MakeEdge(p3, p1, R);
+	MakeEdge(p3, p1);
 }
 
 
 /**
  * Modification du systeme masses-ressorts : creation d une arete.
+ * Les doublons (arete partagee par deux faces) sont retires par ConstruitTopologie.
  */
-void MSS::MakeEdge(Particule *p1, Particule *p2, Spring *R)
+void MSS::MakeEdge(uint32_t p1, uint32_t p2)
 {
-	// Verification que le ressort entre ces deux particules n existe pas deja
-	bool exist = false;
-	
-	// Liste des ressorts relies a p1
-	std::vector<Ressort *> ressortList = p1->GetRessortList();
-	
-	// Parcours de la liste des ressorts de p1
-	for(int i=0; i<ressortList.size(); ++i)
-    {
-		// Regarde si il existe un ressort relie a p1 et p2
-		if ( ((ressortList[i])->GetParticuleA() == p2) || ((ressortList[i])->GetParticuleB() == p2))
-		{
-			// Le ressort existe deja entre p1 et p2
-			exist = true;
-			
-			// Arret du parcours 
-			break;
-		}
-		
+    if (p1 == p2) return;
+    _Aretes.push_back((uint64_t(std::min(p1, p2)) << 32) | std::max(p1, p2));
+}
+
+
+/**
+ * Construction des ressorts (un par arete distincte) et des voisins de chaque particule.
+ */
+void MSS::ConstruitTopologie()
+{
+    /* Aretes distinctes : tri puis suppression des doublons */
+    std::sort(_Aretes.begin(), _Aretes.end());
+    _Aretes.erase(std::unique(_Aretes.begin(), _Aretes.end()), _Aretes.end());
+
+    /* Ressorts : la longueur au repos est la distance initiale entre les particules */
+    uint32_t nb_ressorts = _Aretes.size();
+    _RessortParticules.resize(nb_ressorts);
+    _RessortLrepos.resize(nb_ressorts);
+    _RessortRaideur.assign(nb_ressorts, _RessOS._Raideur);
+    _RessortAmortissement.assign(nb_ressorts, _RessOS._Nu);
+    for (uint32_t r = 0; r < nb_ressorts; r++) {
+        glm::uvec2 particules(_Aretes[r] >> 32, _Aretes[r] & 0xffffffff);
+        _RessortParticules[r] = particules;
+        _RessortLrepos[r] = glm::length(_Positions[particules.x] - _Positions[particules.y]);
     }
-	
-	// Ajout d un nouveau ressort dans le systeme masses-ressorts
-	if (!exist)
-    {
-		// Construction d un ressort entre les particules p1 et p2
-		Ressort *res = new Ressort(p1, p2, R);
-		
-		// Ajout du ressort res dans la liste des ressorts de p1
-		p1->AddRessort(res);
-		
-		// Ajout du ressort res dans la liste des ressorts de p2
-		p2->AddRessort(res);
-		
-		// Ajout du ressort res dans la liste des ressorts du systeme masses-ressorts
-		this->AddRessort(res);
+    _Aretes.clear();
+    _Aretes.shrink_to_fit();
+
+    /* Voisins : chaque ressort apparait chez ses deux particules */
+    uint32_t nb_particules = _InvMasses.size();
+    _DebutVoisins.assign(nb_particules + 1, 0);
+    for (auto &particules : _RessortParticules) {
+        _DebutVoisins[particules.x + 1]++;
+        _DebutVoisins[particules.y + 1]++;
+    }
+    for (uint32_t i = 0; i < nb_particules; i++) _DebutVoisins[i + 1] += _DebutVoisins[i];
+
+    _Voisins.resize(_DebutVoisins.back());
+    _RessortsVoisins.resize(_DebutVoisins.back());
+    std::vector<uint32_t> curseurs(_DebutVoisins.begin(), _DebutVoisins.end() - 1);
+    for (uint32_t r = 0; r < nb_ressorts; r++) {
+        uint32_t a = _RessortParticules[r].x;
+        uint32_t b = _RessortParticules[r].y;
+        _Voisins[curseurs[a]] = b;
+        _RessortsVoisins[curseurs[a]++] = r;
+        _Voisins[curseurs[b]] = a;
+        _RessortsVoisins[curseurs[b]++] = r;
     }
-	
 }
 }
-
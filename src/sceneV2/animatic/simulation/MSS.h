@@ -31,19 +31,13 @@
 #include <stdio.h>
 #include <string.h>
 
+#include <cstdint>
 #include <glm/fwd.hpp>
 #include <glm/glm.hpp>
 #include <vector>
 
 namespace TTe {
 
-/**
- * \brief Structure de donnees d une particule :
- * reliee a un ensemble de ressorts
- * et caracterisee par sa position et son id.
- */
-class Particule;
-
 /**
  * \brief Structure pour definir les caracteristiques physiques
  * des ressorts : raideur, amortissement, facteur d amortissement
@@ -89,236 +83,74 @@ class Spring {
     float _Amorti;
 };
 
-/**
- * \brief Structure de donnees d un ressort :
- * constitue de deux particules a chacune de ses extremites, d un id
- * et caracterise par ses parametres physiques.
- */
-class Ressort {
-   public:
-    /*! Constructeur vide */
-    inline Ressort() {
-        _ParticuleA = NULL;
-        _ParticuleB = NULL;
-    }
-
-    /*! Ajout d un constructeur */
-    Ressort(Particule *p1, Particule *p2, Spring *R) {
-        // Particules connectees par le ressort
-        _ParticuleA = p1;
-        _ParticuleB = p2;
-
-        // R : nu, raideur, amortissement
-        _Spring = new Spring(*R);
-
-        // Calcul de la longueur au repos du ressort
-        SetLrepos();
-    }
-
-    /*! Ajout d un constructeur de copies physiques */
-    Ressort(Ressort &R) {
-        _ParticuleA = R.GetParticuleA();
-        _ParticuleB = R.GetParticuleB();
-        _Spring = R.GetSpring();
-    }
-
-    /*! Pour acceder a l identificateur */
-    inline int GetId() { return _Id; }
-
-    /*! Pour acceder a la particuleB */
-    inline Particule *GetParticuleA() { return _ParticuleA; }
-
-    /*! Pour acceder a la particuleA */
-    inline Particule *GetParticuleB() { return _ParticuleB; }
-
-    inline Particule *GetOtherParticule(Particule *P) {
-        if (P == _ParticuleA)
-            return _ParticuleB;
-        else
-            return _ParticuleA;
-    }
-
-    /*! Pour acceder aux caracteristiques du ressort */
-    inline Spring *GetSpring() { return _Spring; }
-
-    /*! Pour acceder a la raideur */
-    inline float GetRaideur() { return _Spring->_Raideur; }
-
-    /*! Pour acceder a l amortissement */
-    inline float GetAmortissement() { return _Spring->_Nu; }
-
-    /*! Pour acceder au facteur d amortissement */
-    inline float GetFactAmorti() { return _Spring->_Amorti; }
-
-    /*! Pour acceder a la longueur au repos */
-    inline float GetLrepos() { return _Spring->_L0; }
-
-    /*! Modification des donnees */
-    inline void SetId(int id) { _Id = id; }
-
-    /*! Modification de l amortissement du ressort */
-    inline void SetAmortiss(float nu) { _Spring->_Nu = nu; }
-
-    /*! Modification de la raideur du ressort */
-    inline void SetRaideur(float raideur) { _Spring->_Raideur = raideur; }
-
-    /*! Modification du facteur d amortissement du ressort */
-    inline void SetFactAmorti() { _Spring->SetFactAmorti(); }
-
-    /*! Modification de la longueur au repos */
-    void SetLrepos();
-
-   public:
-    /// Identificateur
-    int _Id;
-
-    /// Particule A du ressort
-    Particule *_ParticuleA;
-
-    /// Particule B du ressort
-    Particule *_ParticuleB;
-
-    /// Caracteristique du ressort (longueur au repos, raideur, nu, amortis.)
-    Spring *_Spring;
-};
-
-/**
- * \brief Structure de donnees d une particule :
- * reliee a un ensemble de ressorts
- * et caracterisee par sa position et son id.
- */
-class Particule {
-   public:
-    /*! Constructeur */
-    inline Particule(const glm::vec3 &C) {
-        _Id = 0;
-        _Pos = C;
-    }
-
-    /*! Ajout d un constructeur vide */
-    Particule() {}
-
-    /*! Ajout d un constructeur de copies physiques */
-    Particule(Particule &Part) {
-        _Id = Part.GetId();
-        _RessortList = Part.GetRessortList();
-        _Pos = Part.GetPosition();
-    }
-
-    /*! Pour acceder a l identificateur */
-    inline int GetId() { return _Id; }
-
-    /*! Pour acceder a la liste des ressorts de la particule */
-    inline std::vector<Ressort *> &GetRessortList() { return _RessortList; }
-
-    /*! Pour acceder a la position de la particule */
-    inline const glm::vec3 &GetPosition() const { return _Pos; }
-
-    /*! Pour acceder a la masse de la particule */
-    inline float GetMass() const { return _Mass; }
-
-    /*! Pour connaitre le nombre de voisins d une particule */
-    inline int GetNbVoisins() { return _RessortList.size(); }
-
-    /*! Modification de l identificateur */
-    inline void SetId(int id) { _Id = id; }
-
-    /*! Modification de la position */
-    inline void SetPosition(const glm::vec3 &C) { _Pos = C; }
-
-    /*! Modification de la masse */
-    inline void SetMass(float M) { _Mass = M; }
-
-    /*! Ajout d un ressort dans la liste des ressorts lies a la particule */
-    inline void AddRessort(Ressort *R) { _RessortList.push_back(R); }
-
-   public:
-    /// Identificateur
-    int _Id;
-
-    /// Ressorts relies a la particule
-    std::vector<Ressort *> _RessortList;
-
-    /// Position de la particule
-    glm::vec3 _Pos;
-
-    /// Masse de la particule
-    float _Mass;
-};
-
 /**
  * \brief Classe de base d un systeme masses-ressorts.
- * Il est constitue d un ensemble de particules et de ressorts.
+ * Les particules et les ressorts sont ranges dans des tableaux contigus (une valeur par tableau et par element),
+ * les voisins de chaque particule sont ranges de facon compacte : ceux de la particule i sont
+ * _Voisins[_DebutVoisins[i]] ... _Voisins[_DebutVoisins[i + 1] - 1].
  */
 class MSS {
    public:
     /*! Constructeur vide */
     inline MSS() {};
 
-    /*! Ajout d un destructeur : liberation de la memoire */
-    inline ~MSS();
-
     /**
      * Methodes permettant d acceder aux donnees de la classe.
      */
 
-    /*! Recuperation d une particule */
-    inline Particule *GetParticule(int id) { return _ParticuleList[id]; }
-
     /*! Recuperation le nombre de particule */
-    inline int GetNbParticule() const { return _ParticuleList.size(); }
-
-    /*! Pour acceder a la liste des particules du maillage */
-    inline std::vector<Particule *> &GetPartList() { return _ParticuleList; }
-
-    /*! Pour acceder a la liste des ressorts du maillage */
-    inline std::vector<Ressort *> &GetRessortList() { return _RessortList; }
-
-    /*! Pour acceder a la liste des particules du maillage */
-    inline const std::vector<Particule *> &GetPartListConst() const { return _ParticuleList; }
-
-    /*! Pour acceder a la liste des ressorts du maillage */
-    inline const std::vector<Ressort *> &GetRessortListConst() const { return _RessortList; }
+    inline int GetNbParticule() const { return _InvMasses.size(); }
 
     /*! Recuperation du nombre de ressorts dans le maillage */
-    inline int GetNbRessort() const { return _RessortList.size(); }
+    inline int GetNbRessort() const { return _RessortParticules.size(); }
+
+    /*! Pour connaitre le nombre de voisins d une particule */
+    inline int GetNbVoisins(uint32_t id) const { return _DebutVoisins[id + 1] - _DebutVoisins[id]; }
 
     /**
      * Methodes permettant de creer le maillage a partir des donnees
      */
 
-    /*! Ajout d une particule dans le maillage */
-    inline void AddParticule(Particule *P) { _ParticuleList.push_back(P); }
-
-    /*! Ajout d un ressort dans le maillage */
-    inline void AddRessort(Ressort *R) { _RessortList.push_back(R); }
+    /*! Ajout d une particule dans le maillage, renvoie son identificateur */
+    uint32_t AddParticule(const glm::vec3 &pos, float masse);
 
     /*! Modification du maillage : creation d une face */
-    void MakeFace(Particule *p1, Particule *p2, Particule *p3, Spring *R);
+    void MakeFace(uint32_t p1, uint32_t p2, uint32_t p3);
 
     /*! Modification du maillage : creation d une arete */
-    void MakeEdge(Particule *p1, Particule *p2, Spring *R);
+    void MakeEdge(uint32_t p1, uint32_t p2);
+
+    /*! Construction des ressorts et des voisins une fois toutes les faces ajoutees */
+    void ConstruitTopologie();
 
    public:
-    /// Particules du maillage
-    std::vector<Particule *> _ParticuleList;
+    /// Positions initiales des particules (longueurs au repos)
+    std::vector<glm::vec3> _Positions;
+
+    /// Inverse des masses, nul pour une particule fixe
+    std::vector<float> _InvMasses;
+
+    /// Particules reliees par chaque ressort
+    std::vector<glm::uvec2> _RessortParticules;
+
+    /// Longueur au repos, raideur et amortissement de chaque ressort
+    std::vector<float> _RessortLrepos;
+    std::vector<float> _RessortRaideur;
+    std::vector<float> _RessortAmortissement;
+
+    /// Debut des voisins de chaque particule (nombre de particules + 1 valeurs)
+    std::vector<uint32_t> _DebutVoisins;
 
-    /// Ressorts du maillage
-    std::vector<Ressort *> _RessortList;
+    /// Particule voisine et ressort qui la relie, ranges par particule
+    std::vector<uint32_t> _Voisins;
+    std::vector<uint32_t> _RessortsVoisins;
 
     /// Caracteristiques des ressorts
     Spring _RessOS;
-};
 
-/**
- * Destructeur de la classe MSS.
- */
-MSS::~MSS() {
-    // Destruction des particules du maillage
-    _ParticuleList.~vector<Particule *>();
-
-    // Destruction des ressorts du maillage
-    _RessortList.~vector<Ressort *>();
-}
+   private:
+    /// Aretes ajoutees par MakeEdge, avec doublons, cle (min << 32) | max
+    std::vector<uint64_t> _Aretes;
+};
 }  // namespace TTe
 #endif
@@ -29,7 +29,7 @@
 
 #include <algorithm>
 #include <cstdint>
-#include <fstream>
+#include <filesystem>
 #include <glm/fwd.hpp>
 #include <glm/geometric.hpp>
 #define GLM_ENABLE_EXPERIMENTAL
@@ -37,14 +37,17 @@
 
 #include <iostream>
 #include <ostream>
+#include <stdexcept>
 #include <vector>
 
 // Fichiers de master_meca_sim
+#include "LectureMSS.h"
 #include "MSS.h"
 #include "ObjetSimuleMSS.h"
 // #include "Viewer.h"
 #include "SolveurExpl.h"
 #include "SolveurImpl.h"
+#include "commandBuffer/commandPool_handler.hpp"
 
 // #include "draw.h"
 
@@ -65,6 +68,10 @@ ObjetSimuleMSS::ObjetSimuleMSS(Device *device, std::filesystem::path fich_param)
 
     initObjetSimule();
     initMeshObjet();
+
+    /* Les particules du solveur GPU partent de l etat initial lu dans les fichiers */
+    if (_Integration == "gpu") _SolveurGPU->Initialisation(device, _SystemeMasseRessort, P, mesh.indicies, V);
+    if (_Integration == "xpbd") _SolveurXPBD->Initialisation(_SystemeMasseRessort, P, mesh.indicies);
 }
 
 /**
@@ -72,82 +79,31 @@ ObjetSimuleMSS::ObjetSimuleMSS(Device *device, std::filesystem::path fich_param)
  a partir des donnees lues dans le fichier.
  */
 void ObjetSimuleMSS::initObjetSimule() {
-    /* Variables intermediaires pour la lecture des donnees */
-    glm::vec3 tmp_coord;
-    glm::vec2 tmp_uv;
-    float tmp_masse;
-
     /* Position min de tous les sommets */
     glm::vec3 Pmin(0.0, 0.0, 0.0);
 
     /* Position max de tous les sommets */
     glm::vec3 Pmax(0.0, 0.0, 0.0);
 
-    /** Lecture des positions des sommets **/
-
-    /// Fichier de donnees des points
-    std::ifstream _FichIn_Points(_Fich_Points.c_str());
-
-    /// Test ouverture du fichier
-    if (!_FichIn_Points) {
-        std::cout << "Erreur d ouverture du fichier de donnees des points : " << _Fich_Points << std::endl;
-
-        // Arret du programme
-        exit(1);
-    }
-    uint32_t _Nb_Sommets;
-    _FichIn_Points >> _Nb_Sommets;
-    std::cout << "Nombre de sommets " << _Nb_Sommets << std::endl;
-
-    /// Lecture du nombre de sommets
-    std::vector<glm::vec3> pos;
-    /// Lecture des positions
-    while (!_FichIn_Points.eof()) {
-        _FichIn_Points >> tmp_coord.x;
-        _FichIn_Points >> tmp_coord.y;
-        _FichIn_Points >> tmp_coord.z;
-
-        /// remplissage de P
-        pos.push_back(tmp_coord);
+    /** Lecture des sommets et des faces **/
+    /* Le fichier binaire est utilise s il est plus recent que les fichiers texte, sinon il est regenere */
+    DonneesMSS donnees;
+    bool binaire_a_jour = !_Fich_Binaire.empty() && std::filesystem::exists(_Fich_Binaire);
+    for (const std::filesystem::path &texte : {_Fich_Points, _Fich_Masses, std::filesystem::path(_Fich_FaceSet)}) {
+        if (binaire_a_jour && std::filesystem::exists(texte))
+            binaire_a_jour = std::filesystem::last_write_time(texte) <= std::filesystem::last_write_time(_Fich_Binaire);
     }
-    std::cout << "Positions lues ..." << std::endl;
-
-    /** Lecture de toutes les masses **/
-
-    std::ifstream _FichIn_Masses(_Fich_Masses.c_str());
 
-    /// Test ouverture du fichier
-    if (!_FichIn_Masses) {
-        std::cout << "Erreur d ouverture du fichier de donnees des masses : " << _Fich_Masses << std::endl;
-
-        // Arret du programme
-        exit(1);
-    }
-
-    /// Lecture des masses
-    while (!_FichIn_Masses.eof()) {
-        _FichIn_Masses >> tmp_masse;
-
-        /// Remplissage de M
-        M.push_back(tmp_masse);
+    if (binaire_a_jour) {
+        donnees = LitMSSBinaire(_Fich_Binaire);
+        std::cout << "Sommets et faces lus dans " << _Fich_Binaire << std::endl;
+    } else {
+        donnees = LitMSSTexte(_Fich_Points, _Fich_Masses, _Fich_Texture, _Fich_FaceSet);
+        std::cout << "Positions, masses, textures et faces lues ..." << std::endl;
+        if (!_Fich_Binaire.empty()) EcritMSSBinaire(_Fich_Binaire, donnees);
     }
-    std::cout << "Masses lues ..." << std::endl;
-
-    /* Fichier de donnees des textures */
-    std::ifstream _FichIn_Texture(_Fich_Texture.c_str());
-
-    /* Lecture des textures */
-    std::vector<glm::vec2> uv;
-    /// Lecture des coordonnees de texture
-    while (!_FichIn_Texture.eof()) {
-        _FichIn_Texture >> tmp_uv.r;
-        _FichIn_Texture >> tmp_uv.g;
-
-        /// Remplissage du tableau des textures
-        uv.push_back(tmp_uv);
-    }
-
-    std::cout << "Textures lues ..." << std::endl;
+    std::vector<glm::vec3> &pos = donnees.positions;
+    std::cout << "Nombre de sommets " << pos.size() << std::endl;
 
     /** Calculs intermediaires **/
     /* Calcul de Pmin et Pmax */
@@ -162,90 +118,45 @@ void ObjetSimuleMSS::initObjetSimule() {
     _Size.y = fabs(Pmin.y - Pmax.y);
     _Size.z = fabs(Pmin.z - Pmax.z);
     mesh.verticies.resize(pos.size());
+    P = pos;
+    M = std::move(donnees.masses);
+
+    /** Vecteur nulle pour initialiser les vitesses, accel, forces des sommets **/
+    V.assign(pos.size(), glm::vec3(0.0, 0.0, 0.0));
+    A.assign(pos.size(), glm::vec3(0.0, 0.0, 0.0));
+    Force.assign(pos.size(), glm::vec3(0.0, 0.0, 0.0));
 
     /*** Initialisation des tableaux pour chacun des sommets ***/
     for (int i = 0; i < pos.size(); ++i) {
         mesh.verticies[i].pos = pos[i];
-        mesh.verticies[i].uv = uv[i];
-        /** Vecteur nulle pour initialiser les vitesses,
-         accel, forces, des normales des sommets **/
-
-        V.push_back(glm::vec3(0.0, 0.0, 0.0));
-        A.push_back(glm::vec3(0.0, 0.0, 0.0));
-        Force.push_back(glm::vec3(0.0, 0.0, 0.0));
-
-        /** Ajout du sommet dans le systeme masses-ressorts **/
-        /* Construction d une particule */
-        Particule *Part = new Particule();
-
-        /* Attribution de son identificateur */
-        Part->SetId(i);
-
-        /* Position de la particule */
-        Part->SetPosition(pos[i]);
-        // TODO : cette position n est pas mise a jour car on se sert du tableau P
-        // TODO : mettre un pointeur sur la valeur contenue dans P[i] pour que la position de la particule soit mise � jour
+        mesh.verticies[i].uv = donnees.uv[i];
 
-        /* Masse de la particule */
-        Part->SetMass(M[i]);
-
-        /* Ajout effectif de la particule dans le systeme masses-ressorts */
-        _SystemeMasseRessort->AddParticule(Part);
+        /** Ajout du sommet dans le systeme masses-ressorts (son identificateur est i) **/
+        _SystemeMasseRessort->AddParticule(pos[i], M[i]);
 
     }  // for
 
     /** Constructions de toutes les facettes du maillage **/
+    /* Creation des facettes en mettant les sommets dans l ordre inverse des aiguilles d une montre */
+    mesh.indicies.reserve(donnees.indices.size());
+    for (size_t f = 0; f + 2 < donnees.indices.size(); f += 3) {
+        uint32_t v0 = donnees.indices[f];
+        uint32_t v1 = donnees.indices[f + 1];
+        uint32_t v2 = donnees.indices[f + 2];
 
-    std::ifstream _FichIn_FaceSet(_Fich_FaceSet.c_str());
-
-    // Test ouverture du fichier
-    if (!_FichIn_FaceSet) {
-        std::cout << "Erreur d ouverture du fichier de donnees des faceSet : " << _Fich_FaceSet << std::endl;
-
-        // Arret du programme
-        exit(1);
-    }
+        _SystemeMasseRessort->MakeFace(v2, v1, v0);
 
-    /// Nombre de facets
-    int nb_facet = 0;
-
-    /* Construction des facettes */
-    while (!_FichIn_FaceSet.eof()) {
-        /// Remplissage de allfacets
-        // push_back dans le tableau des indices des sommets
-        int vertexIds[3];
-        _FichIn_FaceSet >> vertexIds[0];
-        _FichIn_FaceSet >> vertexIds[1];
-        _FichIn_FaceSet >> vertexIds[2];
-
-        // _FichIn_FaceSet >> facet.fi;
-        // _FichIn_FaceSet >> facet.fj;
-        // _FichIn_FaceSet >> facet.fk;
-
-        /* Construction de la facette fi, fj, fk */
-        // Creation de la facet en mettant les sommets
-        // dans l ordre inverse des aiguilles d une montre
-        _SystemeMasseRessort->MakeFace(
-            _SystemeMasseRessort->GetParticule(vertexIds[2]), _SystemeMasseRessort->GetParticule(vertexIds[1]),
-            _SystemeMasseRessort->GetParticule(vertexIds[0]), &_SystemeMasseRessort->_RessOS);
-        if (vertexIds[0] >= pos.size() || vertexIds[1] >= pos.size() || vertexIds[2] >= pos.size()) {
-            std::cout << "Erreur dans les indices des sommets" << std::endl;
-            exit(1);
-        }
         // Recopie dans le tableau des indices des sommets
-        mesh.indicies.push_back(vertexIds[2]);
-        mesh.indicies.push_back(vertexIds[1]);
-        mesh.indicies.push_back(vertexIds[0]);
-        nb_facet++;
+        mesh.indicies.push_back(v2);
+        mesh.indicies.push_back(v1);
+        mesh.indicies.push_back(v0);
     }
 
-    /** Fermeture des fichiers de donnees **/
-    _FichIn_FaceSet.close();
-    _FichIn_Masses.close();
-    _FichIn_Points.close();
-    _FichIn_Texture.close();
+    /** Ressorts et voisins de chaque particule **/
+    _SystemeMasseRessort->ConstruitTopologie();
 
     /** Modification des normales **/
+    _Normales = NormalRecompute(mesh.indicies, mesh.verticies.size());
     setNormals();
 
     /** Message pour la fin de la creation du maillage **/
@@ -260,43 +171,8 @@ void ObjetSimuleMSS::initObjetSimule() {
  * Modification du tableau des normales (lissage des normales).
  */
 void ObjetSimuleMSS::setNormals() {
-    // Normale d une face
-    glm::vec3 normale;
-
-    // Norme d une normale
-    double Norme;
-
-    // Indices des sommets d une face
-    int a, b, c;
-
-    /* Parcours des faces du maillage */
-    for (unsigned int i = 0; i < mesh.indicies.size() / 3; ++i) {
-        // Sommets a, b, c de la face
-        a = mesh.indicies[3 * i];
-        b = mesh.indicies[(3 * i) + 1];
-        c = mesh.indicies[(3 * i) + 2];
-
-        normale = glm::triangleNormal(mesh.verticies[a].pos, mesh.verticies[b].pos, mesh.verticies[c].pos);
-        
-
-        // Modification des normales des sommets de la face
-        // Normale du sommet a
-        mesh.verticies[a].normal = mesh.verticies[a].normal + normale;
-
-        // Normale du sommet b
-        mesh.verticies[b].normal = mesh.verticies[b].normal + normale;
-
-        // Normale du sommet c
-        mesh.verticies[c].normal = mesh.verticies[c].normal + normale;
-
-    }  // for_i
-
-    /* Parcours des normales des sommets */
-    float norme;
-
-    for (auto &vertex : mesh.verticies) {
-        vertex.normal = glm::normalize(vertex.normal);
-    }
+    /* Normales recalculees (et non accumulees) a partir des triangles autour de chaque sommet */
+    _Normales.recompute(mesh.verticies);
 }
 
 /**
@@ -315,14 +191,40 @@ void ObjetSimuleMSS::initMeshObjet() {
  */
 void ObjetSimuleMSS::updateVertex() {
     // std::cout << "ObjetSimuleMSS::updateVertex() ..." << std::endl;
-    mesh.uploadToGPU();
+    for (uint32_t i = 0; i < P.size(); ++i) {
+        mesh.verticies[i].pos = P[i];
+    }
 }
 
 /**
  * Simulation de l objet.
  */
-void ObjetSimuleMSS::simulation(
-    glm::vec3 gravite, float viscosite, uint32_t tick, float dt, float t, std::vector<std::shared_ptr<ICollider>> &m_collision_objects) {
+void ObjetSimuleMSS::simulation(glm::vec3 gravite, float viscosite, uint32_t tick, float dt, float t) {
+    /** Solveur GPU : seuls les parametres du pas sont prepares, dans le repere de l objet comme applyForcem_gravity **/
+    if (_Integration == "gpu") {
+        glm::mat3 inv_normal = glm::inverse(wNormalMatrix());
+        _PasGPU.gravite = inv_normal * gravite;
+        _PasGPU.vent = inv_normal * glm::normalize(glm::vec3(1.0, 0.0, 1.0)) * 5.f * glm::sin(t);
+        _PasGPU.viscosite = viscosite;
+        _PasGPU.dt = dt;
+        _PasGPU.attaches.clear();
+        for (auto &attache : attachedNodes) {
+            _PasGPU.attaches.push_back({glm::vec3(attache.second->wMatrix()[3]), attache.first});
+        }
+        _PasGPU.colliders.clear();
+        return;
+    }
+
+    /** XPBD : les sous-pas ont besoin des colliders, ils sont calcules par Collision **/
+    if (_Integration == "xpbd") {
+        glm::mat3 inv_normal = glm::inverse(wNormalMatrix());
+        _PasXPBD.gravite = inv_normal * gravite;
+        _PasXPBD.vent = inv_normal * glm::normalize(glm::vec3(1.0, 0.0, 1.0)) * 5.f * glm::sin(t);
+        _PasXPBD.viscosite = viscosite;
+        _PasXPBD.dt = dt;
+        return;
+    }
+
     /* Calcul des forces dues aux ressorts */
     // std::cout << "Force.... " << std::endl;
     CalculForceSpring();
@@ -332,27 +234,22 @@ void ObjetSimuleMSS::simulation(
     if (_Integration == "explicite")
         applyForcem_gravity(t, gravite);
     else if (_Integration == "implicite")
-        _SolveurImpl->CalculAccel_ForceGravite(gravite, mesh.verticies.size(), A, Force, M);
+        _SolveurImpl->CalculAccel_ForceGravite(gravite, P.size(), A, Force, M);
 
     /* Calcul des vitesses et positions au temps t */
     // std::cout << "Vit.... " << std::endl;
     if (_Integration == "explicite")
         solveExplicit(viscosite, dt);
     else if (_Integration == "implicite")
-        _SolveurImpl->Solve(viscosite, mesh.verticies.size(), tick, Force, A, V, mesh.verticies, M, gravite, _SystemeMasseRessort);
-
-    /* ! Gestion des collisions  */
-    // Reponse : reste a la position du sol - arret des vitesses
-    // Penser au Translate de l objet dans la scene pour trouver plan coherent
-    Collision(m_collision_objects);
+        _SolveurImpl->Solve(viscosite, P.size(), tick, Force, A, V, P, M, gravite, _SystemeMasseRessort);
 
     // Affichage des positions
     //  AffichagePos(Tps);
 
-    /** Modification des normales **/
-    setNormals();
-    if(tick %5 == 0)
-        updateVertex();
+    /** Les collisions (Collision) puis les normales (setNormals) sont traitees par la scene
+        une fois que tous les objets ont avance, chaque etape etant parallelisee sur les objets **/
+
+    /** Les sommets sont envoyes au GPU par le thread de rendu via le snapshot de la scene **/
 }
 
 void ObjetSimuleMSS::render(CommandBuffer &cmd, RenderData &renderData) {
@@ -374,6 +271,57 @@ void ObjetSimuleMSS::render(CommandBuffer &cmd, RenderData &renderData) {
 //    vkCmdDrawIndexed(cmd, mesh.nbIndicies(), 1, 0, 0, 0);
 }
 
+void ObjetSimuleMSS::recordGPUSimulation(CommandBuffer &cmd, uint32_t frame_index) {
+    if (_Integration == "gpu") _SolveurGPU->Enregistre(cmd, frame_index, mesh);
+}
+
+/**
+ * Parite du solveur GPU avec le solveur explicite : le meme objet est avance par les deux solveurs avec les memes pas.
+ * Le fichier de parametres doit utiliser l integration explicite, sans attache ni collider.
+ */
+float ObjetSimuleMSS::TestPariteGPU(Device *device, std::filesystem::path fich_param, uint32_t nb_pas, float dt) {
+    ObjetSimuleMSS objet(device, fich_param);
+    if (objet._Integration != "explicite") throw std::runtime_error("TestPariteGPU : le fichier doit utiliser l integration explicite");
+
+    SolveurGPU solveur;
+    solveur.Initialisation(device, objet._SystemeMasseRessort, objet.P, objet.mesh.indicies, objet.V);
+
+    glm::vec3 gravite(0.0, -9.81, 0.0);
+    float viscosite = 0.995f;
+    float t = 0.f;
+    for (uint32_t pas_courant = 0; pas_courant < nb_pas; pas_courant++) {
+        /* GPU : memes parametres que simulation */
+        glm::mat3 inv_normal = glm::inverse(objet.wNormalMatrix());
+        SolveurGPU::Pas pas;
+        pas.gravite = inv_normal * gravite;
+        pas.vent = inv_normal * glm::normalize(glm::vec3(1.0, 0.0, 1.0)) * 5.f * glm::sin(t);
+        pas.viscosite = viscosite;
+        pas.dt = dt;
+        solveur.AjoutPas(std::move(pas));
+
+        CommandBuffer cmd = std::move(CommandPoolHandler::getCommandPool(device, device->getRenderQueue())->createCommandBuffer(1)[0]);
+        cmd.beginCommandBuffer();
+        solveur.Enregistre(cmd, 0, objet.mesh);
+        cmd.endCommandBuffer();
+        cmd.submitCommandBuffer({}, {}, nullptr, true);
+
+        /* CPU */
+        objet.CalculForceSpring();
+        objet.applyForcem_gravity(t, gravite);
+        objet.solveExplicit(viscosite, dt);
+        t += dt;
+    }
+
+    std::vector<glm::vec3> P_gpu, V_gpu;
+    solveur.LitParticules(P_gpu, V_gpu);
+    float ecart = 0.f;
+    for (size_t i = 0; i < objet.P.size(); i++) ecart = std::max(ecart, glm::length(P_gpu[i] - objet.P[i]));
+
+    std::cout << "Parite GPU / CPU : " << objet.P.size() << " sommets, " << nb_pas << " pas de " << dt * 1000.f
+              << " ms, ecart maximal des positions " << ecart << std::endl;
+    return ecart;
+}
+
 void ObjetSimuleMSS::attachToNode(uint32_t i, std::shared_ptr<Node> node) {
     // std::cout << "Attach to node " << i << std::endl;
     attachedNodes[i] = node;
@@ -19,9 +19,13 @@
 // Fichiers de master_meca_sim
 #include "MSS.h"
 #include "SolveurExpl.h"
+#include "SolveurGPU.h"
 #include "SolveurImpl.h"
+#include "SolveurXPBD.h"
+#include "SpatialHash.h"
 #include "device.hpp"
 #include "sceneV2/Icollider.hpp"
+#include "sceneV2/normal_recompute.hpp"
 #include "sceneV2/animatic/simulateObj.hpp"
 
 
@@ -48,6 +52,7 @@ public:
         this->_Fich_Points = other._Fich_Points;
         this->_Fich_Texture = other._Fich_Texture;
         this->_Fich_FaceSet = other._Fich_FaceSet;
+        this->_Fich_Binaire = other._Fich_Binaire;
    
       
         this->_Size = other._Size;
@@ -55,6 +60,12 @@ public:
         this->_Integration = other._Integration;
         this->_SolveurExpl = other._SolveurExpl;
         this->_SolveurImpl = other._SolveurImpl;
+        this->_SolveurGPU = other._SolveurGPU;
+        this->_SolveurXPBD = other._SolveurXPBD;
+        this->_AutoCollision = other._AutoCollision;
+        this->_Epaisseur = other._Epaisseur;
+        this->_FrottementAuto = other._FrottementAuto;
+        this->_Normales = other._Normales;
     }
 
     // copy assignment
@@ -67,11 +78,18 @@ public:
             this->_Fich_Points = other._Fich_Points;
             this->_Fich_Texture = other._Fich_Texture;
             this->_Fich_FaceSet = other._Fich_FaceSet;
+            this->_Fich_Binaire = other._Fich_Binaire;
             this->_Size = other._Size;
             this->_SystemeMasseRessort = other._SystemeMasseRessort;
             this->_Integration = other._Integration;
             this->_SolveurExpl = other._SolveurExpl;
             this->_SolveurImpl = other._SolveurImpl;
+            this->_SolveurGPU = other._SolveurGPU;
+            this->_SolveurXPBD = other._SolveurXPBD;
+            this->_AutoCollision = other._AutoCollision;
+            this->_Epaisseur = other._Epaisseur;
+            this->_FrottementAuto = other._FrottementAuto;
+            this->_Normales = other._Normales;
         }
         return *this;
     }
@@ -82,11 +100,18 @@ public:
         this->_Fich_Points = other._Fich_Points;
         this->_Fich_Texture = other._Fich_Texture;
         this->_Fich_FaceSet = other._Fich_FaceSet;
+        this->_Fich_Binaire = other._Fich_Binaire;
         this->_Size = other._Size;
         this->_SystemeMasseRessort = other._SystemeMasseRessort;
         this->_Integration = other._Integration;
         this->_SolveurExpl = other._SolveurExpl;
         this->_SolveurImpl = other._SolveurImpl;
+        this->_SolveurGPU = other._SolveurGPU;
+        this->_SolveurXPBD = other._SolveurXPBD;
+        this->_AutoCollision = other._AutoCollision;
+        this->_Epaisseur = other._Epaisseur;
+        this->_FrottementAuto = other._FrottementAuto;
+        this->_Normales = other._Normales;
     }
 
     // move assignment
@@ -97,11 +122,18 @@ public:
             this->_Fich_Points = other._Fich_Points;
             this->_Fich_Texture = other._Fich_Texture;
             this->_Fich_FaceSet = other._Fich_FaceSet;
+            this->_Fich_Binaire = other._Fich_Binaire;
             this->_Size = other._Size;
             this->_SystemeMasseRessort = other._SystemeMasseRessort;
             this->_Integration = other._Integration;
             this->_SolveurExpl = other._SolveurExpl;
             this->_SolveurImpl = other._SolveurImpl;
+            this->_SolveurGPU = other._SolveurGPU;
+            this->_SolveurXPBD = other._SolveurXPBD;
+            this->_AutoCollision = other._AutoCollision;
+            this->_Epaisseur = other._Epaisseur;
+            this->_FrottementAuto = other._FrottementAuto;
+            this->_Normales = other._Normales;
         }
         return *this;
     }
@@ -122,7 +154,7 @@ public:
     void CalculForceSpring();
 
     /*! Simulation de l objet */
-    void simulation(glm::vec3 gravite, float viscosite, uint32_t tick, float dt, float t, std::vector<std::shared_ptr<ICollider>> &m_collision_objects);
+    void simulation(glm::vec3 gravite, float viscosite, uint32_t tick, float dt, float t);
     void render(CommandBuffer &cmd, RenderData &renderData);
     
     void applyForcem_gravity(float t, glm::vec3 g);
@@ -130,12 +162,32 @@ public:
     
     /*! Gestion des collisions */
     void Collision(std::vector<std::shared_ptr<ICollider>> &m_collision_objects);
+
+    /*! Auto-collision du tissu (sommet-triangle et arete-arete) */
+    void AutoCollision();
+
+    /*! Mesure de l auto-collision sur un tissu synthetique de resolution x resolution sommets plie en deux, sans Device */
+    static void MesureAutoCollision(uint32_t resolution, uint32_t nb_pas = 20);
+
+    /*! Comparaison du solveur GPU avec le solveur explicite CPU sur nb_pas pas, renvoie l ecart maximal des positions */
+    static float TestPariteGPU(Device *device, std::filesystem::path fich_param, uint32_t nb_pas, float dt = 0.001f);
     
     /*! Mise a jour du Mesh (pour affichage) de l objet en fonction des nouvelles positions calculees */
     void updateVertex();
     
-    /*! Modification du tableau des normales de chaque sommet */
+    /*! Modification du tableau des normales de chaque sommet (en parallele, voir NormalRecompute) */
     void setNormals();
+    void updateDeformedMesh() override {
+        if (_Integration == "gpu") return;
+        updateVertex();
+        setNormals();
+    }
+
+    /*! Avec le solveur GPU les sommets ne passent plus par le CPU */
+    Mesh *getDynamicMesh() override { return _Integration == "gpu" ? nullptr : &mesh; }
+
+    /*! Execution des pas du solveur GPU, thread de rendu */
+    void recordGPUSimulation(CommandBuffer &cmd, uint32_t frame_index) override;
     
     /*! Calcul de la normale a une face  definies par les sommets (a, b, c) */
     void NormaleFace(glm::vec3 &normale, int a, int b, int c);
@@ -153,6 +205,9 @@ public:
     
     /// Fichier de donnees contenant les faceSet
     std::string _Fich_FaceSet;
+
+    /// Fichier binaire (.mssb) des sommets et faces, genere a partir des fichiers texte s il est absent ou perime
+    std::string _Fich_Binaire;
     
     /// Longueur du tissu dans chacune des directions x,y,z
     glm::vec3 _Size;
@@ -170,7 +225,46 @@ public:
     /// SolveurImpl : schema d integration implicite 
     SolveurImpl *_SolveurImpl;
 
+    /// SolveurGPU : schema d integration semi-implicite execute sur le GPU
+    SolveurGPU *_SolveurGPU = nullptr;
+
+    /// SolveurXPBD : dynamique basee positions avec sous-pas
+    SolveurXPBD *_SolveurXPBD = nullptr;
+
+    /// Parametres du pas XPBD, lus par simulation et utilises par Collision une fois les colliders a jour
+    SolveurXPBD::Pas _PasXPBD;
+
+    /// Pas du solveur GPU en cours de preparation : parametres lus par simulation, colliders par Collision
+    SolveurGPU::Pas _PasGPU;
+
     std::map<uint32_t, std::shared_ptr<Node>> attachedNodes;
+
+    /// Triangles autour de chaque sommet, pour le calcul des normales
+    NormalRecompute _Normales;
+
+    /// Sommets candidats a une collision (indices, positions et vitesses), reutilises a chaque pas
+    std::vector<uint32_t> _CollisionIds;
+    std::vector<glm::vec3> _CollisionPos;
+    std::vector<glm::vec3> _CollisionVit;
+
+    /// Auto-collision du tissu active (1) ou non (0)
+    int _AutoCollision = 0;
+
+    /// Epaisseur du tissu : distance minimale entre deux parties du tissu
+    float _Epaisseur = 0.01f;
+
+    /// Frottement lors d un contact du tissu avec lui meme : 0 = glisse, 1 = colle
+    float _FrottementAuto = 0.1f;
+
+    /// Donnees de l auto-collision, reutilisees a chaque pas
+    std::vector<glm::uvec2> _Aretes;
+    std::vector<glm::vec3> _PosAuto;
+    std::vector<glm::vec3> _MilieuxAretes;
+    SpatialHash _HashSommets;
+    SpatialHash _HashAretes;
+    /// Contacts (sommet, triangle) et (arete, arete)
+    std::vector<glm::uvec2> _ContactsST;
+    std::vector<glm::uvec2> _ContactsAA;
     
 };
 
@@ -204,6 +204,9 @@ void ObjetSimuleMSS::Param_mss(std::string Fichier_Param)
     /* Fichier contenant les masses du maillage */
     GET_PARAM("textures", _Fich_Texture);
     
+    /* Fichier binaire des sommets et faces (optionnel) */
+    GET_PARAM("binaire", _Fich_Binaire);
+    
     /* Raideur */
     GET_PARAM("k", _SystemeMasseRessort->_RessOS._Raideur);
     
@@ -212,6 +215,11 @@ void ObjetSimuleMSS::Param_mss(std::string Fichier_Param)
     
     // Type d integration
     GET_PARAM("integration", _Integration);
+
+    /* Auto-collision, epaisseur et frottement du tissu sur lui meme */
+    GET_PARAM("autocollision", _AutoCollision);
+    GET_PARAM("epaisseur", _Epaisseur);
+    GET_PARAM("frottementauto", _FrottementAuto);
     
     /// Choix du solveur
     if (_Integration == "explicite")
@@ -239,6 +247,36 @@ void ObjetSimuleMSS::Param_mss(std::string Fichier_Param)
         GET_PARAM("nbitervitimpl", _SolveurImpl->m_nb_iter_VitImpl);
             
     }
+    else if (_Integration == "xpbd")
+    {
+        _SolveurXPBD = new SolveurXPBD();
+        
+        std::cout << "Utilisation de la dynamique basee positions (XPBD)"
+        << std::endl;
+        
+        /* Le pas de temps est celui de la scene, "dt" n est pas lu */
+        
+        /* Sous-pas et iterations par sous-pas */
+        GET_PARAM("nbsouspas", _SolveurXPBD->_NbSousPas);
+        GET_PARAM("nbiterxpbd", _SolveurXPBD->_NbIterations);
+        
+        /* Compliances (inverse des raideurs), l etirement reprend k par defaut */
+        GET_PARAM("complianceetirement", _SolveurXPBD->_ComplianceEtirement);
+        GET_PARAM("compliancecourbure", _SolveurXPBD->_ComplianceCourbure);
+        GET_PARAM("compliancecollision", _SolveurXPBD->_ComplianceCollision);
+        
+    }
+    else if (_Integration == "gpu")
+    {
+        _SolveurGPU = new SolveurGPU();
+        
+        std::cout << "Utilisation du schema d integration d'Euler semi-implicite sur le GPU"
+        << std::endl;
+        
+        /* Intervalle de temps */
+        GET_PARAM("dt", _SolveurGPU->_delta_t);
+        
+    }
     
 }//void
 
@@ -75,14 +75,14 @@ void SolveurExpl::CalculAccel_ForceGravite(
  *  x(t+dt) = x(t) + dt x'(t+dt)
  */
 void SolveurExpl::Solve(
-    float visco, int nb_som, float deltaT, std::vector<glm::vec3> &A, std::vector<glm::vec3> &V, std::vector<Vertex> &P) {
+    float visco, int nb_som, float deltaT, std::vector<glm::vec3> &A, std::vector<glm::vec3> &V, std::vector<glm::vec3> &P) {
     deltaT = std::min(0.0025f, deltaT);
 
     // #pragma omp parallel for schedule(dynamic, 1)
     // #pragma omp parallel for
     for (int i = 0; i < nb_som; ++i) {
         V[i] = (V[i] + deltaT * A[i]) * visco;
-        P[i].pos = P[i].pos + deltaT * V[i];
+        P[i] = P[i] + deltaT * V[i];
     }
 }  // void
 }  // namespace TTe
\ No newline at end of file
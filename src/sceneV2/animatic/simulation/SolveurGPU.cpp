@@ -0,0 +1,275 @@
+/** \file SolveurGPU.cpp
+ \brief Schema d'Euler semi-implicite du systeme masses-ressorts execute par des compute shaders.
+ */
+
+#include "SolveurGPU.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#include "commandBuffer/commandPool_handler.hpp"
+#include "sceneV2/render_data.hpp"
+#include "structs_vk.hpp"
+
+namespace TTe {
+
+namespace {
+
+/// Particule telle que lue par cloth_step.comp et cloth_normals.comp
+struct ParticuleGPU {
+    glm::vec3 pos;
+    float inv_masse;
+    glm::vec3 vit;
+    uint32_t pad = 0;
+};
+
+/// Ressort vu d une de ses particules
+struct RessortGPU {
+    uint32_t voisin;
+    float lrepos;
+    float raideur;
+    float amortissement;
+};
+
+/*! Memes colliders ou attaches, octet par octet */
+template <typename T>
+bool memesDonnees(const std::vector<T> &a, const std::vector<T> &b) {
+    return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+}
+
+/*! Tampon GPU rempli par une copie enregistree dans cmd */
+template <typename T>
+Buffer creeTampon(Device *device, const std::vector<T> &donnees, CommandBuffer &cmd) {
+    Buffer tampon(
+        device, sizeof(T), std::max<uint32_t>(donnees.size(), 1),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        Buffer::BufferType::GPU_ONLY);
+    if (donnees.empty()) return tampon;
+
+    Buffer *staging = new Buffer(device, sizeof(T), donnees.size(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, Buffer::BufferType::STAGING, 0);
+    staging->writeToBuffer(const_cast<T *>(donnees.data()), donnees.size() * sizeof(T));
+    Buffer::copyBuffer(device, *staging, tampon, &cmd, donnees.size() * sizeof(T));
+    cmd.addRessourceToDestroy(staging);
+    return tampon;
+}
+
+/*! Agrandissement d un tampon d image si besoin puis ecriture des donnees */
+template <typename T>
+void ecritTamponImage(Device *device, Buffer &tampon, std::vector<T> &donnees) {
+    if (tampon.getInstancesCount() < std::max<size_t>(donnees.size(), 1)) {
+        tampon = Buffer(
+            device, sizeof(T), std::max<size_t>(donnees.size() * 2, 16), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, Buffer::BufferType::DYNAMIC);
+    }
+    if (!donnees.empty()) tampon.writeToBuffer(donnees.data(), donnees.size() * sizeof(T));
+}
+
+}  // namespace
+
+/**
+ * Construction des tampons des particules, des ressorts et de l adjacence des triangles.
+ */
+void SolveurGPU::Initialisation(
+    Device *device, MSS *mss, const std::vector<glm::vec3> &P, const std::vector<uint32_t> &indices, const std::vector<glm::vec3> &V) {
+    _Device = device;
+    _NbParticules = P.size();
+
+    /* Particules, une masse nulle fixe la particule */
+    std::vector<ParticuleGPU> particules(_NbParticules);
+    for (uint32_t i = 0; i < _NbParticules; i++) {
+        particules[i].pos = P[i];
+        particules[i].inv_masse = mss->_InvMasses[i];
+        particules[i].vit = V[i];
+    }
+
+    /* Ressorts ranges par particule : les voisins du MSS, chaque ressort apparait chez ses deux particules */
+    std::vector<RessortGPU> ressorts(mss->_Voisins.size());
+    for (uint32_t k = 0; k < ressorts.size(); k++) {
+        uint32_t r = mss->_RessortsVoisins[k];
+        ressorts[k] = {mss->_Voisins[k], mss->_RessortLrepos[r], mss->_RessortRaideur[r], mss->_RessortAmortissement[r]};
+    }
+
+    /* Triangles autour de chaque sommet */
+    uint32_t nb_triangles = indices.size() / 3;
+    std::vector<uint32_t> debut_triangles(_NbParticules + 1, 0);
+    for (uint32_t i = 0; i < nb_triangles * 3; i++) debut_triangles[indices[i] + 1]++;
+    for (uint32_t i = 0; i < _NbParticules; i++) debut_triangles[i + 1] += debut_triangles[i];
+
+    std::vector<uint32_t> triangles_sommet(debut_triangles.back());
+    std::vector<uint32_t> curseurs(debut_triangles.begin(), debut_triangles.end() - 1);
+    for (uint32_t i = 0; i < nb_triangles * 3; i++) triangles_sommet[curseurs[indices[i]]++] = i / 3;
+
+    /* Envoi au GPU */
+    CommandBuffer cmd = std::move(CommandPoolHandler::getCommandPool(_Device, _Device->getTransferQueue())->createCommandBuffer(1)[0]);
+    cmd.beginCommandBuffer();
+    _Particules[0] = creeTampon(_Device, particules, cmd);
+    _Particules[1] = creeTampon(_Device, particules, cmd);
+    _Courant = 0;
+    _Ressorts = creeTampon(_Device, ressorts, cmd);
+    _DebutRessorts = creeTampon(_Device, mss->_DebutVoisins, cmd);
+    _Indices = creeTampon(_Device, indices, cmd);
+    _DebutTrianglesSommet = creeTampon(_Device, debut_triangles, cmd);
+    _TrianglesSommet = creeTampon(_Device, triangles_sommet, cmd);
+    cmd.endCommandBuffer();
+    cmd.submitCommandBuffer({}, {}, nullptr, true);
+
+#ifdef DEFAULT_APP_PATH
+    _PipelinePas = ComputePipeline(_Device, "shaders/cloth_step.comp");
+    _PipelineNormales = ComputePipeline(_Device, "shaders/cloth_normals.comp");
+#else
+    _PipelinePas = ComputePipeline(_Device, "TTengine-2/shaders/cloth_step.comp");
+    _PipelineNormales = ComputePipeline(_Device, "TTengine-2/shaders/cloth_normals.comp");
+#endif
+}
+
+void SolveurGPU::AjoutPas(Pas &&pas) {
+    std::lock_guard<std::mutex> lock(_MutexPas);
+    _PasEnAttente.push_back(std::move(pas));
+}
+
+/**
+ * Execution des pas en attente puis ecriture des positions et normales dans le maillage.
+ */
+void SolveurGPU::Enregistre(CommandBuffer &cmd, uint32_t frame_index, Mesh &mesh) {
+    {
+        std::lock_guard<std::mutex> lock(_MutexPas);
+        std::swap(_PasEnAttente, _PasAEnregistrer);
+        _PasEnAttente.clear();
+    }
+    if (_PasAEnregistrer.empty() || _NbParticules == 0) return;
+
+    /// Le GPU a pris du retard : des pas consecutifs sont fusionnes, le temps simule est garde.
+    /// Les pas dont les colliders et les attaches n ont pas change sont fusionnes d abord, sans perte
+    if (_PasAEnregistrer.size() > s_max_pas_par_image) {
+        size_t nb_pas = _PasAEnregistrer.size();
+        std::vector<Pas> fusionnes;
+        fusionnes.push_back(std::move(_PasAEnregistrer[0]));
+        for (size_t p = 1; p < nb_pas; p++) {
+            Pas &pas = _PasAEnregistrer[p];
+            bool trop_de_pas = fusionnes.size() + (nb_pas - p) > s_max_pas_par_image;
+            if (trop_de_pas && memesDonnees(fusionnes.back().colliders, pas.colliders) &&
+                memesDonnees(fusionnes.back().attaches, pas.attaches)) {
+                pas.dt += fusionnes.back().dt;
+                fusionnes.back() = std::move(pas);
+            } else {
+                fusionnes.push_back(std::move(pas));
+            }
+        }
+
+        /* Sinon les plus anciens sont fusionnes dans le suivant, le pas fusionne porte les colliders et attaches les plus recents */
+        size_t nb_avec_perte = 0;
+        float dt_avec_perte = 0.f;
+        while (fusionnes.size() > s_max_pas_par_image) {
+            dt_avec_perte += fusionnes[0].dt;
+            fusionnes[1].dt += fusionnes[0].dt;
+            fusionnes.erase(fusionnes.begin());
+            nb_avec_perte++;
+        }
+        std::cout << "SolveurGPU : " << nb_pas << " pas en retard executes en " << fusionnes.size() << " pas";
+        if (nb_avec_perte > 0) {
+            std::cout << ", colliders et attaches de " << nb_avec_perte << " pas remplaces par les suivants (" << dt_avec_perte * 1000.f
+                      << " ms)";
+        }
+        std::cout << std::endl;
+        _PasAEnregistrer = std::move(fusionnes);
+    }
+
+    /* Colliders et attaches de tous les pas dans les tampons de l image */
+    _CollidersImage.clear();
+    _AttachesImage.clear();
+    for (size_t p = 0; p < _PasAEnregistrer.size(); p++) {
+        _CollidersImage.insert(_CollidersImage.end(), _PasAEnregistrer[p].colliders.begin(), _PasAEnregistrer[p].colliders.end());
+        _AttachesImage.insert(_AttachesImage.end(), _PasAEnregistrer[p].attaches.begin(), _PasAEnregistrer[p].attaches.end());
+    }
+    ecritTamponImage(_Device, _Colliders[frame_index], _CollidersImage);
+    ecritTamponImage(_Device, _Attaches[frame_index], _AttachesImage);
+
+    /* Pas de temps, chacun lit les particules ecrites par le precedent */
+    _Particules[_Courant].addBufferMemoryBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    _PipelinePas.bindPipeline(cmd);
+
+    uint32_t debut_colliders = 0;
+    uint32_t debut_attaches = 0;
+    for (size_t p = 0; p < _PasAEnregistrer.size(); p++) {
+        Pas &pas = _PasAEnregistrer[p];
+
+        PushConstantClothStepStruct pc;
+        pc.springs_buffer = _Ressorts.getBufferDeviceAddress();
+        pc.spring_starts_buffer = _DebutRessorts.getBufferDeviceAddress();
+        pc.colliders_buffer = _Colliders[frame_index].getBufferDeviceAddress(debut_colliders * sizeof(ColliderGPU));
+        pc.attachments_buffer = _Attaches[frame_index].getBufferDeviceAddress(debut_attaches * sizeof(AttacheGPU));
+        pc.gravity = pas.gravite;
+        pc.damping = pas.viscosite;
+        pc.wind = pas.vent;
+        pc.nb_particles = _NbParticules;
+        pc.nb_colliders = pas.colliders.size();
+        pc.nb_attachments = pas.attaches.size();
+
+        // le schema explicite n est stable que pour des pas courts : le pas est decoupe en sous-pas egaux
+        uint32_t nb_sous_pas = std::max<uint32_t>(uint32_t(std::ceil(pas.dt / s_dt_max)), 1);
+        pc.dt = pas.dt / nb_sous_pas;
+        for (uint32_t sous_pas = 0; sous_pas < nb_sous_pas; sous_pas++) {
+            pc.particles_in_buffer = _Particules[_Courant].getBufferDeviceAddress();
+            pc.particles_out_buffer = _Particules[1 - _Courant].getBufferDeviceAddress();
+
+            vkCmdPushConstants(cmd, _PipelinePas.getPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pc), &pc);
+            _PipelinePas.dispatch(cmd, _NbParticules, 1, 1);
+
+            _Courant = 1 - _Courant;
+            _Particules[_Courant].addBufferMemoryBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+        }
+        debut_colliders += pas.colliders.size();
+        debut_attaches += pas.attaches.size();
+    }
+    _PasAEnregistrer.clear();
+
+    /* Positions et normales ecrites dans le tampon de sommets, une fois l image precedente dessinee */
+    Buffer &sommets = mesh.getVertexBuffer();
+    sommets.addBufferMemoryBarrier(cmd, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+    PushConstantClothNormalStruct pc_normales;
+    pc_normales.particles_buffer = _Particules[_Courant].getBufferDeviceAddress();
+    pc_normales.indices_buffer = _Indices.getBufferDeviceAddress();
+    pc_normales.vertex_triangle_starts_buffer = _DebutTrianglesSommet.getBufferDeviceAddress();
+    pc_normales.vertex_triangles_buffer = _TrianglesSommet.getBufferDeviceAddress();
+    pc_normales.verticies_buffer = sommets.getBufferDeviceAddress(mesh.getFirstVertex() * sizeof(Vertex));
+    pc_normales.nb_vertex = _NbParticules;
+
+    _PipelineNormales.bindPipeline(cmd);
+    vkCmdPushConstants(cmd, _PipelineNormales.getPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pc_normales), &pc_normales);
+    _PipelineNormales.dispatch(cmd, _NbParticules, 1, 1);
+
+    sommets.addBufferMemoryBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT);
+}
+
+/**
+ * Lecture des particules, pour comparer avec le solveur CPU.
+ */
+void SolveurGPU::LitParticules(std::vector<glm::vec3> &P, std::vector<glm::vec3> &V) {
+    Buffer lecture(
+        _Device, sizeof(ParticuleGPU), std::max<uint32_t>(_NbParticules, 1), VK_BUFFER_USAGE_TRANSFER_DST_BIT, Buffer::BufferType::READBACK,
+        0);
+
+    CommandBuffer cmd = std::move(CommandPoolHandler::getCommandPool(_Device, _Device->getRenderQueue())->createCommandBuffer(1)[0]);
+    cmd.beginCommandBuffer();
+    auto barriere = make<VkMemoryBarrier>();
+    barriere.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barriere.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    vkCmdPipelineBarrier(
+        cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barriere, 0, nullptr, 0, nullptr);
+    Buffer::copyBuffer(_Device, _Particules[_Courant], lecture, &cmd, _NbParticules * sizeof(ParticuleGPU));
+    cmd.endCommandBuffer();
+    cmd.submitCommandBuffer({}, {}, nullptr, true);
+
+    std::vector<ParticuleGPU> particules(_NbParticules);
+    lecture.readFromBuffer(particules.data(), particules.size() * sizeof(ParticuleGPU));
+    P.resize(_NbParticules);
+    V.resize(_NbParticules);
+    for (uint32_t i = 0; i < _NbParticules; i++) {
+        P[i] = particules[i].pos;
+        V[i] = particules[i].vit;
+    }
+}
+
+}  // namespace TTe
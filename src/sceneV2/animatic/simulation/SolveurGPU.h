@@ -0,0 +1,114 @@
+//
+//  SolveurGPU.h
+//
+//  Schema d'Euler semi-implicite du systeme masses-ressorts execute sur le GPU.
+//
+
+#ifndef Solveur_GPU_h
+#define Solveur_GPU_h
+
+/** Librairies de base **/
+#include <array>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <mutex>
+#include <vector>
+
+#include "GPU_data/buffer.hpp"
+#include "MSS.h"
+#include "commandBuffer/command_buffer.hpp"
+#include "device.hpp"
+#include "sceneV2/mesh.hpp"
+#include "shader/pipeline/compute_pipeline.hpp"
+#include "struct.hpp"
+#include "utils.hpp"
+
+namespace TTe {
+
+/*
+ * Meme schema que SolveurExpl et ObjetSimuleMSS::Collision mais les particules restent sur le GPU :
+ * le thread de mise a jour empile les parametres de chaque pas, le thread de rendu les execute
+ * dans un compute shader puis ecrit positions et normales directement dans le tampon de sommets du maillage.
+ * Le solveur CPU reste la reference, l auto-collision n est pas geree ici.
+ */
+class SolveurGPU {
+   public:
+    /// Sommet attache a un noeud de la scene (meme disposition que dans cloth_step.comp)
+    struct AttacheGPU {
+        glm::vec3 pos;
+        uint32_t sommet;
+    };
+
+    /// Parametres d un pas de temps, dans le repere de l objet
+    struct Pas {
+        glm::vec3 gravite;
+        float viscosite;
+        glm::vec3 vent;
+        float dt;
+        std::vector<AttacheGPU> attaches;
+        std::vector<ColliderGPU> colliders;
+    };
+
+    /*! Constructeur */
+    SolveurGPU() {}
+
+    SolveurGPU(const SolveurGPU &) = delete;
+    SolveurGPU &operator=(const SolveurGPU &) = delete;
+
+    /*! Creation des tampons a partir de l etat initial du systeme masses-ressorts */
+    void Initialisation(
+        Device *device, MSS *mss, const std::vector<glm::vec3> &P, const std::vector<uint32_t> &indices, const std::vector<glm::vec3> &V);
+
+    /*! Ajout d un pas a simuler, appele par le thread de mise a jour */
+    void AjoutPas(Pas &&pas);
+
+    /*! Enregistrement des pas en attente puis mise a jour des sommets du maillage, appele par le thread de rendu */
+    void Enregistre(CommandBuffer &cmd, uint32_t frame_index, Mesh &mesh);
+
+    /*! Copie des positions et vitesses des particules, attend la fin de la copie sur le GPU */
+    void LitParticules(std::vector<glm::vec3> &P, std::vector<glm::vec3> &V);
+
+    /// Pas de temps
+    float _delta_t;
+
+    /// Nombre maximal de pas executes par image, des pas consecutifs sont fusionnes si le GPU prend du retard
+    static constexpr uint32_t s_max_pas_par_image = 8;
+
+    /// Duree maximale d un sous-pas (meme borne que solveExplicit), un pas plus long est decoupe
+    static constexpr float s_dt_max = 0.001f;
+
+   private:
+    Device *_Device = nullptr;
+    uint32_t _NbParticules = 0;
+
+    /// Particules (position, inverse de la masse, vitesse), lues dans l un et ecrites dans l autre a chaque pas
+    std::array<Buffer, 2> _Particules;
+    uint32_t _Courant = 0;
+
+    /// Ressorts vus de chacune de leurs particules, ranges par particule
+    Buffer _Ressorts;
+    Buffer _DebutRessorts;
+
+    /// Triangles du maillage et triangles autour de chaque sommet, pour les normales
+    Buffer _Indices;
+    Buffer _DebutTrianglesSommet;
+    Buffer _TrianglesSommet;
+
+    /// Colliders et attaches de tous les pas d une image, un tampon par image en vol
+    std::array<Buffer, MAX_FRAMES_IN_FLIGHT> _Colliders;
+    std::array<Buffer, MAX_FRAMES_IN_FLIGHT> _Attaches;
+    std::vector<ColliderGPU> _CollidersImage;
+    std::vector<AttacheGPU> _AttachesImage;
+
+    ComputePipeline _PipelinePas;
+    ComputePipeline _PipelineNormales;
+
+    /// Pas produits par le thread de mise a jour, pas encore enregistres
+    std::mutex _MutexPas;
+    std::vector<Pas> _PasEnAttente;
+    std::vector<Pas> _PasAEnregistrer;
+};
+
+}  // namespace TTe
+
+#endif
@@ -95,11 +95,8 @@ void SolveurImpl::Init(int nb_som, MSS *_SystemeMasseRessort) {
         Df_Dx_diag[i] = init_element;
         Df_Dv_diag[i] = init_element;
 
-        /// RessortList relies a la particule NumPart_i
-        std::vector<Ressort *> &RessortList_i = _SystemeMasseRessort->GetParticule(i)->GetRessortList();
-
         /// Nombre de ressorts relies a la particule NumPart_i
-        int NbRessortList_i = RessortList_i.size();
+        int NbRessortList_i = _SystemeMasseRessort->GetNbVoisins(i);
 
         // Pour initialiser les elements non diagonaux
         std::vector<std::vector<float>> init(NbRessortList_i);
@@ -122,7 +119,7 @@ void SolveurImpl::Init(int nb_som, MSS *_SystemeMasseRessort) {
  * Remplissage matrices df/dx et df/dv dans le cas d un MSS
  * Utilisation formulation Volino ou Baraff.
  */
-void SolveurImpl::Remplissage_df_dx_dv(int nb_som, MSS *_SystemeMasseRessort, std::vector<Vertex> &P) {}
+void SolveurImpl::Remplissage_df_dx_dv(int nb_som, MSS *_SystemeMasseRessort, std::vector<glm::vec3> &P) {}
 
 /*
  * Re-initialisation des structures de donnees : Df_Dx_diag, Df_Dv_diag, Y, Force.
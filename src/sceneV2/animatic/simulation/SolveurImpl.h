@@ -49,7 +49,7 @@ public:
                std::vector<glm::vec3> &Force,
                std::vector<glm::vec3> &A,
                std::vector<glm::vec3> &V,
-               std::vector<Vertex> &P,
+               std::vector<glm::vec3> &P,
                std::vector<float> &M,
                glm::vec3 gravite,
                MSS * _SystemeMasseRessort);
@@ -66,7 +66,7 @@ public:
     /*! Calcul des positions */
     void CalculPosition(int nb_som,
                         std::vector<glm::vec3> &V,
-                        std::vector<Vertex> &P);
+                        std::vector<glm::vec3> &P);
     
     
     /* Allocation des structures de donnees -
@@ -81,7 +81,7 @@ public:
      Utilisation formulation Volino ou Baraff */
     void Remplissage_df_dx_dv(int nb_som,
                               MSS * _SystemeMasseRessort,
-                              std::vector<Vertex> &P);
+                              std::vector<glm::vec3> &P);
     
     /* Re-initialisation : Df_Dx_diag, Df_Dv_diag, Y */
     void Initialisation(int nb_som, std::vector<glm::vec3> &Force);
@@ -0,0 +1,161 @@
+/** \file SolveurXPBD.cpp
+ \brief Dynamique basee positions etendue (XPBD) pour les systemes masses-ressorts.
+ */
+
+#include "SolveurXPBD.h"
+
+#include <algorithm>
+#include <cmath>
+#include <span>
+#include <unordered_map>
+
+namespace TTe {
+
+/**
+ * Contraintes d etirement (une par ressort) et de courbure (une par arete interieure).
+ */
+void SolveurXPBD::Initialisation(MSS *mss, const std::vector<glm::vec3> &P, const std::vector<uint32_t> &indices) {
+    uint32_t nb_sommets = P.size();
+
+    _InvMasseInitiale = mss->_InvMasses;
+    _InvMasse = _InvMasseInitiale;
+    _PosPrec.resize(nb_sommets);
+
+    /* Etirement : les ressorts du MSS, la raideur donne la compliance par defaut.
+       Meme longueur au repos que CalculForceSpring et cloth_step.comp (Lrepos * 0.75) : le tissu garde sa forme d un solveur a l autre */
+    _Etirement.clear();
+    for (uint32_t r = 0; r < mss->GetNbRessort(); r++) {
+        float raideur = mss->_RessortRaideur[r];
+        float compliance = _ComplianceEtirement;
+        if (compliance < 0.f) compliance = raideur > 0.f ? 1.f / raideur : 0.f;
+        _Etirement.push_back({mss->_RessortParticules[r].x, mss->_RessortParticules[r].y, mss->_RessortLrepos[r] * 0.75f, compliance});
+    }
+
+    /* Courbure : distance entre les sommets opposes des deux triangles de chaque arete */
+    _Courbure.clear();
+    std::unordered_map<uint64_t, uint32_t> sommet_oppose;
+    for (uint32_t t = 0; t + 2 < indices.size(); t += 3) {
+        for (uint32_t k = 0; k < 3; k++) {
+            uint32_t a = indices[t + k];
+            uint32_t b = indices[t + (k + 1) % 3];
+            uint32_t oppose = indices[t + (k + 2) % 3];
+            uint64_t cle = (uint64_t(std::min(a, b)) << 32) | std::max(a, b);
+
+            auto it = sommet_oppose.find(cle);
+            if (it == sommet_oppose.end()) {
+                sommet_oppose[cle] = oppose;
+            } else if (it->second != oppose) {
+                _Courbure.push_back({it->second, oppose, glm::length(P[it->second] - P[oppose]), _ComplianceCourbure});
+            }
+        }
+    }
+
+    _LambdaEtirement.resize(_Etirement.size());
+    _LambdaCourbure.resize(_Courbure.size());
+}
+
+/**
+ * Projection de la contrainte C = |xa - xb| - l0.
+ */
+void SolveurXPBD::ProjeteDistance(const Distance &c, float alpha, std::vector<glm::vec3> &P, float &lambda) {
+    float wa = _InvMasse[c.a];
+    float wb = _InvMasse[c.b];
+    float w = wa + wb + alpha;
+    if (w == 0.f) return;
+
+    glm::vec3 direction = P[c.a] - P[c.b];
+    float longueur = glm::length(direction);
+    if (longueur == 0.f) return;
+    glm::vec3 n = direction / longueur;
+
+    float C = longueur - c.lrepos;
+    float dlambda = (-C - alpha * lambda) / w;
+    lambda += dlambda;
+    P[c.a] += wa * dlambda * n;
+    P[c.b] -= wb * dlambda * n;
+}
+
+/**
+ * Collisions : chaque collider donne le point projete hors de l objet,
+ * le sommet s en rapproche selon la compliance des collisions.
+ */
+void SolveurXPBD::ProjeteCollisions(std::vector<glm::vec3> &P, std::vector<std::shared_ptr<ICollider>> &colliders, float h) {
+    float alpha = _ComplianceCollision / (h * h);
+
+    for (auto &collider : colliders) {
+        BoundingBox collider_bounds = collider->getColliderBounds();
+
+        _CollisionIds.clear();
+        _CollisionPos.clear();
+        _CollisionVit.clear();
+        for (uint32_t i = 0; i < P.size(); i++) {
+            if (_InvMasse[i] == 0.f || !collider_bounds.contains(P[i])) continue;
+            _CollisionIds.push_back(i);
+            _CollisionPos.push_back(P[i]);
+            _CollisionVit.push_back(glm::vec3(0.f));
+        }
+        if (_CollisionIds.empty()) continue;
+
+        collider->collide(std::span<glm::vec3>(_CollisionPos), std::span<glm::vec3>(_CollisionVit));
+
+        /// Les vitesses sont deduites des positions a la fin du sous-pas, seule la position projetee est utilisee
+        for (uint32_t k = 0; k < _CollisionIds.size(); k++) {
+            uint32_t i = _CollisionIds[k];
+            float w = _InvMasse[i];
+            P[i] += (_CollisionPos[k] - P[i]) * (w / (w + alpha));
+        }
+    }
+}
+
+/**
+ * Pas de temps decoupe en sous-pas : prediction, projection des contraintes, mise a jour des vitesses.
+ */
+void SolveurXPBD::Solve(
+    const Pas &pas, std::vector<glm::vec3> &P, std::vector<glm::vec3> &V, const std::map<uint32_t, std::shared_ptr<Node>> &attaches,
+    std::vector<std::shared_ptr<ICollider>> &colliders) {
+    int nb_sous_pas = std::max(_NbSousPas, 1);
+    float h = pas.dt / nb_sous_pas;
+    if (h <= 0.f) return;
+
+    /// Amortissement reparti sur les sous-pas pour garder la meme viscosite par pas
+    float amortissement = std::pow(pas.viscosite, 1.f / nb_sous_pas);
+
+    /// Sommets attaches : deplaces par leur noeud, les contraintes ne les bougent pas
+    _InvMasse = _InvMasseInitiale;
+    for (auto &attache : attaches) {
+        _InvMasse[attache.first] = 0.f;
+    }
+
+    for (int s = 0; s < nb_sous_pas; s++) {
+        /* Prediction des positions */
+        for (uint32_t i = 0; i < P.size(); i++) {
+            _PosPrec[i] = P[i];
+            if (_InvMasse[i] == 0.f) continue;
+            V[i] += h * (pas.gravite + _InvMasse[i] * pas.vent);
+            P[i] += h * V[i];
+        }
+        for (auto &attache : attaches) {
+            P[attache.first] = attache.second->wMatrix()[3];
+        }
+
+        /* Projection des contraintes (Gauss-Seidel) */
+        std::fill(_LambdaEtirement.begin(), _LambdaEtirement.end(), 0.f);
+        std::fill(_LambdaCourbure.begin(), _LambdaCourbure.end(), 0.f);
+        for (int iter = 0; iter < _NbIterations; iter++) {
+            for (uint32_t c = 0; c < _Etirement.size(); c++) {
+                ProjeteDistance(_Etirement[c], _Etirement[c].compliance / (h * h), P, _LambdaEtirement[c]);
+            }
+            for (uint32_t c = 0; c < _Courbure.size(); c++) {
+                ProjeteDistance(_Courbure[c], _Courbure[c].compliance / (h * h), P, _LambdaCourbure[c]);
+            }
+        }
+        ProjeteCollisions(P, colliders, h);
+
+        /* Vitesses deduites du deplacement */
+        for (uint32_t i = 0; i < P.size(); i++) {
+            V[i] = (P[i] - _PosPrec[i]) / h * amortissement;
+        }
+    }
+}
+
+}  // namespace TTe
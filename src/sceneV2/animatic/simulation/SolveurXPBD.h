@@ -0,0 +1,102 @@
+//
+//  SolveurXPBD.h
+//
+//  Dynamique basee positions etendue (XPBD) avec sous-pas de temps.
+//
+
+#ifndef Solveur_XPBD_h
+#define Solveur_XPBD_h
+
+/** Librairies de base **/
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "MSS.h"
+#include "sceneV2/Icollider.hpp"
+#include "sceneV2/node.hpp"
+#include "struct.hpp"
+
+namespace TTe {
+
+/*
+ * Schema XPBD (Macklin et al. 2016, sous-pas de Macklin et al. 2019) :
+ * a chaque sous-pas les positions sont predites puis projetees sur les contraintes d etirement
+ * (les ressorts du MSS), de courbure (sommets opposes de deux triangles voisins) et de collision.
+ * Chaque contrainte a une compliance (inverse d une raideur), 0 = contrainte rigide.
+ * Stable avec le pas de temps de la scene, le cout est regle par le nombre de sous-pas et d iterations.
+ */
+class SolveurXPBD {
+   public:
+    /// Parametres d un pas de temps, dans le repere de l objet
+    struct Pas {
+        glm::vec3 gravite;
+        glm::vec3 vent;
+        float viscosite;
+        float dt;
+    };
+
+    /*! Constructeur */
+    SolveurXPBD() {}
+
+    /*! Construction des contraintes a partir des ressorts et des triangles du maillage */
+    void Initialisation(MSS *mss, const std::vector<glm::vec3> &P, const std::vector<uint32_t> &indices);
+
+    /*! Calcul des positions et vitesses au pas suivant */
+    void Solve(
+        const Pas &pas, std::vector<glm::vec3> &P, std::vector<glm::vec3> &V, const std::map<uint32_t, std::shared_ptr<Node>> &attaches,
+        std::vector<std::shared_ptr<ICollider>> &colliders);
+
+    /// Nombre de sous-pas par pas de temps
+    int _NbSousPas = 10;
+
+    /// Nombre d iterations de projection par sous-pas
+    int _NbIterations = 1;
+
+    /// Compliance d etirement, negative : inverse de la raideur de chaque ressort
+    float _ComplianceEtirement = -1.f;
+
+    /// Compliance de courbure
+    float _ComplianceCourbure = 1e-4f;
+
+    /// Compliance des collisions
+    float _ComplianceCollision = 0.f;
+
+   private:
+    /// Contrainte de distance entre deux sommets
+    struct Distance {
+        uint32_t a;
+        uint32_t b;
+        float lrepos;
+        float compliance;
+    };
+
+    /*! Projection d une contrainte de distance, alpha = compliance / h^2 */
+    void ProjeteDistance(const Distance &c, float alpha, std::vector<glm::vec3> &P, float &lambda);
+
+    /*! Projection des sommets libres sur les colliders */
+    void ProjeteCollisions(std::vector<glm::vec3> &P, std::vector<std::shared_ptr<ICollider>> &colliders, float h);
+
+    std::vector<Distance> _Etirement;
+    std::vector<Distance> _Courbure;
+    std::vector<float> _LambdaEtirement;
+    std::vector<float> _LambdaCourbure;
+
+    /// Inverse des masses, nul pour un sommet fixe ou attache
+    std::vector<float> _InvMasse;
+    std::vector<float> _InvMasseInitiale;
+
+    /// Positions au debut du sous-pas
+    std::vector<glm::vec3> _PosPrec;
+
+    /// Sommets candidats a une collision, reutilises a chaque sous-pas
+    std::vector<uint32_t> _CollisionIds;
+    std::vector<glm::vec3> _CollisionPos;
+    std::vector<glm::vec3> _CollisionVit;
+};
+
+}  // namespace TTe
+
+#endif
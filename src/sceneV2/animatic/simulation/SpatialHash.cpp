@@ -0,0 +1,55 @@
+/** \file SpatialHash.cpp
+ \brief Construction parallele de la table de hachage spatiale.
+ */
+
+#include "SpatialHash.h"
+
+#include <algorithm>
+#include <bit>
+
+#include "jobs/job_system.hpp"
+
+namespace TTe {
+
+void SpatialHash::build(std::span<const glm::vec3> p_points, float p_cell_size) {
+    _CellSize = p_cell_size;
+    uint32_t nb_points = p_points.size();
+
+    /// Table au moins deux fois plus grande que le nombre de points pour limiter les collisions de hachage
+    _TableSize = std::bit_ceil(std::max(nb_points * 2, 64u));
+    if (_CountersSize < _TableSize) {
+        _Counters = std::make_unique<std::atomic<uint32_t>[]>(_TableSize);
+        _CountersSize = _TableSize;
+    }
+    _PointBucket.resize(nb_points);
+    _Entries.resize(nb_points);
+    _CellStart.resize(_TableSize + 1);
+
+    for (uint32_t b = 0; b < _TableSize; b++) {
+        _Counters[b].store(0, std::memory_order_relaxed);
+    }
+
+    /// Nombre de points par alveole
+    JobSystem::parallelFor(0, nb_points, 0, [&](uint32_t i) {
+        uint32_t bucket = hashCell(cellOf(p_points[i]));
+        _PointBucket[i] = bucket;
+        _Counters[bucket].fetch_add(1, std::memory_order_relaxed);
+    });
+
+    /// Somme prefixe : debut de chaque alveole, les compteurs deviennent des curseurs d ecriture
+    uint32_t offset = 0;
+    for (uint32_t b = 0; b < _TableSize; b++) {
+        _CellStart[b] = offset;
+        offset += _Counters[b].load(std::memory_order_relaxed);
+        _Counters[b].store(_CellStart[b], std::memory_order_relaxed);
+    }
+    _CellStart[_TableSize] = offset;
+
+    /// Rangement des points
+    JobSystem::parallelFor(0, nb_points, 0, [&](uint32_t i) {
+        uint32_t slot = _Counters[_PointBucket[i]].fetch_add(1, std::memory_order_relaxed);
+        _Entries[slot] = i;
+    });
+}
+
+}  // namespace TTe
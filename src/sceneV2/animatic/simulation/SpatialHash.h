@@ -0,0 +1,84 @@
+//
+//  SpatialHash.h
+//
+//  Table de hachage spatiale utilisee pour l auto-collision des tissus.
+//
+
+#ifndef Spatial_Hash_h
+#define Spatial_Hash_h
+
+/** Librairies de base **/
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "struct.hpp"
+
+namespace TTe {
+
+/*
+ * Grille uniforme infinie dont les cellules sont rangees dans une table de taille fixe.
+ * Chaque point est range dans la cellule qui le contient, la table est reconstruite
+ * en parallele (tri par denombrement) a chaque pas de temps.
+ */
+class SpatialHash {
+   public:
+    /*! Reconstruction de la table a partir des points, p_cell_size doit etre > 0 */
+    void build(std::span<const glm::vec3> p_points, float p_cell_size);
+
+    /*! Appel de p_func(id) pour chaque point range dans une cellule touchee par la boite,
+        un point peut etre donne plusieurs fois et des points hors de la boite peuvent etre donnes */
+    template <typename F>
+    void query(const BoundingBox &p_box, F &&p_func) const {
+        if (_Entries.empty()) return;
+
+        glm::ivec3 cmin = cellOf(p_box.pmin);
+        glm::ivec3 cmax = cellOf(p_box.pmax);
+        for (int x = cmin.x; x <= cmax.x; x++) {
+            for (int y = cmin.y; y <= cmax.y; y++) {
+                for (int z = cmin.z; z <= cmax.z; z++) {
+                    uint32_t bucket = hashCell(glm::ivec3(x, y, z));
+                    for (uint32_t k = _CellStart[bucket]; k < _CellStart[bucket + 1]; k++) {
+                        p_func(_Entries[k]);
+                    }
+                }
+            }
+        }
+    }
+
+    float getCellSize() const { return _CellSize; }
+
+   private:
+    glm::ivec3 cellOf(const glm::vec3 &p) const { return glm::ivec3(glm::floor(p / _CellSize)); }
+
+    uint32_t hashCell(const glm::ivec3 &c) const {
+        // Teschner et al. 2003
+        uint32_t h = (uint32_t(c.x) * 73856093u) ^ (uint32_t(c.y) * 19349663u) ^ (uint32_t(c.z) * 83492791u);
+        return h & (_TableSize - 1);
+    }
+
+    /// Taille d une cellule
+    float _CellSize = 1.f;
+
+    /// Nombre d alveoles de la table (puissance de 2)
+    uint32_t _TableSize = 0;
+
+    /// Debut des points de chaque alveole dans _Entries (taille _TableSize + 1)
+    std::vector<uint32_t> _CellStart;
+
+    /// Identifiants des points tries par alveole
+    std::vector<uint32_t> _Entries;
+
+    /// Alveole de chaque point et compteurs utilises pendant la construction
+    std::vector<uint32_t> _PointBucket;
+    std::unique_ptr<std::atomic<uint32_t>[]> _Counters;
+    uint32_t _CountersSize = 0;
+};
+
+}  // namespace TTe
+
+#endif
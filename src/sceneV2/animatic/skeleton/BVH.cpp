@@ -1,10 +1,145 @@
 #include "BVH.h"
 #include "BVHJoint.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
 #include <iostream>
+#include <stdexcept>
+#include <string_view>
+
+#include "jobs/job_system.hpp"
 
 using namespace std;
 namespace TTe {
 
+namespace {
+
+//! Read only memory mapping of a whole file
+class MappedFile
+{
+public:
+	explicit MappedFile(const std::string& filename) : m_filename(filename)
+	{
+		int fd = open(filename.c_str(), O_RDONLY);
+		if (fd < 0) throw std::runtime_error("Unable to open " + filename);
+
+		struct stat infos;
+		if (fstat(fd, &infos) != 0)
+		{
+			close(fd);
+			throw std::runtime_error("Unable to read " + filename);
+		}
+		m_size = infos.st_size;
+
+		if (m_size > 0)
+		{
+			void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (data == MAP_FAILED)
+			{
+				close(fd);
+				throw std::runtime_error("Unable to map " + filename);
+			}
+			madvise(data, m_size, MADV_SEQUENTIAL);
+			m_data = static_cast<const char*>(data);
+		}
+		close(fd);
+	}
+
+	~MappedFile() { if (m_data) munmap(const_cast<char*>(m_data), m_size); }
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	const char* begin() const { return m_data; }
+	const char* end() const { return m_data + m_size; }
+	const std::string& getFilename() const { return m_filename; }
+
+private:
+	std::string m_filename;
+	const char* m_data = nullptr;
+	size_t m_size = 0;
+};
+
+//! Channel names of the CHANNELS line
+struct ChannelName
+{
+	std::string_view name;
+	BVHChannel::TYPE type;
+	AXIS axis;
+};
+
+const ChannelName s_channelNames[] = {
+	{"Xposition", BVHChannel::TYPE_TRANSLATION, AXIS_X},
+	{"Yposition", BVHChannel::TYPE_TRANSLATION, AXIS_Y},
+	{"Zposition", BVHChannel::TYPE_TRANSLATION, AXIS_Z},
+	{"Xrotation", BVHChannel::TYPE_ROTATION, AXIS_X},
+	{"Yrotation", BVHChannel::TYPE_ROTATION, AXIS_Y},
+	{"Zrotation", BVHChannel::TYPE_ROTATION, AXIS_Z},
+	{"Wrotation", BVHChannel::TYPE_ROTATION, AXIS_W},
+};
+
+} // namespace
+
+
+/** @brief Whitespace separated words and numbers of a mapped file
+	@remarks Numbers are read in place with std::from_chars, errors give the file and the line.
+*/
+class BVHTokenizer
+{
+public:
+	explicit BVHTokenizer(const MappedFile& file) : m_file(file), m_pos(file.begin()), m_end(file.end()) {}
+
+	//! Return the next word, empty at the end of the file
+	std::string_view next()
+	{
+		skipSpaces();
+		const char* start = m_pos;
+		while (m_pos != m_end && !isSpace(*m_pos)) ++m_pos;
+		return std::string_view(start, m_pos - start);
+	}
+
+	//! Check that the next word is word
+	void expect(std::string_view word)
+	{
+		std::string_view str = next();
+		if (str != word)
+			error("'" + std::string(str) + "' found where '" + std::string(word) + "' was expected");
+	}
+
+	//! Return the next number
+	template <typename T>
+	T number()
+	{
+		skipSpaces();
+		if (m_pos != m_end && *m_pos == '+') ++m_pos;
+		T value;
+		auto [end, ec] = std::from_chars(m_pos, m_end, value);
+		if (ec != std::errc()) error("number expected");
+		m_pos = end;
+		return value;
+	}
+
+	[[noreturn]] void error(const std::string& message) const
+	{
+		size_t line = 1 + std::count(m_file.begin(), m_pos, '\n');
+		throw std::runtime_error(m_file.getFilename() + " line " + std::to_string(line) + " : " + message);
+	}
+
+private:
+	static bool isSpace(char c) { return c == ' ' || c == '\n' || c == '\r' || c == '\t'; }
+	void skipSpaces() { while (m_pos != m_end && isSpace(*m_pos)) ++m_pos; }
+
+	const MappedFile& m_file;
+	const char* m_pos;
+	const char* m_end;
+};
+
 
 //=============================================================================
 BVH::BVH()
@@ -24,6 +159,138 @@ const TTe::BVHJoint& BVH::getRoot(void) const
 
 //-----------------------------------------------------------------------------
 void BVH::init(const std::string& filename, bool enableEndSite)
+{
+	MappedFile file(filename);
+	BVHTokenizer tokens(file);
+
+	m_joints.clear();
+	tokens.expect("HIERARCHY");
+	tokens.expect("ROOT");
+	m_rootId = addJoint(std::string(tokens.next()), -1);
+	init(tokens, enableEndSite, m_rootId);
+
+	tokens.expect("MOTION");
+	tokens.expect("Frames:");
+	m_numFrames = tokens.number<int>();
+	if (m_numFrames < 0) tokens.error("negative number of frames");
+	tokens.expect("Frame");
+	tokens.expect("Time:");
+	m_frameTime = tokens.number<float>();
+
+	// the storage of every channel is allocated once from the declared number of frames,
+	// the values of a frame are then read in the order of the hierarchy
+	std::vector<BVHChannel*> channels;
+	for (BVHJoint& joint : m_joints)
+	{
+		for (int j = 0; j < joint.getNumberOfChannel(); ++j)
+		{
+			joint.getChannel(j).setDataSize(m_numFrames);
+			channels.push_back(&joint.getChannel(j));
+		}
+	}
+
+	for (int k = 0; k < m_numFrames; ++k)
+		for (BVHChannel* channel : channels)
+			channel->setData(k, tokens.number<float>());
+}
+
+
+void BVH::init(BVHTokenizer& tokens, bool enableEndSite, int id)
+{
+	tokens.expect("{");
+	tokens.expect("OFFSET");
+	float x = tokens.number<float>();
+	float y = tokens.number<float>();
+	float z = tokens.number<float>();
+	m_joints[id].setOffset(x, y, z);
+
+	tokens.expect("CHANNELS");
+	int numChannels = tokens.number<int>();
+	for (int i = 0; i < numChannels; ++i)
+	{
+		std::string_view typeStr = tokens.next();
+		auto channelName = std::find_if(std::begin(s_channelNames), std::end(s_channelNames),
+			[&](const ChannelName& c) { return c.name == typeStr; });
+		if (channelName == std::end(s_channelNames))
+			tokens.error("bad channel type '" + std::string(typeStr) + "'");
+		m_joints[id].addChannel(BVHChannel(channelName->type, channelName->axis));
+	}
+
+	for (std::string_view str = tokens.next(); str != "}"; str = tokens.next())
+	{
+		if (str == "JOINT")
+		{
+			int childId = addJoint(std::string(tokens.next()), id);
+			init(tokens, enableEndSite, childId);
+		}
+		else if (str == "End")
+		{
+			tokens.expect("Site");
+			tokens.expect("{");
+			tokens.expect("OFFSET");
+			x = tokens.number<float>();
+			y = tokens.number<float>();
+			z = tokens.number<float>();
+			if (enableEndSite)
+			{
+				int childId = addJoint(getEndSiteName(m_joints[id].getName()), id);
+				m_joints[childId].setOffset(x, y, z);
+			}
+			tokens.expect("}");
+		}
+		else if (str.empty())
+		{
+			tokens.error("unexpected end of file in joint '" + m_joints[id].getName() + "'");
+		}
+		else
+		{
+			tokens.error("unexpected word '" + std::string(str) + "'");
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+std::vector<BVH> BVH::loadAll(const std::vector<std::string>& filenames, bool enableEndSite)
+{
+	std::vector<BVH> bvhs(filenames.size());
+	JobSystem::parallelFor(0, filenames.size(), 1, [&](uint32_t i) { bvhs[i].init(filenames[i], enableEndSite); });
+	return bvhs;
+}
+
+
+void BVH::benchmarkParsers(const std::vector<std::string>& filenames, bool enableEndSite)
+{
+	auto measure = [](auto&& load) {
+		auto start = std::chrono::high_resolution_clock::now();
+		load();
+		std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+		return elapsed.count();
+	};
+
+	double streamTime = measure([&] {
+		for (const std::string& filename : filenames)
+		{
+			BVH bvh;
+			bvh.initStream(filename, enableEndSite);
+		}
+	});
+	double mappedTime = measure([&] {
+		for (const std::string& filename : filenames)
+		{
+			BVH bvh;
+			bvh.init(filename, enableEndSite);
+		}
+	});
+	double parallelTime = measure([&] { loadAll(filenames, enableEndSite); });
+
+	std::cout << "BVH loading of " << filenames.size() << " files : stream " << streamTime << " s, mapped " << mappedTime
+			  << " s, mapped parallel " << parallelTime << " s" << std::endl;
+}
+
+
+//-----------------------------------------------------------------------------
+void BVH::initStream(const std::string& filename, bool enableEndSite)
 {
     std::ifstream stream(filename.c_str());
 
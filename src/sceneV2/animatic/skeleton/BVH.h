@@ -19,6 +19,7 @@
 namespace TTe {
 
 	class BVHJoint;
+	class BVHTokenizer;
 
 
 	/** @brief Motion capture skeleton and animation
@@ -50,8 +51,15 @@ namespace TTe {
 			return *this;
 		}
 
-		//! init
+		//! init: the file is memory mapped and parsed in place
 		void init(const std::string& filename, bool enableEndSite=true);
+		//! init with the std::ifstream parser, kept as a reference for benchmarkParsers
+		void initStream(const std::string& filename, bool enableEndSite=true);
+
+		//! Load several files in parallel on the job system
+		static std::vector<BVH> loadAll(const std::vector<std::string>& filenames, bool enableEndSite=true);
+		//! Print the time taken to load the files by the stream parser, the mapped parser and the parallel loading
+		static void benchmarkParsers(const std::vector<std::string>& filenames, bool enableEndSite=true);
 
 		//! Return the number of frames
 		int getNumberOfFrame(void) const	{ return m_numFrames;  }
@@ -108,6 +116,8 @@ namespace TTe {
 
 		//! internal init: recursive on the children
 		void init(std::ifstream& stream, bool enableEndSite, int id);
+		//! internal init of the mapped parser: recursive on the children
+		void init(BVHTokenizer& tokens, bool enableEndSite, int id);
         //! Return the best end name from it parent e.g. RHand from RWrist
 		static std::string getEndSiteName(const std::string& parentName);
 
@@ -0,0 +1,84 @@
+#include "animation_clip.hpp"
+
+#include <algorithm>
+
+#include "math/quaternion_convertor.hpp"
+
+namespace TTe {
+
+AnimationClip::AnimationClip(const BVH &p_bvh)
+    : m_nb_joint(p_bvh.getNumberOfJoint()), m_nb_frame(std::max(p_bvh.getNumberOfFrame(), 0)), m_frame_time(p_bvh.getFrameTime()) {
+    m_parents.resize(m_nb_joint);
+    m_offsets.resize(m_nb_joint);
+    m_translations.resize(size_t(m_nb_frame) * m_nb_joint);
+    m_rotations.resize(size_t(m_nb_frame) * m_nb_joint);
+
+    for (uint32_t j = 0; j < m_nb_joint; j++) {
+        const BVHJoint &joint = p_bvh.getJoint(j);
+        m_parents[j] = joint.getParentId();
+        joint.getOffset(m_offsets[j].x, m_offsets[j].y, m_offsets[j].z);
+
+        for (uint32_t f = 0; f < m_nb_frame; f++) {
+            glm::vec3 translation(0.f);
+            glm::vec3 rotation(0.f);
+            for (int c = 0; c < joint.getNumberOfChannel(); c++) {
+                const BVHChannel &channel = joint.getChannel(c);
+                if (int(f) >= channel.getNumData() || channel.getAxis() == AXIS_W) continue;
+                float data = channel.getData(f);
+                if (channel.getType() == BVHChannel::TYPE_TRANSLATION) {
+                    translation[channel.getAxis()] = data;
+                } else {
+                    rotation[channel.getAxis()] = glm::radians(data);
+                }
+            }
+
+            glm::quat q = eulerZXYtoQuat(rotation);
+            if (f > 0 && glm::dot(q, m_rotations[size_t(f - 1) * m_nb_joint + j]) < 0.f) q = -q;
+
+            m_translations[size_t(f) * m_nb_joint + j] = m_offsets[j] + translation;
+            m_rotations[size_t(f) * m_nb_joint + j] = q;
+        }
+    }
+}
+
+void AnimationClip::sample(float p_time, AnimationPose &p_pose) const {
+    if (empty()) return;
+    p_pose.resize(m_nb_joint);
+
+    float frame = std::max(p_time, 0.f) / m_frame_time;
+    uint32_t frame_1 = uint32_t(frame);
+    float t = frame - float(frame_1);
+
+    const glm::vec3 *translations_1 = getTranslations(frame_1);
+    const glm::vec3 *translations_2 = getTranslations(frame_1 + 1);
+    const glm::quat *rotations_1 = getRotations(frame_1);
+    const glm::quat *rotations_2 = getRotations(frame_1 + 1);
+
+    // neighbour frames are close and in the same hemisphere : a normalized lerp is enough.
+    // The loop back from the last to the first frame may cross hemispheres
+    bool loop = (frame_1 + 1) % m_nb_frame == 0;
+    for (uint32_t j = 0; j < m_nb_joint; j++) {
+        p_pose.translations[j] = glm::mix(translations_1[j], translations_2[j], t);
+        glm::quat q2 = (loop && glm::dot(rotations_1[j], rotations_2[j]) < 0.f) ? -rotations_2[j] : rotations_2[j];
+        p_pose.rotations[j] = glm::normalize(rotations_1[j] * (1.f - t) + q2 * t);
+    }
+}
+
+void AnimationClip::blend(
+    const AnimationClip &p_a, uint32_t p_frame_a, const AnimationClip &p_b, uint32_t p_frame_b, float p_t, AnimationPose &p_pose) {
+    if (p_a.empty() || p_b.empty()) return;
+    uint32_t nb_joint = std::min(p_a.m_nb_joint, p_b.m_nb_joint);
+    p_pose.resize(nb_joint);
+
+    const glm::vec3 *translations_a = p_a.getTranslations(p_frame_a);
+    const glm::vec3 *translations_b = p_b.getTranslations(p_frame_b);
+    const glm::quat *rotations_a = p_a.getRotations(p_frame_a);
+    const glm::quat *rotations_b = p_b.getRotations(p_frame_b);
+
+    for (uint32_t j = 0; j < nb_joint; j++) {
+        p_pose.translations[j] = glm::mix(translations_a[j], translations_b[j], p_t);
+        p_pose.rotations[j] = glm::slerp(rotations_a[j], rotations_b[j], p_t);
+    }
+}
+
+}  // namespace TTe
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <vector>
+
+#include "sceneV2/animatic/skeleton/BVH.h"
+
+namespace TTe {
+
+// local transform of every joint of a skeleton, written by the clip samplers
+struct AnimationPose {
+    std::vector<glm::vec3> translations;
+    std::vector<glm::quat> rotations;
+
+    // only allocates the first time, the samplers can then be called every tick
+    void resize(uint32_t p_nb_joint) {
+        translations.resize(p_nb_joint);
+        rotations.resize(p_nb_joint);
+    }
+    uint32_t size() const { return translations.size(); }
+};
+
+// BVH animation compiled into flat tracks : joint j of frame f is at f * nb_joint + j.
+// Translations already include the joint offset and rotations are quaternions, so a sample is one pass over contiguous
+// arrays, without Euler conversion, channel lookup or allocation
+class AnimationClip {
+   public:
+    AnimationClip() = default;
+    explicit AnimationClip(const BVH &p_bvh);
+
+    uint32_t getNumberOfJoint() const { return m_nb_joint; }
+    uint32_t getNumberOfFrame() const { return m_nb_frame; }
+    float getFrameTime() const { return m_frame_time; }
+    float getDuration() const { return m_nb_frame * m_frame_time; }
+    bool empty() const { return m_nb_frame == 0 || m_nb_joint == 0; }
+
+    const std::vector<int> &getParents() const { return m_parents; }
+    const std::vector<glm::vec3> &getOffsets() const { return m_offsets; }
+
+    // tracks of all the joints for one frame, p_frame loops on the clip
+    const glm::vec3 *getTranslations(uint32_t p_frame) const { return m_translations.data() + frameStart(p_frame); }
+    const glm::quat *getRotations(uint32_t p_frame) const { return m_rotations.data() + frameStart(p_frame); }
+
+    // pose at p_time seconds, looping, interpolated between the two closest frames
+    void sample(float p_time, AnimationPose &p_pose) const;
+
+    // pose between frame p_frame_a of p_a and frame p_frame_b of p_b (same skeleton), p_t = 0 gives p_a
+    static void blend(
+        const AnimationClip &p_a, uint32_t p_frame_a, const AnimationClip &p_b, uint32_t p_frame_b, float p_t, AnimationPose &p_pose);
+
+   private:
+    size_t frameStart(uint32_t p_frame) const { return size_t(p_frame % m_nb_frame) * m_nb_joint; }
+
+    uint32_t m_nb_joint = 0;
+    uint32_t m_nb_frame = 0;
+    float m_frame_time = 0.f;
+
+    std::vector<int> m_parents;
+    std::vector<glm::vec3> m_offsets;
+
+    std::vector<glm::vec3> m_translations;
+    // consecutive frames of a joint are kept in the same hemisphere, neighbours can be interpolated without sign check
+    std::vector<glm::quat> m_rotations;
+};
+
+}  // namespace TTe
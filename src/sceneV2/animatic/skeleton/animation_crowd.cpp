@@ -0,0 +1,133 @@
+#include "animation_crowd.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+#include "jobs/job_system.hpp"
+
+namespace TTe {
+
+AnimationCrowd::AnimationCrowd(std::shared_ptr<const AnimationLibrary> p_library)
+    : m_library(std::move(p_library)), m_nb_joint(m_library->getNumberOfJoint()) {}
+
+uint32_t AnimationCrowd::addCharacter(uint32_t p_clip, const glm::mat4 &p_root, float p_time, float p_speed) {
+    Character character;
+    character.clip = std::min(p_clip, m_library->size() - 1);
+    character.time = p_time;
+    character.speed = p_speed;
+    character.root = p_root;
+    m_characters.push_back(character);
+
+    size_t nb_matrices = m_characters.size() * size_t(m_nb_joint);
+    m_model_matrices.resize(nb_matrices);
+    m_key_start_matrices.resize(nb_matrices);
+    m_key_end_matrices.resize(nb_matrices);
+    return m_characters.size() - 1;
+}
+
+void AnimationCrowd::setClip(uint32_t p_character, uint32_t p_clip, float p_time) {
+    Character &character = m_characters[p_character];
+    character.clip = std::min(p_clip, m_library->size() - 1);
+    character.time = p_time;
+    character.has_keys = false;
+}
+
+void AnimationCrowd::update(float p_dt, const glm::vec3 &p_viewer) {
+    if (!m_library) return;
+    const FlatSkeleton &skeleton = m_library->getSkeleton();
+
+    JobSystem::parallelForRange(0, m_characters.size(), 32, [&](uint32_t p_begin, uint32_t p_end) {
+        AnimationPose pose;
+        for (uint32_t c = p_begin; c < p_end; c++) {
+            Character &character = m_characters[c];
+            const AnimationClip &clip = m_library->getClip(character.clip);
+            character.time += p_dt * character.speed;
+            glm::mat4 *model_matrices = m_model_matrices.data() + size_t(c) * m_nb_joint;
+
+            float distance = glm::length(glm::vec3(character.root[3]) - p_viewer);
+            character.lod = distance < m_full_distance ? Lod::FULL : (distance < m_reduced_distance ? Lod::REDUCED : Lod::CACHED);
+            if (character.lod != Lod::REDUCED) character.has_keys = false;
+
+            if (character.lod == Lod::FULL) {
+                clip.sample(character.time, pose);
+                skeleton.computeWorldTransforms(pose, glm::mat4(1.f), model_matrices);
+
+            } else if (character.lod == Lod::REDUCED) {
+                glm::mat4 *key_start = m_key_start_matrices.data() + size_t(c) * m_nb_joint;
+                glm::mat4 *key_end = m_key_end_matrices.data() + size_t(c) * m_nb_joint;
+                float period = s_reduced_period * p_dt * character.speed;
+                if (!character.has_keys) {
+                    // first period shortened differently for each character, their evaluations are spread over the updates
+                    character.key_start = character.time;
+                    character.key_end = character.time + period * float(1 + c % s_reduced_period) / s_reduced_period;
+                    clip.sample(character.key_start, pose);
+                    skeleton.computeWorldTransforms(pose, glm::mat4(1.f), key_start);
+                    clip.sample(character.key_end, pose);
+                    skeleton.computeWorldTransforms(pose, glm::mat4(1.f), key_end);
+                    character.has_keys = true;
+                } else if (character.time >= character.key_end) {
+                    std::copy(key_end, key_end + m_nb_joint, key_start);
+                    character.key_start = character.key_end;
+                    character.key_end = std::max(character.key_start, character.time) + period;
+                    clip.sample(character.key_end, pose);
+                    skeleton.computeWorldTransforms(pose, glm::mat4(1.f), key_end);
+                }
+
+                // linear blend of the matrices, the poses are close and the character far away
+                float t = 1.f;
+                if (character.key_end > character.key_start) {
+                    t = glm::clamp((character.time - character.key_start) / (character.key_end - character.key_start), 0.f, 1.f);
+                }
+                for (uint32_t j = 0; j < m_nb_joint; j++) {
+                    model_matrices[j] = key_start[j] + (key_end[j] - key_start[j]) * t;
+                }
+
+            } else {
+                character.baked_frame = uint32_t(std::max(character.time, 0.f) / clip.getFrameTime() + 0.5f);
+            }
+        }
+    });
+}
+
+void AnimationCrowd::benchmark(std::shared_ptr<const AnimationLibrary> p_library, uint32_t p_nb_character, uint32_t p_nb_update) {
+    // characters on a grid centered on the viewer, every clip of the library is played
+    AnimationCrowd crowd(p_library);
+    uint32_t side = std::max<uint32_t>(std::ceil(std::sqrt(float(p_nb_character))), 1);
+    const float spacing = 2.f;
+    for (uint32_t i = 0; i < p_nb_character; i++) {
+        glm::mat4 root(1.f);
+        root[3] = glm::vec4((float(i % side) - side * 0.5f) * spacing, 0.f, (float(i / side) - side * 0.5f) * spacing, 1.f);
+        crowd.addCharacter(i % p_library->size(), root, i * 0.1f);
+    }
+
+    const float dt = 1.f / 60.f;
+    auto measure = [&](float p_full, float p_reduced) {
+        crowd.setLodDistances(p_full, p_reduced);
+        crowd.update(dt, glm::vec3(0.f));
+        auto start = std::chrono::high_resolution_clock::now();
+        for (uint32_t u = 0; u < p_nb_update; u++) crowd.update(dt, glm::vec3(0.f));
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+        return elapsed.count() / std::max<uint32_t>(p_nb_update, 1);
+    };
+
+    const float infinite = std::numeric_limits<float>::max();
+    double full_time = measure(infinite, infinite);
+    double reduced_time = measure(0.f, infinite);
+    double cached_time = measure(0.f, 0.f);
+    // distances of the default levels of detail, scaled to the grid
+    float full_distance = side * spacing * 0.15f;
+    float reduced_distance = side * spacing * 0.35f;
+    double mixed_time = measure(full_distance, reduced_distance);
+
+    uint32_t nb_lod[3] = {0, 0, 0};
+    for (uint32_t i = 0; i < crowd.size(); i++) nb_lod[uint32_t(crowd.getLod(i))]++;
+
+    std::cout << "Crowd of " << p_nb_character << " characters (" << crowd.getNumberOfJoint() << " joints, " << JobSystem::getWorkerCount()
+              << " workers), ms per update : full " << full_time << ", reduced " << reduced_time << ", cached " << cached_time << ", mixed "
+              << mixed_time << " (" << nb_lod[0] << " full, " << nb_lod[1] << " reduced, " << nb_lod[2] << " cached)" << std::endl;
+}
+
+}  // namespace TTe
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+
+#include "sceneV2/animatic/skeleton/animation_library.hpp"
+
+namespace TTe {
+
+// many characters playing the clips of one shared AnimationLibrary, updated in parallel on the job system.
+// Each character gets a level of detail from its distance to the viewer :
+//  - FULL : the clip is sampled and the joints evaluated every update
+//  - REDUCED : evaluated every s_reduced_period updates, ahead of time, the updates in between interpolate the joint matrices
+//  - CACHED : closest baked frame of the library, nothing is evaluated
+class AnimationCrowd {
+   public:
+    enum class Lod : uint8_t { FULL, REDUCED, CACHED };
+
+    AnimationCrowd() = default;
+    explicit AnimationCrowd(std::shared_ptr<const AnimationLibrary> p_library);
+
+    // new character playing clip p_clip from p_time seconds, p_speed scales its time, returns its index
+    uint32_t addCharacter(uint32_t p_clip, const glm::mat4 &p_root, float p_time = 0.f, float p_speed = 1.f);
+    void setRoot(uint32_t p_character, const glm::mat4 &p_root) { m_characters[p_character].root = p_root; }
+    void setClip(uint32_t p_character, uint32_t p_clip, float p_time = 0.f);
+    uint32_t size() const { return m_characters.size(); }
+    uint32_t getNumberOfJoint() const { return m_nb_joint; }
+
+    // characters closer to the viewer than p_full are FULL, closer than p_reduced REDUCED and CACHED beyond
+    void setLodDistances(float p_full, float p_reduced) {
+        m_full_distance = p_full;
+        m_reduced_distance = p_reduced;
+    }
+
+    // advance every character by p_dt seconds and update its joint matrices
+    void update(float p_dt, const glm::vec3 &p_viewer);
+
+    Lod getLod(uint32_t p_character) const { return m_characters[p_character].lod; }
+    const glm::mat4 &getRoot(uint32_t p_character) const { return m_characters[p_character].root; }
+    // getNumberOfJoint() matrices of the joints of a character relative to its root, valid until the next update.
+    // The root is left to the consumer (joint palette, instance matrix on the GPU...) : a CACHED character costs no write
+    const glm::mat4 *getModelMatrices(uint32_t p_character) const {
+        const Character &character = m_characters[p_character];
+        if (character.lod == Lod::CACHED) return m_library->getBakedPose(character.clip, character.baked_frame);
+        return m_model_matrices.data() + size_t(p_character) * m_nb_joint;
+    }
+    glm::mat4 getWorldMatrix(uint32_t p_character, uint32_t p_joint) const {
+        return m_characters[p_character].root * getModelMatrices(p_character)[p_joint];
+    }
+
+    // headless measure of update() for p_nb_character characters on a grid around the viewer, printed on std::cout
+    static void benchmark(std::shared_ptr<const AnimationLibrary> p_library, uint32_t p_nb_character, uint32_t p_nb_update);
+
+    static constexpr uint32_t s_reduced_period = 4;
+
+   private:
+    struct Character {
+        uint32_t clip = 0;
+        float time = 0.f;
+        float speed = 1.f;
+        glm::mat4 root{1.f};
+        // a new character shows a baked pose until its first update
+        Lod lod = Lod::CACHED;
+        uint32_t baked_frame = 0;
+        // REDUCED : times of the two evaluated poses
+        bool has_keys = false;
+        float key_start = 0.f;
+        float key_end = 0.f;
+    };
+
+    std::shared_ptr<const AnimationLibrary> m_library;
+    uint32_t m_nb_joint = 0;
+    std::vector<Character> m_characters;
+
+    // [character * nb_joint + joint]
+    std::vector<glm::mat4> m_model_matrices;
+    // REDUCED : model space matrices at key_start and key_end
+    std::vector<glm::mat4> m_key_start_matrices;
+    std::vector<glm::mat4> m_key_end_matrices;
+
+    float m_full_distance = 20.f;
+    float m_reduced_distance = 60.f;
+};
+
+}  // namespace TTe
@@ -0,0 +1,41 @@
+#include "animation_library.hpp"
+
+#include <stdexcept>
+
+#include "jobs/job_system.hpp"
+
+namespace TTe {
+
+AnimationLibrary::AnimationLibrary(std::vector<AnimationClip> p_clips) : m_clips(std::move(p_clips)) {
+    if (m_clips.empty()) throw std::runtime_error("animation library without clip");
+    for (uint32_t c = 0; c < m_clips.size(); c++) {
+        if (m_clips[c].empty()) throw std::runtime_error("clip " + std::to_string(c) + " of the animation library is empty");
+        if (m_clips[c].getParents() != m_clips[0].getParents()) {
+            throw std::runtime_error("clip " + std::to_string(c) + " of the animation library has another skeleton");
+        }
+    }
+    m_skeleton = FlatSkeleton(m_clips[0]);
+
+    m_baked_poses.resize(m_clips.size());
+    for (uint32_t c = 0; c < m_clips.size(); c++) {
+        const AnimationClip &clip = m_clips[c];
+        m_baked_poses[c].resize(size_t(clip.getNumberOfFrame()) * clip.getNumberOfJoint());
+        JobSystem::parallelForRange(0, clip.getNumberOfFrame(), 64, [&](uint32_t p_begin, uint32_t p_end) {
+            AnimationPose pose;
+            for (uint32_t f = p_begin; f < p_end; f++) {
+                AnimationClip::blend(clip, f, clip, f, 0.f, pose);
+                m_skeleton.computeWorldTransforms(pose, glm::mat4(1.f), m_baked_poses[c].data() + size_t(f) * clip.getNumberOfJoint());
+            }
+        });
+    }
+}
+
+std::shared_ptr<const AnimationLibrary> AnimationLibrary::load(const std::vector<std::string> &p_filenames) {
+    std::vector<BVH> bvhs = BVH::loadAll(p_filenames, true);
+    std::vector<AnimationClip> clips;
+    clips.reserve(bvhs.size());
+    for (const BVH &bvh : bvhs) clips.emplace_back(bvh);
+    return std::make_shared<const AnimationLibrary>(std::move(clips));
+}
+
+}  // namespace TTe
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "sceneV2/animatic/skeleton/animation_clip.hpp"
+#include "sceneV2/animatic/skeleton/flat_skeleton.hpp"
+
+namespace TTe {
+
+// clips of one skeleton compiled once and shared by every character playing them. The model space matrices of the joints
+// are also baked for every frame, the farthest characters of a crowd only apply their root to them
+class AnimationLibrary {
+   public:
+    // every clip must describe the same joint hierarchy
+    explicit AnimationLibrary(std::vector<AnimationClip> p_clips);
+
+    // BVH files parsed in parallel and compiled
+    static std::shared_ptr<const AnimationLibrary> load(const std::vector<std::string> &p_filenames);
+
+    uint32_t size() const { return m_clips.size(); }
+    uint32_t getNumberOfJoint() const { return m_skeleton.size(); }
+    const AnimationClip &getClip(uint32_t p_clip) const { return m_clips[p_clip]; }
+    const FlatSkeleton &getSkeleton() const { return m_skeleton; }
+
+    // model space matrices of every joint at frame p_frame of clip p_clip, looping on the clip
+    const glm::mat4 *getBakedPose(uint32_t p_clip, uint32_t p_frame) const {
+        const AnimationClip &clip = m_clips[p_clip];
+        return m_baked_poses[p_clip].data() + size_t(p_frame % clip.getNumberOfFrame()) * clip.getNumberOfJoint();
+    }
+
+   private:
+    std::vector<AnimationClip> m_clips;
+    FlatSkeleton m_skeleton;
+    // [clip][frame * nb_joint + joint]
+    std::vector<std::vector<glm::mat4>> m_baked_poses;
+};
+
+}  // namespace TTe
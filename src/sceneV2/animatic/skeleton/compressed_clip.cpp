@@ -0,0 +1,278 @@
+#include "compressed_clip.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "jobs/job_system.hpp"
+#include "sceneV2/animatic/skeleton/flat_skeleton.hpp"
+
+namespace TTe {
+
+namespace {
+
+constexpr float s_quantization = 65535.f;
+
+// a track being compressed, before the keys of every track are packed together
+struct TrackKeys {
+    glm::vec4 min{0.f};
+    glm::vec4 scale{0.f};
+    std::vector<uint16_t> frames;
+    std::vector<uint16_t> values;
+};
+
+float maxComponent(const glm::vec4 &p_v) {
+    return std::max(std::max(std::abs(p_v.x), std::abs(p_v.y)), std::max(std::abs(p_v.z), std::abs(p_v.w)));
+}
+
+// every frame strictly between p_a and p_b is within p_tolerance of the interpolation of the two
+bool segmentFits(const std::vector<glm::vec4> &p_values, uint32_t p_a, uint32_t p_b, float p_tolerance) {
+    float length = float(p_b - p_a);
+    for (uint32_t f = p_a + 1; f < p_b; f++) {
+        glm::vec4 interpolated = glm::mix(p_values[p_a], p_values[p_b], float(f - p_a) / length);
+        if (maxComponent(interpolated - p_values[f]) > p_tolerance) return false;
+    }
+    return true;
+}
+
+TrackKeys compressTrack(const std::vector<glm::vec4> &p_values, float p_tolerance) {
+    TrackKeys track;
+    glm::vec4 min = p_values[0];
+    glm::vec4 max = p_values[0];
+    for (const glm::vec4 &value : p_values) {
+        min = glm::min(min, value);
+        max = glm::max(max, value);
+    }
+
+    // constant track : the middle of the range is within the tolerance of every frame
+    if (maxComponent(max - min) <= 2.f * p_tolerance) {
+        track.min = (min + max) * 0.5f;
+        return track;
+    }
+    track.min = min;
+    track.scale = (max - min) / s_quantization;
+
+    // greedy reduction : each segment is extended while the frames it skips can be interpolated. The quantization of the
+    // keys takes up to half a step from the tolerance
+    float tolerance = std::max(p_tolerance - 0.5f * maxComponent(track.scale), 0.f);
+    uint32_t nb_frame = p_values.size();
+    std::vector<uint32_t> keys = {0};
+    while (keys.back() < nb_frame - 1) {
+        uint32_t a = keys.back();
+        uint32_t b = a + 1;
+        while (b + 1 < nb_frame && segmentFits(p_values, a, b + 1, tolerance)) b++;
+        keys.push_back(b);
+    }
+
+    track.frames.reserve(keys.size());
+    track.values.reserve(keys.size() * 4);
+    for (uint32_t f : keys) {
+        track.frames.push_back(f);
+        for (int c = 0; c < 4; c++) {
+            float normalized = track.scale[c] > 0.f ? (p_values[f][c] - min[c]) / track.scale[c] : 0.f;
+            track.values.push_back(uint16_t(std::clamp(std::round(normalized), 0.f, s_quantization)));
+        }
+    }
+    return track;
+}
+
+}  // namespace
+
+CompressedClip::CompressedClip(const AnimationClip &p_clip, float p_tolerance)
+    : m_nb_joint(p_clip.getNumberOfJoint()),
+      m_nb_frame(p_clip.getNumberOfFrame()),
+      m_frame_time(p_clip.getFrameTime()),
+      m_parents(p_clip.getParents()),
+      m_offsets(p_clip.getOffsets()) {
+    if (p_clip.empty()) return;
+    if (m_nb_frame > 65536) throw std::runtime_error("clip of " + std::to_string(m_nb_frame) + " frames is too long to be compressed");
+
+    // an error on a joint moves all its descendants. The errors along a chain of joints rarely add up in the same
+    // direction, the tolerance is shared out over the square root of the deepest chain
+    std::vector<uint32_t> depths(m_nb_joint, 1);
+    uint32_t max_depth = 1;
+    for (uint32_t j = 0; j < m_nb_joint; j++) {
+        if (m_parents[j] >= 0) depths[j] = depths[m_parents[j]] + 1;
+        max_depth = std::max(max_depth, depths[j]);
+    }
+    float joint_tolerance = p_tolerance / std::sqrt(float(max_depth));
+
+    // farthest descendant of each joint in the rest pose, children are stored after their parent. A joint without children
+    // keeps the length of its own bone, its orientation still matters for the skinning
+    std::vector<float> reaches(m_nb_joint, 0.f);
+    for (uint32_t j = m_nb_joint; j-- > 0;) {
+        reaches[j] = std::max(reaches[j], glm::length(m_offsets[j]));
+        if (m_parents[j] >= 0) reaches[m_parents[j]] = std::max(reaches[m_parents[j]], reaches[j] + glm::length(m_offsets[j]));
+    }
+
+    std::vector<TrackKeys> tracks(2 * m_nb_joint);
+    JobSystem::parallelFor(0, 2 * m_nb_joint, 1, [&](uint32_t p_track) {
+        uint32_t joint = p_track / 2;
+        bool rotation = p_track % 2 == 1;
+        std::vector<glm::vec4> values(m_nb_frame);
+        for (uint32_t f = 0; f < m_nb_frame; f++) {
+            if (rotation) {
+                const glm::quat &q = p_clip.getRotations(f)[joint];
+                values[f] = glm::vec4(q.x, q.y, q.z, q.w);
+            } else {
+                values[f] = glm::vec4(p_clip.getTranslations(f)[joint], 0.f);
+            }
+        }
+
+        // a component error e moves a point by at most sqrt(3) e for a translation. For a quaternion the rotation angle
+        // changes by at most 4 e, which moves the descendants by 4 e times their distance
+        float tolerance = joint_tolerance / std::sqrt(3.f);
+        if (rotation) tolerance = joint_tolerance / (4.f * std::max(reaches[joint], 1e-4f));
+        tracks[p_track] = compressTrack(values, tolerance);
+    });
+
+    m_tracks.resize(tracks.size());
+    for (uint32_t t = 0; t < tracks.size(); t++) {
+        m_tracks[t].min = tracks[t].min;
+        m_tracks[t].scale = tracks[t].scale;
+        m_tracks[t].first_key = m_key_frames.size();
+        m_tracks[t].nb_key = tracks[t].frames.size();
+        m_key_frames.insert(m_key_frames.end(), tracks[t].frames.begin(), tracks[t].frames.end());
+        m_key_values.insert(m_key_values.end(), tracks[t].values.begin(), tracks[t].values.end());
+    }
+}
+
+glm::vec4 CompressedClip::decode(const Track &p_track, float p_frame) const {
+    if (p_track.nb_key == 0) return p_track.min;
+
+    // segment [k, k + 1] containing the frame, the last segment also holds the last frame
+    const uint16_t *frames = m_key_frames.data() + p_track.first_key;
+    const uint16_t *next =
+        std::upper_bound(frames + 1, frames + p_track.nb_key - 1, p_frame, [](float p_f, uint16_t p_key) { return p_f < p_key; });
+    uint32_t k = uint32_t(next - frames) - 1;
+    float t = (p_frame - float(frames[k])) / float(frames[k + 1] - frames[k]);
+
+    // the two keys are contiguous : 8 components in one load, interpolated before the dequantization
+    const uint16_t *values = m_key_values.data() + size_t(p_track.first_key + k) * 4;
+    glm::vec4 result;
+#if defined(__SSE2__)
+    __m128i keys = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values));
+    __m128 a = _mm_cvtepi32_ps(_mm_unpacklo_epi16(keys, _mm_setzero_si128()));
+    __m128 b = _mm_cvtepi32_ps(_mm_unpackhi_epi16(keys, _mm_setzero_si128()));
+    __m128 quantized = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), _mm_set1_ps(t)));
+    _mm_storeu_ps(&result.x, _mm_add_ps(_mm_loadu_ps(&p_track.min.x), _mm_mul_ps(quantized, _mm_loadu_ps(&p_track.scale.x))));
+#else
+    for (int c = 0; c < 4; c++) {
+        float quantized = float(values[c]) + (float(values[c + 4]) - float(values[c])) * t;
+        result[c] = p_track.min[c] + quantized * p_track.scale[c];
+    }
+#endif
+    return result;
+}
+
+void CompressedClip::sampleFrame(uint32_t p_frame, float p_t, AnimationPose &p_pose) const {
+    p_pose.resize(m_nb_joint);
+    bool loop = p_frame + 1 >= m_nb_frame;
+    for (uint32_t j = 0; j < m_nb_joint; j++) {
+        const Track &translation_track = m_tracks[2 * j];
+        const Track &rotation_track = m_tracks[2 * j + 1];
+        glm::vec4 translation;
+        glm::vec4 rotation;
+        if (!loop) {
+            translation = decode(translation_track, float(p_frame) + p_t);
+            rotation = decode(rotation_track, float(p_frame) + p_t);
+        } else {
+            // from the last frame back to the first one, which may be in the other hemisphere
+            glm::vec4 rotation_first = decode(rotation_track, 0.f);
+            rotation = decode(rotation_track, float(p_frame));
+            if (glm::dot(rotation, rotation_first) < 0.f) rotation_first = -rotation_first;
+            rotation = glm::mix(rotation, rotation_first, p_t);
+            translation = glm::mix(decode(translation_track, float(p_frame)), decode(translation_track, 0.f), p_t);
+        }
+        p_pose.translations[j] = glm::vec3(translation);
+        p_pose.rotations[j] = glm::normalize(glm::quat(rotation.w, rotation.x, rotation.y, rotation.z));
+    }
+}
+
+void CompressedClip::sample(float p_time, AnimationPose &p_pose) const {
+    if (empty()) return;
+    float frame = std::max(p_time, 0.f) / m_frame_time;
+    uint32_t frame_1 = uint32_t(frame);
+    sampleFrame(frame_1 % m_nb_frame, frame - float(frame_1), p_pose);
+}
+
+size_t CompressedClip::getCompressedSize() const {
+    return m_tracks.size() * sizeof(Track) + (m_key_frames.size() + m_key_values.size()) * sizeof(uint16_t) +
+           m_parents.size() * sizeof(int) + m_offsets.size() * sizeof(glm::vec3);
+}
+
+uint32_t CompressedClip::getNumberOfConstantTrack() const {
+    return std::count_if(m_tracks.begin(), m_tracks.end(), [](const Track &p_track) { return p_track.nb_key == 0; });
+}
+
+float CompressedClip::computeMaxJointError(const AnimationClip &p_clip) const {
+    if (empty() || p_clip.getNumberOfFrame() != m_nb_frame || p_clip.getNumberOfJoint() != m_nb_joint) return 0.f;
+    FlatSkeleton skeleton(p_clip);
+
+    std::vector<float> errors(m_nb_frame, 0.f);
+    JobSystem::parallelForRange(0, m_nb_frame, 64, [&](uint32_t p_begin, uint32_t p_end) {
+        AnimationPose pose;
+        std::vector<glm::mat4> reference(m_nb_joint);
+        std::vector<glm::mat4> decompressed(m_nb_joint);
+        for (uint32_t f = p_begin; f < p_end; f++) {
+            AnimationClip::blend(p_clip, f, p_clip, f, 0.f, pose);
+            skeleton.computeWorldTransforms(pose, glm::mat4(1.f), reference.data());
+            sampleFrame(f, pose);
+            skeleton.computeWorldTransforms(pose, glm::mat4(1.f), decompressed.data());
+            for (uint32_t j = 0; j < m_nb_joint; j++) {
+                errors[f] = std::max(errors[f], glm::length(glm::vec3(reference[j][3]) - glm::vec3(decompressed[j][3])));
+            }
+        }
+    });
+    return *std::max_element(errors.begin(), errors.end());
+}
+
+void CompressedClip::benchmark(const std::vector<AnimationClip> &p_clips, float p_tolerance) {
+    size_t total_raw = 0;
+    size_t total_compressed = 0;
+    float total_error = 0.f;
+    for (uint32_t c = 0; c < p_clips.size(); c++) {
+        const AnimationClip &clip = p_clips[c];
+        if (clip.empty()) continue;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        CompressedClip compressed(clip, p_tolerance);
+        std::chrono::duration<double, std::milli> compression_time = std::chrono::high_resolution_clock::now() - start;
+        float error = compressed.computeMaxJointError(clip);
+
+        // sampling at times spread over the clip, the frames do not follow each other
+        const uint32_t nb_sample = 10000;
+        AnimationPose pose;
+        auto measure = [&](const auto &p_sampled) {
+            auto sample_start = std::chrono::high_resolution_clock::now();
+            for (uint32_t s = 0; s < nb_sample; s++) {
+                p_sampled.sample(float((s * 7919u) % clip.getNumberOfFrame()) * clip.getFrameTime(), pose);
+            }
+            std::chrono::duration<double, std::micro> elapsed = std::chrono::high_resolution_clock::now() - sample_start;
+            return elapsed.count() / nb_sample;
+        };
+        double raw_sample_time = measure(clip);
+        double compressed_sample_time = measure(compressed);
+
+        std::cout << "Clip " << c << " (" << clip.getNumberOfFrame() << " frames, " << clip.getNumberOfJoint() << " joints) : "
+                  << compressed.getRawSize() / 1024 << " KB -> " << compressed.getCompressedSize() / 1024 << " KB, ratio "
+                  << compressed.getCompressionRatio() << ", " << compressed.getNumberOfConstantTrack() << "/"
+                  << 2 * clip.getNumberOfJoint() << " constant tracks, " << compressed.getNumberOfKey() << " keys, max joint error "
+                  << error << ", compressed in " << compression_time.count() << " ms, sample " << raw_sample_time << " us raw / "
+                  << compressed_sample_time << " us compressed" << std::endl;
+        total_raw += compressed.getRawSize();
+        total_compressed += compressed.getCompressedSize();
+        total_error = std::max(total_error, error);
+    }
+    std::cout << "Total : " << total_raw / 1024 << " KB -> " << total_compressed / 1024 << " KB, ratio "
+              << float(total_raw) / float(std::max<size_t>(total_compressed, 1)) << ", max joint error " << total_error
+              << " for a tolerance of " << p_tolerance << std::endl;
+}
+
+}  // namespace TTe
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "sceneV2/animatic/skeleton/animation_clip.hpp"
+
+namespace TTe {
+
+// AnimationClip compressed track by track, a track being the translation or the rotation of one joint :
+//  - constant tracks keep a single value
+//  - the other tracks only keep the frames that the linear interpolation of their neighbours can not rebuild
+//  - the kept keys are quantized on 16 bits in the [min, max] range of their track
+// The tolerance is a joint position error, in the unit of the BVH, shared out between the tracks from the size of the
+// hierarchy they move. Sampling stays random access : one binary search per track and one 16 bytes load for two keys
+class CompressedClip {
+   public:
+    CompressedClip() = default;
+    CompressedClip(const AnimationClip &p_clip, float p_tolerance);
+
+    uint32_t getNumberOfJoint() const { return m_nb_joint; }
+    uint32_t getNumberOfFrame() const { return m_nb_frame; }
+    float getFrameTime() const { return m_frame_time; }
+    float getDuration() const { return m_nb_frame * m_frame_time; }
+    bool empty() const { return m_nb_frame == 0 || m_nb_joint == 0; }
+
+    const std::vector<int> &getParents() const { return m_parents; }
+    const std::vector<glm::vec3> &getOffsets() const { return m_offsets; }
+
+    // pose at p_time seconds, looping, same interpolation as AnimationClip::sample
+    void sample(float p_time, AnimationPose &p_pose) const;
+    // pose of frame p_frame, looping. An empty clip leaves p_pose unchanged, like sample
+    void sampleFrame(uint32_t p_frame, AnimationPose &p_pose) const {
+        if (empty()) return;
+        sampleFrame(p_frame % m_nb_frame, 0.f, p_pose);
+    }
+
+    // bytes of the tracks, against the frames of an AnimationClip
+    size_t getCompressedSize() const;
+    size_t getRawSize() const { return size_t(m_nb_frame) * m_nb_joint * (sizeof(glm::vec3) + sizeof(glm::quat)); }
+    float getCompressionRatio() const { return float(getRawSize()) / float(std::max<size_t>(getCompressedSize(), 1)); }
+    uint32_t getNumberOfConstantTrack() const;
+    uint32_t getNumberOfKey() const { return m_key_frames.size(); }
+
+    // largest distance between a joint of p_clip (the compressed clip) and the same joint decompressed, over every frame
+    float computeMaxJointError(const AnimationClip &p_clip) const;
+
+    // compression of every clip, with ratio, error and sampling time printed on std::cout
+    static void benchmark(const std::vector<AnimationClip> &p_clips, float p_tolerance);
+
+   private:
+    struct Track {
+        // constant track : value, otherwise value of the quantized 0
+        glm::vec4 min{0.f};
+        // (max - min) / 65535
+        glm::vec4 scale{0.f};
+        uint32_t first_key = 0;
+        // 0 for a constant track, at least the first and last frames otherwise
+        uint32_t nb_key = 0;
+    };
+
+    // value of track p_track at frame p_frame in [0, nb_frame - 1]
+    glm::vec4 decode(const Track &p_track, float p_frame) const;
+    void sampleFrame(uint32_t p_frame, float p_t, AnimationPose &p_pose) const;
+
+    uint32_t m_nb_joint = 0;
+    uint32_t m_nb_frame = 0;
+    float m_frame_time = 0.f;
+
+    std::vector<int> m_parents;
+    std::vector<glm::vec3> m_offsets;
+
+    // translation of joint j at 2 * j, rotation at 2 * j + 1
+    std::vector<Track> m_tracks;
+    // keys of a track are contiguous : frame indices and 4 quantized components per key (translations padded)
+    std::vector<uint16_t> m_key_frames;
+    std::vector<uint16_t> m_key_values;
+};
+
+}  // namespace TTe
@@ -0,0 +1,42 @@
+#include "flat_skeleton.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace TTe {
+
+FlatSkeleton::FlatSkeleton(const AnimationClip &p_clip)
+    : m_parents(p_clip.getParents()), m_has_children(m_parents.size(), 0), m_offsets(p_clip.getOffsets()) {
+    for (uint32_t j = 0; j < m_parents.size(); j++) {
+        if (m_parents[j] >= int(j)) {
+            throw std::runtime_error("joint " + std::to_string(j) + " is stored before its parent " + std::to_string(m_parents[j]));
+        }
+        if (m_parents[j] >= 0) m_has_children[m_parents[j]] = 1;
+    }
+
+    // rest pose until the first update
+    m_world_matrices.resize(m_parents.size());
+    for (uint32_t j = 0; j < m_parents.size(); j++) {
+        glm::mat4 local(1.f);
+        local[3] = glm::vec4(m_offsets[j], 1.f);
+        m_world_matrices[j] = m_parents[j] < 0 ? local : m_world_matrices[m_parents[j]] * local;
+    }
+}
+
+void FlatSkeleton::computeWorldTransforms(const AnimationPose &p_pose, const glm::mat4 &p_root) {
+    computeWorldTransforms(p_pose, p_root, m_world_matrices.data());
+}
+
+void FlatSkeleton::computeWorldTransforms(const AnimationPose &p_pose, const glm::mat4 &p_root, glm::mat4 *p_world_matrices) const {
+    uint32_t nb_joint = std::min(size(), p_pose.size());
+    for (uint32_t j = 0; j < nb_joint; j++) {
+        glm::mat4 local = glm::mat4_cast(p_pose.rotations[j]);
+        local[3] = glm::vec4(p_pose.translations[j], 1.f);
+
+        int parent = m_parents[j];
+        p_world_matrices[j] = (parent < 0 ? p_root : p_world_matrices[parent]) * local;
+    }
+}
+
+}  // namespace TTe
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "sceneV2/animatic/skeleton/animation_clip.hpp"
+
+namespace TTe {
+
+// joint hierarchy of a skeleton as flat arrays, every parent stored before its children (BVH order) :
+// the world transforms of all the joints are computed in one forward pass, without Node, callbacks or dirty propagation
+class FlatSkeleton {
+   public:
+    FlatSkeleton() = default;
+    explicit FlatSkeleton(const AnimationClip &p_clip);
+
+    uint32_t size() const { return m_parents.size(); }
+    int getParent(uint32_t p_joint) const { return m_parents[p_joint]; }
+    bool hasChildren(uint32_t p_joint) const { return m_has_children[p_joint]; }
+    // joint offset in its parent, the local translation of the rest pose
+    const glm::vec3 &getOffset(uint32_t p_joint) const { return m_offsets[p_joint]; }
+
+    // world matrices of every joint for the local pose p_pose, p_root is the world matrix of the skeleton object
+    void computeWorldTransforms(const AnimationPose &p_pose, const glm::mat4 &p_root);
+    // same pass written in p_world_matrices (size() matrices), the skeleton can then be shared between threads
+    void computeWorldTransforms(const AnimationPose &p_pose, const glm::mat4 &p_root, glm::mat4 *p_world_matrices) const;
+
+    const glm::mat4 &getWorldMatrix(uint32_t p_joint) const { return m_world_matrices[p_joint]; }
+    glm::vec3 getWorldPosition(uint32_t p_joint) const { return m_world_matrices[p_joint][3]; }
+
+   private:
+    std::vector<int> m_parents;
+    std::vector<uint8_t> m_has_children;
+    std::vector<glm::vec3> m_offsets;
+
+    std::vector<glm::mat4> m_world_matrices;
+};
+
+}  // namespace TTe
@@ -0,0 +1,100 @@
+#include "pose_distance.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+#include "jobs/job_system.hpp"
+
+namespace TTe {
+
+JointPositionTable::JointPositionTable(const AnimationClip &p_clip, const glm::mat4 &p_root)
+    : nb_joint(p_clip.getNumberOfJoint()), nb_frame(p_clip.getNumberOfFrame()) {
+    x.resize(size_t(nb_joint) * nb_frame);
+    y.resize(size_t(nb_joint) * nb_frame);
+    z.resize(size_t(nb_joint) * nb_frame);
+
+    // joints are stored after their parent in a BVH, the hierarchy is walked in one pass per frame
+    const std::vector<int> &parents = p_clip.getParents();
+    JobSystem::parallelForRange(0, nb_frame, 64, [&](uint32_t p_begin, uint32_t p_end) {
+        std::vector<glm::quat> rotations(nb_joint);
+        std::vector<glm::vec3> positions(nb_joint);
+        for (uint32_t f = p_begin; f < p_end; f++) {
+            const glm::vec3 *translations = p_clip.getTranslations(f);
+            const glm::quat *local_rotations = p_clip.getRotations(f);
+            for (uint32_t j = 0; j < nb_joint; j++) {
+                int parent = parents[j];
+                if (parent < 0) {
+                    rotations[j] = local_rotations[j];
+                    positions[j] = translations[j];
+                } else {
+                    rotations[j] = rotations[parent] * local_rotations[j];
+                    positions[j] = positions[parent] + rotations[parent] * translations[j];
+                }
+
+                glm::vec3 world = p_root * glm::vec4(positions[j], 1.f);
+                size_t index = size_t(j) * nb_frame + f;
+                x[index] = world.x;
+                y[index] = world.y;
+                z[index] = world.z;
+            }
+        }
+    });
+}
+
+namespace {
+
+// p_distances[f] += |p_point - joint position at frame f| for the p_nb_frame frames of one joint
+void accumulateDistances(const float *p_x, const float *p_y, const float *p_z, glm::vec3 p_point, uint32_t p_nb_frame, float *p_distances) {
+    uint32_t f = 0;
+#if defined(__SSE__)
+    __m128 point_x = _mm_set1_ps(p_point.x);
+    __m128 point_y = _mm_set1_ps(p_point.y);
+    __m128 point_z = _mm_set1_ps(p_point.z);
+    for (; f + 4 <= p_nb_frame; f += 4) {
+        __m128 dx = _mm_sub_ps(_mm_loadu_ps(p_x + f), point_x);
+        __m128 dy = _mm_sub_ps(_mm_loadu_ps(p_y + f), point_y);
+        __m128 dz = _mm_sub_ps(_mm_loadu_ps(p_z + f), point_z);
+        __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz)));
+        _mm_storeu_ps(p_distances + f, _mm_add_ps(_mm_loadu_ps(p_distances + f), length));
+    }
+#endif
+    for (; f < p_nb_frame; f++) {
+        float dx = p_x[f] - p_point.x;
+        float dy = p_y[f] - p_point.y;
+        float dz = p_z[f] - p_point.z;
+        p_distances[f] += std::sqrt(dx * dx + dy * dy + dz * dz);
+    }
+}
+
+}  // namespace
+
+std::vector<ClosestFrame> findClosestFrames(const JointPositionTable &p_from, const JointPositionTable &p_to) {
+    std::vector<ClosestFrame> closest(p_from.nb_frame);
+    uint32_t nb_joint = std::min(p_from.nb_joint, p_to.nb_joint);
+    if (p_to.nb_frame == 0 || nb_joint == 0) return closest;
+
+    JobSystem::parallelForRange(0, p_from.nb_frame, 16, [&](uint32_t p_begin, uint32_t p_end) {
+        std::vector<float> distances(p_to.nb_frame);
+        for (uint32_t i = p_begin; i < p_end; i++) {
+            std::fill(distances.begin(), distances.end(), 0.f);
+            for (uint32_t j = 0; j < nb_joint; j++) {
+                size_t from_index = size_t(j) * p_from.nb_frame + i;
+                glm::vec3 point(p_from.x[from_index], p_from.y[from_index], p_from.z[from_index]);
+                size_t to_index = size_t(j) * p_to.nb_frame;
+                accumulateDistances(
+                    p_to.x.data() + to_index, p_to.y.data() + to_index, p_to.z.data() + to_index, point, p_to.nb_frame, distances.data());
+            }
+
+            auto min = std::min_element(distances.begin(), distances.end());
+            closest[i].frame = int(min - distances.begin());
+            closest[i].distance = *min;
+        }
+    });
+    return closest;
+}
+
+}  // namespace TTe
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "sceneV2/animatic/skeleton/animation_clip.hpp"
+
+namespace TTe {
+
+// position of every joint at every frame of a clip, computed once by forward kinematics and transformed by p_root.
+// One array per axis, axis[joint * nb_frame + frame] : the frames of a joint are contiguous, so one pose is compared to
+// all the frames of another clip with SIMD
+struct JointPositionTable {
+    JointPositionTable() = default;
+    JointPositionTable(const AnimationClip &p_clip, const glm::mat4 &p_root);
+
+    uint32_t nb_joint = 0;
+    uint32_t nb_frame = 0;
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+};
+
+struct ClosestFrame {
+    int frame = -1;
+    float distance = 0.f;
+};
+
+// for every frame of p_from, the frame of p_to minimizing the sum of the distances between their joints.
+// The frames of p_from are spread on the job system, both tables must have the same joints
+std::vector<ClosestFrame> findClosestFrames(const JointPositionTable &p_from, const JointPositionTable &p_to);
+
+}  // namespace TTe
@@ -4,267 +4,254 @@
 #include <GLFW/glfw3.h>
 
 #include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
 #include <string>
 
 #include "math/quaternion_convertor.hpp"
 #include "sceneV2/IIndirectRenderable.hpp"
 #include "sceneV2/animatic/skeleton/BVHAxis.h"
 #include "sceneV2/animatic/skeleton/BVHChannel.h"
+#include "sceneV2/animatic/skeleton/pose_distance.hpp"
 
 #include <filesystem>
 
 #include <memory>
 
+#include "md5.h"
 #include "sceneV2/mesh.hpp"
 
 namespace TTe {
 
+namespace {
+// summed joint distance under which a frame of a clip can jump to a frame of another one
+constexpr float s_transition_threshold = 25.f;
+
+constexpr char s_graph_cache_magic[4] = {'T', 'T', 'M', 'G'};
+constexpr uint32_t s_graph_cache_version = 2;
+}  // namespace
+
 void SkeletonObj::init(BVH bvh) {
     m_bvh[State::IDLE] = bvh;
     state = State::IDLE;
-    for (int i = 0; i < bvh.getNumberOfJoint(); i++) {
-        std::shared_ptr<SkeletonNode> joint1 = std::make_shared<SkeletonNode>();
-        std::shared_ptr<SkeletonNode> joint2 = std::make_shared<SkeletonNode>();
-        std::shared_ptr<SkeletonNode> joint3 = std::make_shared<SkeletonNode>();
-        auto jointMat = bvh.getJoint(i);
-        int parent_id = jointMat.getParentId();
-
-        joint1->setId(i);
-        joint2->setId(i);
-        joint3->setId(i);
-        if (parent_id == -1) {
-            this->addChild(joint1);
-            this->addChild(joint2);
-            this->addChild(joint3);
-        } else {
-            m_joints_1[parent_id]->addChild(joint1);
-            m_joints_2[parent_id]->addChild(joint2);
-            m_joints_final[parent_id]->addChild(joint3);
-        }
-
-        glm::vec3 pos;
-        jointMat.getOffset(pos.x, pos.y, pos.z);
-        joint1->transform.pos = pos;
-        joint2->transform.pos = pos;
-        joint3->transform.pos = pos;
-
-        m_joints_1.push_back(joint1);
-        m_joints_2.push_back(joint2);
-        m_joints_final.push_back(joint3);
-    }
-    coliders.resize(m_joints_1.size() - 6);
+    m_clips[State::IDLE] = AnimationClip(bvh);
+    initSkeleton(m_clips[State::IDLE]);
     this->transform.scale = glm::vec3(0.05f);
     this->transform.pos = glm::vec3(4, -10, 3);
 }
 
 void SkeletonObj::init(std::filesystem::path bvh_folder) {
+    std::vector<std::string> filenames;
+    std::vector<State> file_states;
+    const std::pair<const char *, State> state_names[] = {
+        {"talk", State::IDLE}, {"walk", State::WALK}, {"run", State::RUN}, {"kick", State::KICK}};
     for (const auto &entry : std::filesystem::directory_iterator(bvh_folder)) {
-        if (entry.path().filename().string().find("talk") != std::string::npos) {
-            m_bvh[State::IDLE] = BVH(entry.path(), true);
-        }
-        if (entry.path().filename().string().find("walk") != std::string::npos) {
-            m_bvh[State::WALK] = BVH(entry.path(), true);
-        }
-        if (entry.path().filename().string().find("run") != std::string::npos) {
-            m_bvh[State::RUN] = BVH(entry.path(), true);
-        }
-        if (entry.path().filename().string().find("kick") != std::string::npos) {
-            m_bvh[State::KICK] = BVH(entry.path(), true);
+        for (auto &state_name : state_names) {
+            if (entry.path().filename().string().find(state_name.first) != std::string::npos) {
+                filenames.push_back(entry.path().string());
+                file_states.push_back(state_name.second);
+            }
         }
 
         std::cout << entry.path() << std::endl;
     }
 
-    state = State::IDLE;
-    nextState = State::IDLE;
-    for (int i = 0; i < m_bvh[State::IDLE].getNumberOfJoint(); i++) {
-        std::shared_ptr<SkeletonNode> joint1 = std::make_shared<SkeletonNode>();
-        std::shared_ptr<SkeletonNode> joint2 = std::make_shared<SkeletonNode>();
-        std::shared_ptr<SkeletonNode> joint3 = std::make_shared<SkeletonNode>();
-        auto jointMat = m_bvh[State::IDLE].getJoint(i);
-
-        int parent_id = jointMat.getParentId();
-
-        joint1->setId(i);
-        joint2->setId(i);
-        joint3->setId(i);
-        if (parent_id == -1) {
-            this->addChild(joint1);
-            this->addChild(joint2);
-            this->addChild(joint3);
-        } else {
-            m_joints_1[parent_id]->addChild(joint1);
-            m_joints_2[parent_id]->addChild(joint2);
-            m_joints_final[parent_id]->addChild(joint3);
-        }
-
-        glm::vec3 pos;
-        jointMat.getOffset(pos.x, pos.y, pos.z);
-        joint1->transform.pos = pos;
-        joint2->transform.pos = pos;
-        joint3->transform.pos = pos;
+    // the clips are parsed in parallel
+    std::vector<BVH> bvhs = BVH::loadAll(filenames, true);
+    for (size_t i = 0; i < bvhs.size(); i++) {
+        m_bvh[file_states[i]] = bvhs[i];
+    }
 
-        m_joints_1.push_back(joint1);
-        m_joints_2.push_back(joint2);
-        m_joints_final.push_back(joint3);
+    for (auto &bvh : m_bvh) {
+        m_clips[bvh.first] = AnimationClip(bvh.second);
     }
-    coliders.resize(m_joints_1.size() - 6);
+
+    state = State::IDLE;
+    nextState = State::IDLE;
+    initSkeleton(m_clips[State::IDLE]);
     this->transform.scale = glm::vec3(0.10);
     this->transform.pos = glm::vec3(4, -10, 3);
 
-    // create graph
+    buildTransitionGraph(bvh_folder / "transitions.cache");
+}
 
-    for (auto &bvh : m_bvh) {
-        for (int i = 0; i < bvh.second.getNumberOfFrame(); i++) {
-            for (auto &other_bvh : m_bvh) {
-                if (bvh.first != other_bvh.first) {
-                    FrameTransition frameTransition = {-1, -1};
-                    float minDistance = 25.f;
-                    for (int j = 0; j < other_bvh.second.getNumberOfFrame(); j++) {
-                        float dist = computePoseDistance(i, j, bvh.second, other_bvh.second);
-                        if (dist < minDistance) {
-                            minDistance = dist;
-                            frameTransition.frame_1 = i;
-                            frameTransition.frame_2 = j;
-                        }
-                    }
-                    if (frameTransition.frame_1 != -1) {
-                        if (bvh.first == State::KICK) {
-                            if (i == bvh.second.getNumberOfFrame() - 1) {
-                                frameTransition.frame_1 = 0;
-                                transitions_graph[{bvh.first, other_bvh.first}].push_back(frameTransition);
-                            }
-                        } else {
-                            transitions_graph[{bvh.first, other_bvh.first}].push_back(frameTransition);
-                        }
-                    }
-                }
-            }
-        }
+std::string SkeletonObj::computeClipsHash(const glm::mat4 &p_root) const {
+    Chocobo1::MD5 md5;
+    auto add = [&md5](const void *p_data, size_t p_size) { md5.addData(static_cast<const char *>(p_data), p_size); };
+    add(&s_graph_cache_version, sizeof(s_graph_cache_version));
+    add(&s_transition_threshold, sizeof(s_transition_threshold));
+    add(&p_root, sizeof(p_root));
+    for (auto &clip : m_clips) {
+        uint32_t sizes[2] = {clip.second.getNumberOfJoint(), clip.second.getNumberOfFrame()};
+        add(&clip.first, sizeof(clip.first));
+        add(sizes, sizeof(sizes));
+        if (clip.second.empty()) continue;
+        add(clip.second.getParents().data(), clip.second.getParents().size() * sizeof(int));
+        add(clip.second.getTranslations(0), size_t(sizes[0]) * sizes[1] * sizeof(glm::vec3));
+        add(clip.second.getRotations(0), size_t(sizes[0]) * sizes[1] * sizeof(glm::quat));
     }
-
-    int test = 0;
+    return md5.finalize().toString();
 }
 
-float SkeletonObj::computePoseDistance(int frame_1, int frame_2, BVH &bvh_1, BVH &bvh_2) {
-    float returnValue = 0;
-    for (int i = 0; i < m_bvh[state].getNumberOfJoint(); i++) {
-        auto jointMat1 = bvh_1.getJoint(i);
-        auto jointMat2 = bvh_2.getJoint(i);
-
-        glm::vec3 pos;
-        jointMat1.getOffset(pos.x, pos.y, pos.z);
-
-        glm::vec3 rot1 = glm::vec3(0.0f);
-        glm::vec3 trans1 = glm::vec3(0.0f);
-        glm::vec3 rot2 = glm::vec3(0.0f);
-        glm::vec3 trans2 = glm::vec3(0.0f);
-
-        for (int j = 0; j < jointMat1.getNumberOfChannel(); ++j) {
-            auto channel_1 = jointMat1.getChannel(j);
-
-            float data1 = channel_1.getData(frame_1);
-
-            if (channel_1.getType() == BVHChannel::TYPE_TRANSLATION) {
-                switch (channel_1.getAxis()) {
-                    case AXIS_X:
-                        trans1.x = data1;
-                        break;
-                    case AXIS_Y:
-                        trans1.y = data1;
-                        break;
-                    case AXIS_Z:
-                        trans1.z = data1;
-                        break;
-                    case AXIS_W:;
-                        break;
-                }
-            }
-            if (channel_1.getType() == BVHChannel::TYPE_ROTATION) {
-                switch (channel_1.getAxis()) {
-                    case AXIS_X:
-                        rot1.x = glm::radians(data1);
-                        break;
-                    case AXIS_Y:
-                        rot1.y = glm::radians(data1);
-                        break;
-                    case AXIS_Z:
-                        rot1.z = glm::radians(data1);
-                        break;
-                    case AXIS_W:;
-                        break;
-                }
-            }
-        }
+void SkeletonObj::buildTransitionGraph(const std::filesystem::path &p_cache_path) {
+    glm::mat4 root = wMatrix();
+    std::string hash = computeClipsHash(root);
+    if (loadTransitionGraph(p_cache_path, hash)) {
+        std::cout << "Motion graph loaded from " << p_cache_path << std::endl;
+        return;
+    }
 
-        for (int j = 0; j < jointMat1.getNumberOfChannel(); ++j) {
-            auto channel_2 = jointMat2.getChannel(j);
-
-            float data2 = channel_2.getData(frame_2);
-
-            if (channel_2.getType() == BVHChannel::TYPE_TRANSLATION) {
-                switch (channel_2.getAxis()) {
-                    case AXIS_X:
-                        trans2.x = data2;
-                        break;
-                    case AXIS_Y:
-                        trans2.y = data2;
-                        break;
-                    case AXIS_Z:
-                        trans2.z = data2;
-                        break;
-                    case AXIS_W:;
-                        break;
+    auto start = std::chrono::high_resolution_clock::now();
+    transitions_graph.clear();
+
+    // joint positions of every frame are computed once, then each pair of clips is compared frame against frame
+    std::vector<State> states;
+    for (auto &clip : m_clips) states.push_back(clip.first);
+    std::vector<JointPositionTable> tables(states.size());
+    for (size_t i = 0; i < states.size(); i++) {
+        tables[i] = JointPositionTable(m_clips[states[i]], root);
+    }
+
+    for (size_t a = 0; a < states.size(); a++) {
+        for (size_t b = 0; b < states.size(); b++) {
+            if (a == b || tables[a].nb_frame == 0) continue;
+            std::vector<ClosestFrame> closest = findClosestFrames(tables[a], tables[b]);
+
+            std::vector<FrameTransition> transitions;
+            if (states[a] == State::KICK) {
+                // a kick is only left once finished
+                if (closest.back().distance < s_transition_threshold) transitions.push_back({0, closest.back().frame});
+            } else {
+                // only the local minima of the distance along the source clip are kept
+                for (size_t i = 0; i < closest.size(); i++) {
+                    if (closest[i].distance >= s_transition_threshold) continue;
+                    bool previous_higher = i == 0 || closest[i - 1].distance >= closest[i].distance;
+                    bool next_higher = i + 1 == closest.size() || closest[i + 1].distance > closest[i].distance;
+                    if (previous_higher && next_higher) transitions.push_back({int(i), closest[i].frame});
                 }
             }
-            if (channel_2.getType() == BVHChannel::TYPE_ROTATION) {
-                switch (channel_2.getAxis()) {
-                    case AXIS_X:
-                        rot2.x = glm::radians(data2);
-                        break;
-                    case AXIS_Y:
-                        rot2.y = glm::radians(data2);
-                        break;
-                    case AXIS_Z:
-                        rot2.z = glm::radians(data2);
-                        break;
-                    case AXIS_W:;
-                        break;
-                }
+            // every pair keeps at least its closest frames, even above the threshold, so any state can be reached
+            if (transitions.empty() && states[a] == State::KICK) {
+                transitions.push_back({0, closest.back().frame});
+            } else if (transitions.empty()) {
+                auto minimum = std::min_element(closest.begin(), closest.end(), [](const ClosestFrame &p_a, const ClosestFrame &p_b) {
+                    return p_a.distance < p_b.distance;
+                });
+                transitions.push_back({int(minimum - closest.begin()), minimum->frame});
             }
+            transitions_graph[{states[a], states[b]}] = std::move(transitions);
         }
+    }
 
-        // CollisionObject c(CollisionObject::Type::sphere);
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed = end - start;
+    std::cout << "Motion graph construction took: " << elapsed.count() << " seconds" << std::endl;
 
-        m_joints_1[i]->transform.pos = pos + trans1;
-        m_joints_1[i]->transform.rot = rot1;
+    saveTransitionGraph(p_cache_path, hash);
+}
 
-        m_joints_2[i]->transform.pos = pos + trans2;
-        m_joints_2[i]->transform.rot = rot2;
+// cache file : magic, version, hash of the clips, then for each pair of states its transitions
+bool SkeletonObj::loadTransitionGraph(const std::filesystem::path &p_path, const std::string &p_hash) {
+    std::ifstream file(p_path, std::ios::binary);
+    if (!file.is_open()) return false;
+
+    char magic[4];
+    uint32_t version = 0;
+    uint32_t hash_size = 0;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char *>(&version), sizeof(version));
+    file.read(reinterpret_cast<char *>(&hash_size), sizeof(hash_size));
+    if (!file || std::memcmp(magic, s_graph_cache_magic, sizeof(magic)) != 0 || version != s_graph_cache_version ||
+        hash_size != p_hash.size()) {
+        return false;
+    }
+    std::string hash(hash_size, '\0');
+    file.read(hash.data(), hash_size);
+    if (!file || hash != p_hash) return false;
+
+    uint32_t nb_edges = 0;
+    file.read(reinterpret_cast<char *>(&nb_edges), sizeof(nb_edges));
+    transitions_graph.clear();
+    for (uint32_t e = 0; e < nb_edges && file; e++) {
+        uint32_t header[3];
+        file.read(reinterpret_cast<char *>(header), sizeof(header));
+        if (!file) break;
+        std::vector<FrameTransition> transitions(header[2]);
+        file.read(reinterpret_cast<char *>(transitions.data()), transitions.size() * sizeof(FrameTransition));
+        transitions_graph[{State(header[0]), State(header[1])}] = std::move(transitions);
+    }
+    if (!file) {
+        transitions_graph.clear();
+        return false;
+    }
+    return true;
+}
+
+void SkeletonObj::saveTransitionGraph(const std::filesystem::path &p_path, const std::string &p_hash) const {
+    std::ofstream file(p_path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "failed to open motion graph cache for writing: " << p_path << std::endl;
+        return;
+    }
 
-        glm::vec3 pos_1 = m_joints_1[i]->wMatrix()[3];
-        glm::vec3 pos_2 = m_joints_2[i]->wMatrix()[3];
-        returnValue += glm::length(pos_1 - pos_2);
+    uint32_t hash_size = p_hash.size();
+    uint32_t nb_edges = transitions_graph.size();
+    file.write(s_graph_cache_magic, sizeof(s_graph_cache_magic));
+    file.write(reinterpret_cast<const char *>(&s_graph_cache_version), sizeof(s_graph_cache_version));
+    file.write(reinterpret_cast<const char *>(&hash_size), sizeof(hash_size));
+    file.write(p_hash.data(), hash_size);
+    file.write(reinterpret_cast<const char *>(&nb_edges), sizeof(nb_edges));
+    for (auto &edge : transitions_graph) {
+        uint32_t header[3] = {uint32_t(edge.first.state_1), uint32_t(edge.first.state_2), uint32_t(edge.second.size())};
+        file.write(reinterpret_cast<const char *>(header), sizeof(header));
+        file.write(reinterpret_cast<const char *>(edge.second.data()), edge.second.size() * sizeof(FrameTransition));
     }
-    return returnValue;
+    if (!file) std::cerr << "failed to write motion graph cache: " << p_path << std::endl;
 }
 
-glm::vec3 SkeletonObj::getJointPosition(int i) const {
-    glm::vec3 returnValue;
-    return returnValue;
+void SkeletonObj::initSkeleton(const AnimationClip &clip) {
+    m_skeleton = FlatSkeleton(clip);
+
+    // one capsule between each joint and its parent, the end sites have none
+    size_t nb_capsules = 0;
+    for (uint32_t i = 0; i < m_skeleton.size(); i++) {
+        if (m_skeleton.getParent(i) >= 0 && m_skeleton.hasChildren(i)) nb_capsules++;
+    }
+    coliders.resize(nb_capsules);
 }
 
-int SkeletonObj::getParentId(const int i) const {
-    int returnValue;
-    return returnValue;
+void SkeletonObj::setDebugJoints(bool enable) {
+    // only the roots are children of the skeleton, the others go away with them
+    for (auto &joint : m_debug_joints) {
+        if (joint->getParent() == this) this->removeChild(joint);
+    }
+    m_debug_joints.clear();
+    if (!enable) return;
+
+    for (uint32_t i = 0; i < m_skeleton.size(); i++) {
+        std::shared_ptr<SkeletonNode> joint = std::make_shared<SkeletonNode>();
+        joint->setId(i);
+        joint->transform.pos = m_skeleton.getOffset(i);
+        int parent_id = m_skeleton.getParent(i);
+        if (parent_id < 0) {
+            this->addChild(joint);
+        } else {
+            m_debug_joints[parent_id]->addChild(joint);
+        }
+        m_debug_joints.push_back(joint);
+    }
 }
 
+glm::vec3 SkeletonObj::getJointPosition(int i) const { return m_skeleton.getWorldPosition(i); }
+
+int SkeletonObj::getParentId(const int i) const { return m_skeleton.getParent(i); }
+
 void SkeletonObj::setPose(const BVH &bvh, int frameNumber) {}
 
 
 
-void SkeletonObj::simulation(
-    glm::vec3 gravite, float viscosite, uint32_t tick, float dt, float t, std::vector<std::shared_ptr<ICollider>> &m_collision_objects) {
+void SkeletonObj::simulation(glm::vec3 gravite, float viscosite, uint32_t tick, float dt, float t) {
     float time = t / 0.081667;
 
     interpol = time - floor(time);
@@ -298,125 +285,25 @@ void SkeletonObj::simulation(
         secon_State = state;
     }
 
-    int collider_iter = 0;
-
-    for (int i = 0; i < m_bvh[state].getNumberOfJoint(); i++) {
-        if (lastFrame != frameNB) {
-            if (i == m_bvh[state].getNumberOfJoint() - 1) lastFrame = frameNB;
-
-            auto jointMat1 = m_bvh[state].getJoint(i);
-            auto jointMat2 = m_bvh[secon_State].getJoint(i);
-
-            glm::vec3 pos;
-            jointMat1.getOffset(pos.x, pos.y, pos.z);
-
-            glm::vec3 rot1 = glm::vec3(0.0f);
-            glm::vec3 trans1 = glm::vec3(0.0f);
-            glm::vec3 rot2 = glm::vec3(0.0f);
-            glm::vec3 trans2 = glm::vec3(0.0f);
-
-            for (int j = 0; j < jointMat1.getNumberOfChannel(); ++j) {
-                auto channel_1 = jointMat1.getChannel(j);
-
-                float data1 = channel_1.getData(frameNB);
-
-                if (channel_1.getType() == BVHChannel::TYPE_TRANSLATION) {
-                    switch (channel_1.getAxis()) {
-                        case AXIS_X:
-                            trans1.x = data1;
-                            break;
-                        case AXIS_Y:
-                            trans1.y = data1;
-                            break;
-                        case AXIS_Z:
-                            trans1.z = data1;
-                            break;
-                        case AXIS_W:;
-                            break;
-                    }
-                }
-                if (channel_1.getType() == BVHChannel::TYPE_ROTATION) {
-                    switch (channel_1.getAxis()) {
-                        case AXIS_X:
-                            rot1.x = glm::radians(data1);
-                            break;
-                        case AXIS_Y:
-                            rot1.y = glm::radians(data1);
-                            break;
-                        case AXIS_Z:
-                            rot1.z = glm::radians(data1);
-                            break;
-                        case AXIS_W:;
-                            break;
-                    }
-                }
-            }
-
-            for (int j = 0; j < jointMat1.getNumberOfChannel(); ++j) {
-                auto channel_2 = jointMat2.getChannel(j);
-
-                float data2 = channel_2.getData(frameNB2);
-
-                if (channel_2.getType() == BVHChannel::TYPE_TRANSLATION) {
-                    switch (channel_2.getAxis()) {
-                        case AXIS_X:
-                            trans2.x = data2;
-                            break;
-                        case AXIS_Y:
-                            trans2.y = data2;
-                            break;
-                        case AXIS_Z:
-                            trans2.z = data2;
-                            break;
-                        case AXIS_W:;
-                            break;
-                    }
-                }
-                if (channel_2.getType() == BVHChannel::TYPE_ROTATION) {
-                    switch (channel_2.getAxis()) {
-                        case AXIS_X:
-                            rot2.x = glm::radians(data2);
-                            break;
-                        case AXIS_Y:
-                            rot2.y = glm::radians(data2);
-                            break;
-                        case AXIS_Z:
-                            rot2.z = glm::radians(data2);
-                            break;
-                        case AXIS_W:;
-                            break;
-                    }
-                }
-            }
-
-            // CollisionObject c(CollisionObject::Type::sphere);
-
-            m_joints_1[i]->transform.pos = pos + trans1;
-            m_joints_1[i]->transform.rot = rot1;
-
-            m_joints_2[i]->transform.pos = pos + trans2;
-            m_joints_2[i]->transform.rot = rot2;
-        }
+    // both frames are read from the compiled clips and blended in quaternions in a single pass over the joints
+    lastFrame = frameNB;
+    AnimationClip::blend(m_clips[state], frameNB, m_clips[secon_State], frameNB2, interpol, m_pose);
 
-        m_joints_final[i]->transform.pos = glm::mix(m_joints_1[i]->transform.pos.value, m_joints_2[i]->transform.pos.value, interpol);
-        glm::quat q1 = eulerZXYtoQuat(m_joints_1[i]->transform.rot.value);
-        glm::quat q2 = eulerZXYtoQuat(m_joints_2[i]->transform.rot.value);
+    m_skeleton.computeWorldTransforms(m_pose, wMatrix());
 
-        glm::quat q = glm::slerp(q1, q2, interpol);
-        m_joints_final[i]->transform.rot = quatToEulerZXY(q);
-        // m_joints_final[i]->transform.rot = m_joints_1[i]->transform.rot;
-        // m_joints_final[i]->transform.pos = m_joints_1[i]->transform.pos;
+    size_t collider_iter = 0;
+    for (uint32_t i = 0; i < m_skeleton.size() && collider_iter < coliders.size(); i++) {
+        int parent_id = m_skeleton.getParent(i);
+        if (parent_id < 0 || !m_skeleton.hasChildren(i)) continue;
+        coliders[collider_iter].first = m_skeleton.getWorldPosition(i);
+        coliders[collider_iter].second = m_skeleton.getWorldPosition(parent_id);
+        collider_iter++;
+    }
 
-        if (m_joints_final[i]->m_id != 0) {
-            if (m_joints_final[i]->m_children.size() == 0) {
-                continue;
-            }
-            glm::vec3 jpos = m_joints_final[i]->wMatrix()[3];
-            glm::vec3 ppos = m_joints_final[i]->m_parent->wMatrix()[3];
-            coliders[collider_iter].first = jpos;
-            coliders[collider_iter].second = ppos;
-            collider_iter++;
-        }
+    // the joint nodes only exist for debug visualization
+    for (uint32_t i = 0; i < m_debug_joints.size() && i < m_pose.size(); i++) {
+        m_debug_joints[i]->transform.pos = m_pose.translations[i];
+        m_debug_joints[i]->transform.rot = quatToEulerZXY(m_pose.rotations[i]);
     }
 }
 
@@ -427,8 +314,8 @@ void SkeletonObj::render(CommandBuffer &cmd, RenderData &renderData) {
     //     renderData.binded_pipeline->bindPipeline(cmd);
     //     renderData.binded_pipeline = renderData.default_pipeline;
     // }
-    // for (int i = 0; i < m_joints_final.size(); i++) {
-    //     PushConstantData pc = {m_joints_final[i]->wMatrix() * glm::scale(glm::vec3(1.3f)), m_joints_final[i]->wNormalMatrix(), renderData.portal_pos, renderData.cameraId, renderData.portal_normal};
+    // for (int i = 0; i < m_debug_joints.size(); i++) {
+    //     PushConstantData pc = {m_debug_joints[i]->wMatrix() * glm::scale(glm::vec3(1.3f)), m_debug_joints[i]->wNormalMatrix(), renderData.portal_pos, renderData.cameraId, renderData.portal_normal};
 
     //     vkCmdPushConstants(cmd, renderData.binded_pipeline->getPipelineLayout(), renderData.binded_pipeline->getPushConstantStage(), 0, sizeof(PushConstantData), &pc);
 
@@ -436,7 +323,7 @@ void SkeletonObj::render(CommandBuffer &cmd, RenderData &renderData) {
     // }
 
     // renderData.basicMeshes->at(Mesh::Cube).bindMesh(cmd);
-    // for (auto &joint : m_joints_final) {
+    // for (auto &joint : m_debug_joints) {
     //     // draw cube as line between joints
     //     glm::mat4 wPoint = joint->wMatrix();
 
@@ -490,16 +377,42 @@ glm::vec3 closestPointToCapsule(glm::vec3 p, glm::vec3 a, glm::vec3 b, float r)
     return q + r * normalize(p - q);
 }
 
-void SkeletonObj::collisionPos(glm::vec3 &pos, glm::vec3 &vitesse) {
-    for (auto &colider : coliders) {
-        float dist = sdCapsule(pos, colider.first, colider.second);
+void SkeletonObj::updateCollider() {
+    m_capsule_tree.update(coliders, 0.19f);
+    m_skeleton_bounds = m_capsule_tree.getBounds();
+}
 
-        if (dist < 0) {
+void SkeletonObj::collisionPos(glm::vec3 &pos, glm::vec3 &vitesse) {
+    m_capsule_tree.query(pos, [&](uint32_t p_capsule) {
+        auto &colider = coliders[p_capsule];
+        if (sdCapsule(pos, colider.first, colider.second) < 0) {
             pos = closestPointToCapsule(pos, colider.first, colider.second, 0.19f);
             vitesse = glm::vec3(0.f);
+        }
+    });
+}
 
-            // vitesse = (closestPointToCapsule(pos, colider.first, colider.second, 0.1f) - pos) * 1000.f;
+void SkeletonObj::collide(std::span<glm::vec3> p_positions, std::span<glm::vec3> p_velocities) {
+    // the whole batch goes down the tree at once, a limb away from every point costs one box test
+    m_capsule_tree.query(std::span<const glm::vec3>(p_positions), [&](uint32_t p_point, uint32_t p_capsule) {
+        auto &colider = coliders[p_capsule];
+        glm::vec3 &pos = p_positions[p_point];
+        if (sdCapsule(pos, colider.first, colider.second) < 0) {
+            pos = closestPointToCapsule(pos, colider.first, colider.second, 0.19f);
+            p_velocities[p_point] = glm::vec3(0.f);
         }
+    });
+}
+
+void SkeletonObj::getGPUColliders(std::vector<ColliderGPU> &p_colliders) const {
+    for (auto &colider : coliders) {
+        ColliderGPU collider;
+        collider.world_matrix = glm::mat4(1.f);
+        collider.inv_world_matrix = glm::mat4(1.f);
+        collider.a = glm::vec4(colider.first, 0.19f);
+        collider.b = glm::vec4(colider.second, 0.f);
+        collider.type = ColliderGPU::CAPSULE;
+        p_colliders.push_back(collider);
     }
 }
 
@@ -547,13 +460,16 @@ void SkeletonObj::updateFromInput(Window *window, float dt) {
         speed = 0.f;
     }
 
-    if (wantedState != state && (!wantTransition || wantedState != nextState) && (kickend || wantedState != State::KICK)) {
+    auto edge = transitions_graph.find({state, wantedState});
+    bool reachable = edge != transitions_graph.end() && !edge->second.empty();
+    if (wantedState != state && reachable && (!wantTransition || wantedState != nextState) &&
+        (kickend || wantedState != State::KICK)) {
         wantTransition = true;
 
         nextState = wantedState;
         bool found = false;
         // find the closest frame to the last frame
-        for (auto &frame : transitions_graph[{state, nextState}]) {
+        for (auto &frame : edge->second) {
             if (frame.frame_1 > lastFrame) {
                 startTransitionFrame = frame.frame_1;
                 nextStateFrameOffset = frame.frame_2;
@@ -562,8 +478,8 @@ void SkeletonObj::updateFromInput(Window *window, float dt) {
             }
         }
         if (!found) {
-            startTransitionFrame = transitions_graph[{state, nextState}][0].frame_1;
-            nextStateFrameOffset = transitions_graph[{state, nextState}][0].frame_2;
+            startTransitionFrame = edge->second[0].frame_1;
+            nextStateFrameOffset = edge->second[0].frame_2;
         }
 
     } else if (state == wantedState) {
@@ -13,6 +13,9 @@
 #include "sceneV2/Icollider.hpp"
 #include "sceneV2/IIndirectRenderable.hpp"
 #include "sceneV2/animatic/skeleton/BVH.h"
+#include "sceneV2/animatic/skeleton/animation_clip.hpp"
+#include "sceneV2/animatic/skeleton/flat_skeleton.hpp"
+#include "sceneV2/collision/capsule_tree.hpp"
 #include "i_input_controller.hpp"
 #include "sceneV2/node.hpp"
 
@@ -38,7 +41,7 @@ class SkeletonObj : public Node, public IAnimatic, public IIndirectRenderable, p
     int getParentId(const int i) const;
 
     //! Renvoie le nombre d'articulation
-    int numberOfJoint() const { return (int)m_joints_1.size(); }
+    int numberOfJoint() const { return (int)m_skeleton.size(); }
 
     //! Positionne ce squelette dans la position n du BVH.
     //! Assez proche de la fonction r�cursive (question 1), mais range la matrice (Transform)
@@ -47,10 +50,20 @@ class SkeletonObj : public Node, public IAnimatic, public IIndirectRenderable, p
     //! l'articulation du p�re vers le monde.
     void setPose(const BVH& bvh, int frameNumber);
 
+    //! Cree (ou supprime) un noeud par articulation, enfants de ce squelette, pour la visualisation de debug.
+    //! Ils sont mis a jour a chaque pas mais ne servent pas aux calculs
+    void setDebugJoints(bool enable);
 
-    void simulation(glm::vec3 gravite, float viscosite, uint32_t tick, float dt, float t, std::vector<std::shared_ptr<ICollider>> &m_collision_objects);
+
+    void simulation(glm::vec3 gravite, float viscosite, uint32_t tick, float dt, float t);
+    //! Les articulations servent de colliders et de points d'attache aux tissus
+    bool isKinematic() const override { return true; }
     void render(CommandBuffer &cmd, RenderData &renderData);
     void collisionPos(glm::vec3 &pos, glm::vec3 &vitesse);
+    void collide(std::span<glm::vec3> p_positions, std::span<glm::vec3> p_velocities) override;
+    void updateCollider();
+    BoundingBox getColliderBounds() const { return m_skeleton_bounds; }
+    void getGPUColliders(std::vector<ColliderGPU> &p_colliders) const;
     void updateFromInput(Window* window, float dt);
     //! Positionne ce squelette entre la position frameNbSrc du BVH Src et la position frameNbDst du bvh Dst
     // void setPoseInterpolation(const BVH& bvhSrc, int frameNbSrc, const BVH& bvhDst, int frameNbDst, float t);
@@ -131,14 +144,25 @@ class SkeletonObj : public Node, public IAnimatic, public IIndirectRenderable, p
     }
    private:
 
-    float computePoseDistance(int frame_1, int frame_2, BVH &bvh_1, BVH &bvh_2);
+    //! Construit transitions_graph a partir des clips, ou le relit depuis p_cache_path si les clips n'ont pas change
+    void initSkeleton(const AnimationClip &clip);
+    void buildTransitionGraph(const std::filesystem::path &p_cache_path);
+    std::string computeClipsHash(const glm::mat4 &p_root) const;
+    bool loadTransitionGraph(const std::filesystem::path &p_path, const std::string &p_hash);
+    void saveTransitionGraph(const std::filesystem::path &p_path, const std::string &p_hash) const;
 
     int lastFrame = 0;
     std::vector<std::pair<glm::vec3, glm::vec3>> coliders;
-    std::vector<std::shared_ptr<Node>> m_joints_1;
-    std::vector<std::shared_ptr<Node>> m_joints_2;
-    std::vector<std::shared_ptr<Node>> m_joints_final;
+    // hierarchie de boites des capsules et boite de tout le squelette, mises a jour par updateCollider
+    CapsuleTree m_capsule_tree;
+    BoundingBox m_skeleton_bounds = BoundingBox::infinite();
+    // hierarchie et transformations monde des articulations, les noeuds ne sont crees que pour le debug
+    FlatSkeleton m_skeleton;
+    std::vector<std::shared_ptr<Node>> m_debug_joints;
     std::map<State, BVH> m_bvh;
+    // m_bvh compiled for the runtime, and the blended pose of the last tick
+    std::map<State, AnimationClip> m_clips;
+    AnimationPose m_pose;
 
     
     // transition between states
@@ -0,0 +1,76 @@
+#include "capsule_tree.hpp"
+
+#include <algorithm>
+
+namespace TTe {
+
+void CapsuleTree::update(const std::vector<Capsule> &p_capsules, float p_radius) {
+    std::vector<BoundingBox> bounds(p_capsules.size());
+    for (size_t i = 0; i < p_capsules.size(); i++) {
+        bounds[i] = BoundingBox::empty();
+        bounds[i].expand(p_capsules[i].first);
+        bounds[i].expand(p_capsules[i].second);
+        bounds[i].pmin -= glm::vec3(p_radius);
+        bounds[i].pmax += glm::vec3(p_radius);
+    }
+
+    if (p_capsules.size() != m_nb_capsule) {
+        m_nb_capsule = p_capsules.size();
+        m_depth = 0;
+        m_nodes.clear();
+        if (m_nb_capsule == 0) return;
+        m_nodes.reserve(2 * m_nb_capsule - 1);
+        std::vector<uint32_t> order(m_nb_capsule);
+        for (uint32_t i = 0; i < m_nb_capsule; i++) order[i] = i;
+        build(order, 0, m_nb_capsule, bounds, 1);
+        return;
+    }
+
+    // children are stored after their parent, the boxes are refitted from the leaves up in a single backward pass
+    for (size_t n = m_nodes.size(); n-- > 0;) {
+        TreeNode &node = m_nodes[n];
+        if (node.leaf) {
+            node.bounds = bounds[node.index];
+        } else {
+            node.bounds = m_nodes[n + 1].bounds;
+            node.bounds.expand(m_nodes[node.index].bounds.pmin);
+            node.bounds.expand(m_nodes[node.index].bounds.pmax);
+        }
+    }
+}
+
+uint32_t CapsuleTree::build(
+    std::vector<uint32_t> &p_order, uint32_t p_begin, uint32_t p_end, const std::vector<BoundingBox> &p_bounds, uint32_t p_depth) {
+    m_depth = std::max(m_depth, p_depth);
+    uint32_t node = m_nodes.size();
+    m_nodes.emplace_back();
+
+    BoundingBox bounds = BoundingBox::empty();
+    BoundingBox centers = BoundingBox::empty();
+    for (uint32_t i = p_begin; i < p_end; i++) {
+        bounds.expand(p_bounds[p_order[i]].pmin);
+        bounds.expand(p_bounds[p_order[i]].pmax);
+        centers.expand((p_bounds[p_order[i]].pmin + p_bounds[p_order[i]].pmax) * 0.5f);
+    }
+    m_nodes[node].bounds = bounds;
+
+    if (p_end - p_begin == 1) {
+        m_nodes[node].leaf = true;
+        m_nodes[node].index = p_order[p_begin];
+        return node;
+    }
+
+    // median split on the longest axis of the capsule centers
+    glm::vec3 extent = centers.pmax - centers.pmin;
+    int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+    uint32_t middle = (p_begin + p_end) / 2;
+    std::nth_element(p_order.begin() + p_begin, p_order.begin() + middle, p_order.begin() + p_end, [&](uint32_t p_a, uint32_t p_b) {
+        return p_bounds[p_a].pmin[axis] + p_bounds[p_a].pmax[axis] < p_bounds[p_b].pmin[axis] + p_bounds[p_b].pmax[axis];
+    });
+
+    build(p_order, p_begin, middle, p_bounds, p_depth + 1);
+    m_nodes[node].index = build(p_order, middle, p_end, p_bounds, p_depth + 1);
+    return node;
+}
+
+}  // namespace TTe
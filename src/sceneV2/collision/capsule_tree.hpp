@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "struct.hpp"
+
+namespace TTe {
+
+// bounding volume hierarchy over the capsules of a collider (the bones of a skeleton). The tree is built once from the
+// first pose, neighbour bones staying neighbours while the character moves, then only its boxes are refitted every tick :
+// a query tests a few boxes to reject the whole character or a limb instead of every capsule
+class CapsuleTree {
+   public:
+    using Capsule = std::pair<glm::vec3, glm::vec3>;
+
+    // builds the tree when the number of capsules changed, otherwise refits its boxes to the new capsule positions
+    void update(const std::vector<Capsule> &p_capsules, float p_radius);
+
+    uint32_t size() const { return m_nb_capsule; }
+    bool empty() const { return m_nodes.empty(); }
+    BoundingBox getBounds() const { return m_nodes.empty() ? BoundingBox::empty() : m_nodes[0].bounds; }
+
+    // p_func(capsule) for every capsule whose box contains p_point
+    template <typename F>
+    void query(const glm::vec3 &p_point, F &&p_func) const {
+        if (m_nodes.empty()) return;
+        uint32_t stack[64];
+        uint32_t stack_size = 0;
+        stack[stack_size++] = 0;
+        while (stack_size > 0) {
+            const TreeNode &node = m_nodes[stack[--stack_size]];
+            if (!node.bounds.contains(p_point)) continue;
+            if (node.leaf) {
+                p_func(node.index);
+            } else {
+                stack[stack_size++] = node.index;
+                stack[stack_size++] = uint32_t(&node - m_nodes.data()) + 1;
+            }
+        }
+    }
+
+    // p_func(point, capsule) for every point of p_points inside the box of a capsule. The points are filtered node after
+    // node, each box is loaded once per batch and the points rejected by a node are never tested against its subtree.
+    // p_func may move the points, the next nodes test their new position
+    template <typename F>
+    void query(std::span<const glm::vec3> p_points, F &&p_func) const {
+        if (m_nodes.empty() || p_points.empty()) return;
+        std::vector<uint32_t> indices(p_points.size());
+        for (uint32_t i = 0; i < indices.size(); i++) indices[i] = i;
+        indices.reserve(p_points.size() * (m_depth + 1));
+        queryNode(0, 0, p_points.size(), p_points, indices, p_func);
+    }
+
+   private:
+    struct TreeNode {
+        BoundingBox bounds;
+        // leaf : capsule, otherwise right child, the left child follows its parent
+        uint32_t index = 0;
+        bool leaf = false;
+    };
+
+    uint32_t build(
+        std::vector<uint32_t> &p_order, uint32_t p_begin, uint32_t p_end, const std::vector<BoundingBox> &p_bounds, uint32_t p_depth);
+
+    // the points of p_indices[p_begin, p_end) inside node p_node are appended to p_indices and passed to its children
+    template <typename F>
+    void queryNode(uint32_t p_node, size_t p_begin, size_t p_end, std::span<const glm::vec3> p_points, std::vector<uint32_t> &p_indices,
+                   F &p_func) const {
+        const TreeNode &node = m_nodes[p_node];
+        size_t begin = p_indices.size();
+        for (size_t i = p_begin; i < p_end; i++) {
+            uint32_t point = p_indices[i];
+            if (node.bounds.contains(p_points[point])) p_indices.push_back(point);
+        }
+        size_t end = p_indices.size();
+
+        if (begin < end) {
+            if (node.leaf) {
+                for (size_t i = begin; i < end; i++) p_func(p_indices[i], node.index);
+            } else {
+                queryNode(p_node + 1, begin, end, p_points, p_indices, p_func);
+                queryNode(node.index, begin, end, p_points, p_indices, p_func);
+            }
+        }
+        p_indices.resize(begin);
+    }
+
+    uint32_t m_nb_capsule = 0;
+    uint32_t m_depth = 0;
+    // depth first order, a parent before its children
+    std::vector<TreeNode> m_nodes;
+};
+
+}  // namespace TTe
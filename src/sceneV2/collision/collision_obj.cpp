@@ -7,9 +7,26 @@
 
 namespace TTe {
 
+void CollisionObject::updateCollider() {
+    m_collider_matrix = this->wMatrix();
+    m_collider_inv_matrix = glm::inverse(m_collider_matrix);
+
+    switch (t) {
+        case plan:
+            m_collider_bounds = BoundingBox::infinite();
+            break;
+        case sphere:
+            m_collider_bounds = BoundingBox{glm::vec3(-1.f), glm::vec3(1.f)}.transform(m_collider_matrix);
+            break;
+        case cube:
+            m_collider_bounds = BoundingBox{glm::vec3(-0.5f), glm::vec3(0.5f)}.transform(m_collider_matrix);
+            break;
+    }
+}
+
 void CollisionObject::collisionPosPlan(glm::vec3 &pos, glm::vec3 &vitesse) {
     // pos to Object space
-    pos = glm::inverse(this->wMatrix()) * glm::vec4(pos, 1);
+    pos = m_collider_inv_matrix * glm::vec4(pos, 1);
 
     // collision
     if (pos.y < 0) {
@@ -17,14 +34,14 @@ void CollisionObject::collisionPosPlan(glm::vec3 &pos, glm::vec3 &vitesse) {
         pos.y = 0.0001;
     }
 
-    pos = this->wMatrix()* glm::vec4(pos, 1);
+    pos = m_collider_matrix * glm::vec4(pos, 1);
 }
 
 
 void CollisionObject::collisionPosSphere(glm::vec3 &pos, glm::vec3 &vitesse) {
     // pos to Object space
     // std::cout << "pos : " << pos.x << " " << pos.y << " " << pos.z << "\n";
-    pos = glm::inverse(this->wMatrix()) * glm::vec4(pos, 1);
+    pos = m_collider_inv_matrix * glm::vec4(pos, 1);
     // std::cout << "pos : " << pos.x << " " << pos.y << " " << pos.z <<  "\n";
     // collision
     if (glm::length(pos) < 1.0) {
@@ -36,13 +53,13 @@ void CollisionObject::collisionPosSphere(glm::vec3 &pos, glm::vec3 &vitesse) {
         vitesse = glm::vec3(0);
     }
     // std::cout << "pos : " << pos.x << " " << pos.y << " " << pos.z <<  "\n";
-    pos = this->wMatrix() * glm::vec4(pos, 1);
+    pos = m_collider_matrix * glm::vec4(pos, 1);
     // std::cout << "pos : " << pos.x << " " << pos.y << " " << pos.z <<  "\n";
 }
 
 void CollisionObject::collisionPosCube(glm::vec3 &pos, glm::vec3 &vitesse){
     
-    pos = glm::inverse(this->wMatrix()) * glm::vec4(pos, 1);
+    pos = m_collider_inv_matrix * glm::vec4(pos, 1);
     glm::vec3 boxMin = glm::vec3(-0.5f); // cube centré à l'origine, taille 2x2x2
     glm::vec3 boxMax = glm::vec3(0.5f);
     
@@ -70,7 +87,7 @@ void CollisionObject::collisionPosCube(glm::vec3 &pos, glm::vec3 &vitesse){
         vitesse = glm::vec3(0);
     }
 
-    pos = this->wMatrix() * glm::vec4(pos, 1);
+    pos = m_collider_matrix * glm::vec4(pos, 1);
 
 }
 
@@ -88,4 +105,37 @@ void CollisionObject::collisionPos(glm::vec3 &pos, glm::vec3 &vitesse) {
     }
 }
 
-}  // namespace TTe
\ No newline at end of file
+void CollisionObject::collide(std::span<glm::vec3> p_positions, std::span<glm::vec3> p_velocities) {
+    // one switch per batch instead of one per point
+    switch (t) {
+        case plan:
+            for (size_t i = 0; i < p_positions.size(); i++) collisionPosPlan(p_positions[i], p_velocities[i]);
+            break;
+        case sphere:
+            for (size_t i = 0; i < p_positions.size(); i++) collisionPosSphere(p_positions[i], p_velocities[i]);
+            break;
+        case cube:
+            for (size_t i = 0; i < p_positions.size(); i++) collisionPosCube(p_positions[i], p_velocities[i]);
+            break;
+    }
+}
+
+void CollisionObject::getGPUColliders(std::vector<ColliderGPU> &p_colliders) const {
+    ColliderGPU collider;
+    collider.world_matrix = m_collider_matrix;
+    collider.inv_world_matrix = m_collider_inv_matrix;
+    switch (t) {
+        case plan:
+            collider.type = ColliderGPU::PLANE;
+            break;
+        case sphere:
+            collider.type = ColliderGPU::SPHERE;
+            break;
+        case cube:
+            collider.type = ColliderGPU::CUBE;
+            break;
+    }
+    p_colliders.push_back(collider);
+}
+
+}  // namespace TTe
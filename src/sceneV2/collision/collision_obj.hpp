@@ -1,6 +1,8 @@
 #pragma once
 
 #include <glm/fwd.hpp>
+#include <glm/glm.hpp>
+#include <span>
 
 
 #include "sceneV2/Icollider.hpp"
@@ -24,9 +26,18 @@ class CollisionObject : public Node, public ICollider {
     
     void collisionPos(glm::vec3 &pos, glm::vec3 &vitesse);
 
+    void updateCollider() override;
+    BoundingBox getColliderBounds() const override { return m_collider_bounds; }
+    void collide(std::span<glm::vec3> p_positions, std::span<glm::vec3> p_velocities) override;
+    void getGPUColliders(std::vector<ColliderGPU> &p_colliders) const override;
 
    private:
     Type t;
+
+    // cached by updateCollider once per tick, the queries only read them
+    glm::mat4 m_collider_matrix{1.f};
+    glm::mat4 m_collider_inv_matrix{1.f};
+    BoundingBox m_collider_bounds = BoundingBox::infinite();
 };
 
 }  // namespace TTe
\ No newline at end of file
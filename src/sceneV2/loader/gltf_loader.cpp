@@ -3,20 +3,26 @@
 #include <cstddef>
 #include <cstdint>
 #include <glm/fwd.hpp>
+#include <glm/gtc/type_ptr.hpp>
 #include <glm/trigonometric.hpp>
 #include <iostream>
 #include <iterator>
 #include <memory>
+#include <set>
+#include <stdexcept>
 #include <vector>
 
 #include "GPU_data/image.hpp"
+#include "jobs/job_system.hpp"
 #include "math/fov.hpp"
 #include "math/quaternion_convertor.hpp"
+#include "sceneV2/animatic/gltfAnimationObj.hpp"
 #include "sceneV2/cameraV2.hpp"
 #include "sceneV2/container.hpp"
 #include "sceneV2/light.hpp"
 #include "sceneV2/mesh.hpp"
 #include "sceneV2/node.hpp"
+#include "sceneV2/renderable/skinnedMeshObj.hpp"
 #include "sceneV2/renderable/staticMeshObj.hpp"
 
 #define CGLTF_IMPLEMENTATION
@@ -91,8 +97,10 @@ void GLTFLoader::loadMesh(cgltf_data* data) {
         Buffer::BufferType::GPU_ONLY);
 
     m_scene->vertex_buffer = Buffer(
-        m_device, sizeof(Vertex), total_vertex_size, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-        Buffer::BufferType::GPU_ONLY);
+        m_device, sizeof(Vertex), total_vertex_size,
+        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, Buffer::BufferType::GPU_ONLY);
+
+    m_mesh_skins.assign(data->meshes_count, {});
 
     std::cout << "Total index size: " << total_index_size << std::endl;
     std::cout << "Total vertex size: " << total_vertex_size << std::endl;
@@ -100,14 +108,16 @@ void GLTFLoader::loadMesh(cgltf_data* data) {
     // measure time
     auto start = std::chrono::high_resolution_clock::now();
     std::mutex addMeshMutex;
-    #pragma omp parallel for schedule(dynamic, 1)
-    for (uint32_t i = 0; i < data->meshes_count; i++) {
+    // one job per mesh, the BVH of each mesh is built by its job
+    JobSystem::parallelFor(0, data->meshes_count, 1, [&](uint32_t i) {
         cgltf_mesh* mesh = &data->meshes[i];
         std::cout << "Mesh name: " << (mesh->name ? mesh->name : "Unnamed") << std::endl;
 
 
         std::vector<Vertex> vertices;
         std::vector<uint32_t> indices;
+        std::vector<SkinVertexGPU> skin;
+        bool skinned = false;
         for (uint32_t j = 0; j < mesh->primitives_count; j++) {
             cgltf_primitive* primitive = &mesh->primitives[j];
 
@@ -124,6 +134,8 @@ void GLTFLoader::loadMesh(cgltf_data* data) {
             std::vector<float> pos_buffer;
             std::vector<float> normal_buffer;
             std::vector<float> uv_buffer;
+            std::vector<uint32_t> joint_buffer;
+            std::vector<float> weight_buffer;
 
             for (uint32_t k = 0; k < primitive->attributes_count; k++) {
                 cgltf_attribute* attribute = &primitive->attributes[k];
@@ -147,6 +159,22 @@ void GLTFLoader::loadMesh(cgltf_data* data) {
                     uv_buffer.resize(cgltf_accessor_unpack_floats(attribute->data, nullptr, 0));
                     cgltf_accessor_unpack_floats(attribute->data, uv_buffer.data(), uv_buffer.size());
                 }
+
+                if (attribute->type == cgltf_attribute_type_joints && attribute->index == 0) {
+                    assert(attribute->data->type == cgltf_type_vec4);
+
+                    joint_buffer.resize(attribute->data->count * 4);
+                    for (cgltf_size v = 0; v < attribute->data->count; v++) {
+                        cgltf_accessor_read_uint(attribute->data, v, &joint_buffer[v * 4], 4);
+                    }
+                }
+
+                if (attribute->type == cgltf_attribute_type_weights && attribute->index == 0) {
+                    assert(attribute->data->type == cgltf_type_vec4);
+
+                    weight_buffer.resize(cgltf_accessor_unpack_floats(attribute->data, nullptr, 0));
+                    cgltf_accessor_unpack_floats(attribute->data, weight_buffer.data(), weight_buffer.size());
+                }
             }
             // Process attributes, indices, etc.
             // This is where you would handle the mesh data
@@ -161,8 +189,21 @@ void GLTFLoader::loadMesh(cgltf_data* data) {
                 }
                 vertex.material_id = material;
                 vertices.push_back(vertex);
+
+                // primitives without skin follow the first joint, weights are normalized as glTF expects
+                SkinVertexGPU skin_vertex{glm::uvec4(0), glm::vec4(1, 0, 0, 0)};
+                if (joint_buffer.size() >= (k + 1) * 4 && weight_buffer.size() >= (k + 1) * 4) {
+                    skin_vertex.joints =
+                        glm::uvec4(joint_buffer[k * 4], joint_buffer[k * 4 + 1], joint_buffer[k * 4 + 2], joint_buffer[k * 4 + 3]);
+                    glm::vec4 weights(weight_buffer[k * 4], weight_buffer[k * 4 + 1], weight_buffer[k * 4 + 2], weight_buffer[k * 4 + 3]);
+                    float sum = weights.x + weights.y + weights.z + weights.w;
+                    if (sum > 0.f) skin_vertex.weights = weights / sum;
+                    skinned = true;
+                }
+                skin.push_back(skin_vertex);
             }
         }
+        if (skinned) m_mesh_skins[i] = std::move(skin);
      
             Mesh m = Mesh(
                 m_device, indices, vertices, global_Indices_Indices[i], global_Vertex_Indices[i], m_scene->index_buffer, m_scene->vertex_buffer);
@@ -172,7 +213,7 @@ void GLTFLoader::loadMesh(cgltf_data* data) {
             m_scene->meshes[i] = std::move(m);
             // m_scene->addStaticMesh(m);
             addMeshMutex.unlock();
-    }
+    });
     m_scene->first_index_available = m_scene->index_buffer.getInstancesCount();
     m_scene->first_vertex_available = m_scene->vertex_buffer.getInstancesCount();
     m_scene->nb_meshes = data->meshes_count;
@@ -217,8 +258,7 @@ void GLTFLoader::loadMaterial(cgltf_data* data) {
 void GLTFLoader::loadTexture(cgltf_data* data) {
     auto start = std::chrono::high_resolution_clock::now();
     m_scene->images.resize(data->images_count);
-    #pragma omp parallel for schedule(dynamic, 1)
-    for (uint32_t i = 0; i < data->images_count; i++) {
+    JobSystem::parallelFor(0, data->images_count, 1, [&](uint32_t i) {
         cgltf_image* image = &data->images[i];
         // std::cout << m_data_path.parent_path() / image->uri << std::endl;
         std::cout << "Image name: " << (image->name ? image->name : "Unnamed") << std::endl;
@@ -251,7 +291,7 @@ void GLTFLoader::loadTexture(cgltf_data* data) {
             stbi_image_free(imageCreateInfo.datas[0]);
         }
         m_scene->images[i] = std::move(imageObj);
-    }
+    });
 
     auto end = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> elapsed = end - start;
@@ -269,15 +309,54 @@ void GLTFLoader::loadNode(cgltf_data* data) {
 
     nodeMap[nullptr] = nullptr;  // Handle the root node case
 
+    // joints and animated nodes without children or mesh are kept, the skinned meshes read their matrices
+    std::set<cgltf_node*> joint_nodes;
+    for (uint32_t i = 0; i < data->skins_count; i++) {
+        joint_nodes.insert(data->skins[i].joints, data->skins[i].joints + data->skins[i].joints_count);
+    }
+    if (data->animations_count > 0) {
+        for (cgltf_size c = 0; c < data->animations[0].channels_count; c++) {
+            if (data->animations[0].channels[c].target_node) joint_nodes.insert(data->animations[0].channels[c].target_node);
+        }
+    }
+    // joints can come after the mesh in the hierarchy, they are bound once every node exists
+    std::vector<std::pair<std::shared_ptr<SkinnedMeshObj>, cgltf_skin*>> skinned_nodes;
+    std::map<uint32_t, Buffer> skin_buffers;
+    std::shared_ptr<ComputePipeline> skinning_pipeline;
+
     while (!nodeStack.empty()) {
         cgltf_node* node = nodeStack.top();
         nodeStack.pop();
         std::shared_ptr<Node> engin_node;
 
-        if (node->children_count > 0 || node->mesh || node->camera || node->light) {
-            if (node->mesh) {
+        if (node->children_count > 0 || node->mesh || node->camera || node->light || joint_nodes.count(node)) {
+            uint32_t mesh_index = node->mesh ? std::distance(data->meshes, node->mesh) : 0;
+            if (node->mesh && node->skin && !m_mesh_skins[mesh_index].empty()) {
+                if (!skinning_pipeline) {
+#ifdef DEFAULT_APP_PATH
+                    skinning_pipeline = std::make_shared<ComputePipeline>(m_device, "shaders/skinning.comp");
+#else
+                    skinning_pipeline = std::make_shared<ComputePipeline>(m_device, "TTengine-2/shaders/skinning.comp");
+#endif
+                }
+                if (!skin_buffers.count(mesh_index)) {
+                    skin_buffers[mesh_index] = SkinnedMeshObj::createSkinBuffer(m_device, m_mesh_skins[mesh_index]);
+                }
+
+                std::vector<glm::mat4> inverse_bind_matrices(node->skin->joints_count, glm::mat4(1.f));
+                if (node->skin->inverse_bind_matrices) {
+                    for (cgltf_size j = 0; j < node->skin->joints_count; j++) {
+                        cgltf_accessor_read_float(node->skin->inverse_bind_matrices, j, glm::value_ptr(inverse_bind_matrices[j]), 16);
+                    }
+                }
+
+                std::shared_ptr<SkinnedMeshObj> mesh_node = std::make_shared<SkinnedMeshObj>(
+                    m_device, &m_scene->meshes[mesh_index], skin_buffers[mesh_index], std::move(inverse_bind_matrices), skinning_pipeline);
+                skinned_nodes.push_back({mesh_node, node->skin});
+                engin_node = mesh_node;
+            } else if (node->mesh) {
                 std::shared_ptr<StaticMeshObj> mesh_node = std::make_shared<StaticMeshObj>();
-                mesh_node->setMesh(&m_scene->meshes[std::distance(data->meshes, node->mesh)]);
+                mesh_node->setMesh(&m_scene->meshes[mesh_index]);
                 engin_node = mesh_node;
             }
 
@@ -332,6 +411,70 @@ void GLTFLoader::loadNode(cgltf_data* data) {
             }
         }
     }
+
+    for (auto& skinned_node : skinned_nodes) {
+        std::vector<std::shared_ptr<Node>> joints;
+        for (cgltf_size j = 0; j < skinned_node.second->joints_count; j++) {
+            auto joint = nodeMap.find(skinned_node.second->joints[j]);
+            if (joint == nodeMap.end()) {
+                throw std::runtime_error("joint " + std::to_string(j) + " of a skin is not in the scene");
+            }
+            joints.push_back(joint->second);
+        }
+        skinned_node.first->setJoints(std::move(joints));
+    }
+
+    loadAnimation(data, nodeMap);
+}
+
+void GLTFLoader::loadAnimation(cgltf_data* data, const std::map<cgltf_node*, std::shared_ptr<Node>>& p_node_map) {
+    if (data->animations_count == 0) return;
+    // the animations of a file usually drive the same nodes (one per clip), only the first one is played
+    if (data->animations_count > 1) {
+        std::cout << data->animations_count << " animations in the file, only the first one is played" << std::endl;
+    }
+    const cgltf_animation& animation = data->animations[0];
+
+    std::shared_ptr<GLTFAnimationObj> animation_node = std::make_shared<GLTFAnimationObj>();
+    for (cgltf_size c = 0; c < animation.channels_count; c++) {
+        const cgltf_animation_channel& channel = animation.channels[c];
+        auto target = p_node_map.find(channel.target_node);
+        // morph target weights are not supported
+        if (target == p_node_map.end() || target->second == nullptr || channel.target_path == cgltf_animation_path_type_weights) {
+            continue;
+        }
+
+        GLTFAnimationObj::Channel engine_channel;
+        engine_channel.target = target->second;
+        if (channel.target_path == cgltf_animation_path_type_translation) {
+            engine_channel.path = GLTFAnimationObj::Path::TRANSLATION;
+        } else if (channel.target_path == cgltf_animation_path_type_rotation) {
+            engine_channel.path = GLTFAnimationObj::Path::ROTATION;
+        } else if (channel.target_path == cgltf_animation_path_type_scale) {
+            engine_channel.path = GLTFAnimationObj::Path::SCALE;
+        } else {
+            continue;
+        }
+        engine_channel.step = channel.sampler->interpolation == cgltf_interpolation_type_step;
+
+        const cgltf_accessor* input = channel.sampler->input;
+        const cgltf_accessor* output = channel.sampler->output;
+        engine_channel.times.resize(input->count);
+        for (cgltf_size k = 0; k < input->count; k++) {
+            cgltf_accessor_read_float(input, k, &engine_channel.times[k], 1);
+        }
+        // a cubic spline stores an in tangent, the value and an out tangent per key : its values are interpolated linearly
+        bool cubic_spline = channel.sampler->interpolation == cgltf_interpolation_type_cubic_spline;
+        cgltf_size nb_component = engine_channel.path == GLTFAnimationObj::Path::ROTATION ? 4 : 3;
+        engine_channel.values.resize(input->count, glm::vec4(0.f));
+        for (cgltf_size k = 0; k < input->count; k++) {
+            cgltf_accessor_read_float(output, cubic_spline ? 3 * k + 1 : k, glm::value_ptr(engine_channel.values[k]), nb_component);
+        }
+        animation_node->addChannel(std::move(engine_channel));
+    }
+
+    animation_node->setName(animation.name ? animation.name : "Animation");
+    m_scene->addNode(-1, animation_node);
 }
 
 }  // namespace TTe
\ No newline at end of file
@@ -1,9 +1,12 @@
 #pragma once
 
 #include <filesystem>
+#include <map>
+#include <memory>
 
 #include "cgltf.h"
 #include "device.hpp"
+#include "sceneV2/render_data.hpp"
 #include "sceneV2/scene.hpp"
 
 namespace TTe {
@@ -18,7 +21,11 @@ class GLTFLoader {
     void loadMaterial(cgltf_data* p_data);
     void loadTexture(cgltf_data* p_data);
     void loadNode(cgltf_data* p_data);
+    // channels of the first animation, played by a GLTFAnimationObj added to the scene
+    void loadAnimation(cgltf_data* p_data, const std::map<cgltf_node*, std::shared_ptr<Node>>& p_node_map);
 
+    // joints and weights of the vertices of each mesh, empty if the mesh is not skinned
+    std::vector<std::vector<SkinVertexGPU>> m_mesh_skins;
     std::vector<bool> m_is_albedo_tex;
     std::filesystem::path m_data_path;
 
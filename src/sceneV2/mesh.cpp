@@ -7,6 +7,7 @@
 #include <glm/geometric.hpp>
 #include <iostream>
 #include <stack>
+#include <stdexcept>
 #include <vector>
 
 #include "GPU_data/buffer.hpp"
@@ -172,6 +173,35 @@ void Mesh::createBVH() {
     // create bvh
 }
 
+// blocks are only geometry, instance range is filled by the scene when batching identical meshes
+std::vector<MeshBlock> Mesh::getMeshBlock(uint32_t p_nb_max_triangle) {
+    std::vector<MeshBlock> return_value;
+    std::stack<uint32_t> bvh_stack;
+    bvh_stack.push(0);
+    while (!bvh_stack.empty()) {
+        uint32_t index = bvh_stack.top();
+        bvh_stack.pop();
+
+        // if leaf
+        if (bvh[index].nb_triangle_to_draw <= p_nb_max_triangle) {
+            MeshBlock mesh_block;
+            mesh_block.indexOffset = getFirstIndex() + bvh[index].indicies_index;
+            mesh_block.vertexOffset = getFirstVertex();
+            mesh_block.indexSize = bvh[index].nb_triangle_to_draw * 3;
+            mesh_block.pmin = bvh[index].bbox.pmin;
+            mesh_block.pmax = bvh[index].bbox.pmax;
+            mesh_block.firstInstance = 0;
+            mesh_block.instanceCount = 0;
+            mesh_block.visibleOffset = 0;
+            return_value.push_back(mesh_block);
+        } else {
+            bvh_stack.push(bvh[index].index);
+            bvh_stack.push(bvh[index].index + 1);
+        }
+    }
+    return return_value;
+}
+
 
 SceneHit Mesh::hit(glm::vec3& p_ro, glm::vec3& p_rd) {
  
@@ -222,8 +252,10 @@ SceneHit Mesh::hit(glm::vec3& p_ro, glm::vec3& p_rd) {
 void Mesh::uploadToGPU(CommandBuffer* p_ext_cmd) {
     if ((m_vertex_buffer == VK_NULL_HANDLE || m_index_buffer == VK_NULL_HANDLE) ||
         (m_vertex_buffer.getInstancesCount() < verticies.size() || m_index_buffer.getInstancesCount() < indicies.size())) {
-        m_vertex_buffer =
-            Buffer(m_device, sizeof(Vertex), verticies.size(), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, m_type);
+        // storage usage so the GPU simulations can write the deformed vertices in place
+        m_vertex_buffer = Buffer(
+            m_device, sizeof(Vertex), verticies.size(),
+            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, m_type);
         m_index_buffer =
             Buffer(m_device, sizeof(uint32_t), indicies.size(), VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, m_type);
     }
@@ -266,6 +298,37 @@ void Mesh::uploadToGPU(CommandBuffer* p_ext_cmd) {
     }
 }
 
+void Mesh::uploadVerticies(const std::vector<Vertex>& p_verticies, CommandBuffer* p_ext_cmd) {
+    if (m_vertex_buffer == VK_NULL_HANDLE || m_vertex_buffer.getInstancesCount() < m_first_vertex + p_verticies.size()) {
+        throw std::runtime_error("vertex buffer too small for the deformed mesh");
+    }
+
+    if (m_type == Buffer::BufferType::DYNAMIC) {
+        m_vertex_buffer.writeToBuffer(p_verticies.data(), p_verticies.size() * sizeof(Vertex), m_first_vertex * sizeof(Vertex));
+    } else {
+        CommandBuffer* cmd_buffer = p_ext_cmd;
+        if (cmd_buffer == nullptr) {
+            cmd_buffer = new CommandBuffer(
+                std::move(CommandPoolHandler::getCommandPool(m_device, m_device->getTransferQueue())->createCommandBuffer(1)[0]));
+            cmd_buffer->beginCommandBuffer();
+        }
+
+        Buffer* staging_vertex_buffer =
+            new Buffer(m_device, sizeof(Vertex), p_verticies.size(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, Buffer::BufferType::STAGING, 0);
+        staging_vertex_buffer->writeToBuffer(p_verticies.data(), p_verticies.size() * sizeof(Vertex));
+        Buffer::copyBuffer(
+            m_device, *staging_vertex_buffer, m_vertex_buffer, cmd_buffer, p_verticies.size() * sizeof(Vertex), 0,
+            m_first_vertex * sizeof(Vertex));
+        cmd_buffer->addRessourceToDestroy(staging_vertex_buffer);
+
+        if (p_ext_cmd == nullptr) {
+            cmd_buffer->endCommandBuffer();
+            cmd_buffer->addRessourceToDestroy(cmd_buffer);
+            cmd_buffer->submitCommandBuffer({}, {}, nullptr, true);
+        }
+    }
+}
+
 void Mesh::bindMesh(CommandBuffer& p_cmd) {
     VkBuffer vbuffers[] = {m_vertex_buffer};
     VkDeviceSize offsets[] = {0};
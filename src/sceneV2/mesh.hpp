@@ -51,6 +51,8 @@ class Mesh {
     void createBVH();
 
     void uploadToGPU(CommandBuffer *p_ext_cmd = nullptr);
+    // only rewrite the vertex range, used for deforming meshes whose topology never changes
+    void uploadVerticies(const std::vector<Vertex> &p_verticies, CommandBuffer *p_ext_cmd = nullptr);
 
     void bindMesh(CommandBuffer &p_cmd);
 
@@ -98,6 +98,14 @@ void Node::setDirty() {
     // }
 }
 
+void Node::resolveWorldMatrices() {
+    wMatrix();
+    wNormalMatrix();
+    for (auto &child : m_children) {
+        child->resolveWorldMatrices();
+    }
+}
+
 
 BoundingBox Node::computeBoundingBox() {
         BoundingBox tmp;
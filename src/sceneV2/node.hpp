@@ -49,6 +49,8 @@ class Node {
     void removeChild(std::shared_ptr<Node> p_child);
 
     void setDirty();
+    // compute the cached matrices of this node and its subtree, they can then be read from several threads
+    void resolveWorldMatrices();
 
     virtual BoundingBox computeBoundingBox();
 
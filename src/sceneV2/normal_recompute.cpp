@@ -0,0 +1,79 @@
+#include "normal_recompute.hpp"
+
+#include <cmath>
+
+#include "jobs/job_system.hpp"
+
+namespace TTe {
+
+NormalRecompute::NormalRecompute(const std::vector<uint32_t> &p_indicies, uint32_t p_nb_vertex, Weighting p_weighting)
+    : m_weighting(p_weighting), m_nb_vertex(p_nb_vertex), m_indicies(p_indicies) {
+    uint32_t nb_corners = (m_indicies.size() / 3) * 3;
+    m_indicies.resize(nb_corners);
+
+    // counting sort of the corners by vertex
+    m_vertex_corner_starts.assign(m_nb_vertex + 1, 0);
+    for (uint32_t c = 0; c < nb_corners; c++) {
+        if (m_indicies[c] < m_nb_vertex) m_vertex_corner_starts[m_indicies[c] + 1]++;
+    }
+    for (uint32_t i = 0; i < m_nb_vertex; i++) m_vertex_corner_starts[i + 1] += m_vertex_corner_starts[i];
+
+    m_vertex_corners.resize(m_vertex_corner_starts.back());
+    std::vector<uint32_t> cursors(m_vertex_corner_starts.begin(), m_vertex_corner_starts.end() - 1);
+    for (uint32_t c = 0; c < nb_corners; c++) {
+        if (m_indicies[c] < m_nb_vertex) m_vertex_corners[cursors[m_indicies[c]]++] = c;
+    }
+
+    m_face_normals.resize(nb_corners / 3);
+}
+
+void NormalRecompute::recompute(std::vector<Vertex> &p_verticies) {
+    if (p_verticies.size() < m_nb_vertex) return;
+
+    // cross product of the edges : its length is twice the triangle area
+    JobSystem::parallelForRange(0, m_face_normals.size(), 1024, [&](uint32_t p_begin, uint32_t p_end) {
+        for (uint32_t t = p_begin; t < p_end; t++) {
+            uint32_t a = m_indicies[3 * t];
+            uint32_t b = m_indicies[3 * t + 1];
+            uint32_t c = m_indicies[3 * t + 2];
+            if (a >= m_nb_vertex || b >= m_nb_vertex || c >= m_nb_vertex) {
+                m_face_normals[t] = glm::vec3(0.f);
+                continue;
+            }
+            m_face_normals[t] = glm::cross(p_verticies[b].pos - p_verticies[a].pos, p_verticies[c].pos - p_verticies[a].pos);
+        }
+    });
+
+    JobSystem::parallelForRange(0, m_nb_vertex, 1024, [&](uint32_t p_begin, uint32_t p_end) {
+        for (uint32_t i = p_begin; i < p_end; i++) {
+            glm::vec3 normal(0.f);
+            for (uint32_t k = m_vertex_corner_starts[i]; k < m_vertex_corner_starts[i + 1]; k++) {
+                uint32_t corner = m_vertex_corners[k];
+                const glm::vec3 &face_normal = m_face_normals[corner / 3];
+
+                if (m_weighting == AREA) {
+                    normal += face_normal;
+                    continue;
+                }
+
+                float face_length = glm::length(face_normal);
+                if (face_length == 0.f) continue;
+
+                uint32_t first = corner - corner % 3;
+                glm::vec3 e1 = p_verticies[m_indicies[first + (corner + 1) % 3]].pos - p_verticies[i].pos;
+                glm::vec3 e2 = p_verticies[m_indicies[first + (corner + 2) % 3]].pos - p_verticies[i].pos;
+                float l1 = glm::length(e1);
+                float l2 = glm::length(e2);
+                if (l1 == 0.f || l2 == 0.f) continue;
+
+                float angle = std::acos(glm::clamp(glm::dot(e1, e2) / (l1 * l2), -1.f, 1.f));
+                normal += face_normal * (angle / face_length);
+            }
+
+            float length = glm::length(normal);
+            if (length > 0.f) p_verticies[i].normal = normal / length;
+        }
+    });
+}
+
+}  // namespace TTe
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "struct.hpp"
+
+namespace TTe {
+
+// smooth vertex normals of a deforming mesh whose topology never changes (cloth, skinned or morphing meshes).
+// The vertex -> triangle adjacency is built once; each update computes the face normals in parallel, then every vertex
+// gathers the normals of its own triangles, so no two threads ever write the same normal
+class NormalRecompute {
+   public:
+    enum Weighting {
+        AREA,   // face normal scaled by the triangle area
+        ANGLE,  // unit face normal scaled by the triangle angle at the vertex
+    };
+
+    NormalRecompute() = default;
+    NormalRecompute(const std::vector<uint32_t> &p_indicies, uint32_t p_nb_vertex, Weighting p_weighting = ANGLE);
+
+    // overwrite the normal of every vertex from the current positions, vertices without a valid triangle keep their normal
+    void recompute(std::vector<Vertex> &p_verticies);
+
+    bool empty() const { return m_nb_vertex == 0; }
+
+   private:
+    Weighting m_weighting = ANGLE;
+    uint32_t m_nb_vertex = 0;
+
+    std::vector<uint32_t> m_indicies;
+
+    // corners of the triangles around vertex i : m_vertex_corners[m_vertex_corner_starts[i] .. m_vertex_corner_starts[i + 1][,
+    // a corner is the position of the vertex in m_indicies (triangle = corner / 3)
+    std::vector<uint32_t> m_vertex_corner_starts;
+    std::vector<uint32_t> m_vertex_corners;
+
+    // area weighted face normals of the last update
+    std::vector<glm::vec3> m_face_normals;
+};
+
+}  // namespace TTe
@@ -21,6 +21,7 @@ struct PushConstantStruct {
     uint64_t mat_buffer;
     uint64_t cam_buffer;
     uint64_t light_buffer;
+    uint64_t instance_buffer;
     uint32_t camid;
     uint32_t nb_light;
 };
@@ -31,6 +32,7 @@ struct ShadowPushConstantStruct {
     uint64_t obj_buffer;
     uint64_t mat_buffer;
     uint64_t cam_buffer;
+    uint64_t instance_buffer;
     uint32_t camid;
 };
 #pragma pack(pop)
@@ -41,14 +43,80 @@ struct PushConstantCullStruct {
     uint64_t obj_buffer;
     uint64_t cam_buffer;
     uint64_t mesh_blocks_buffer;
+    uint64_t instance_buffer;
+    uint64_t visible_instance_buffer;
     uint64_t draw_cmds_buffer;
     uint64_t draw_count_buffer;
+    uint64_t visible_count_buffer;
     uint32_t camid;
     uint32_t numberOfmesh_block;
+    uint32_t numberOfslots;
 };
 #pragma pack(pop)
 
 
+#pragma pack(push, 1)
+struct PushConstantClothStepStruct {
+    uint64_t particles_in_buffer;
+    uint64_t particles_out_buffer;
+    uint64_t springs_buffer;
+    uint64_t spring_starts_buffer;
+    uint64_t colliders_buffer;
+    uint64_t attachments_buffer;
+    glm::vec3 gravity;
+    float damping;
+    glm::vec3 wind;
+    float dt;
+    uint32_t nb_particles;
+    uint32_t nb_colliders;
+    uint32_t nb_attachments;
+};
+#pragma pack(pop)
+
+#pragma pack(push, 1)
+struct PushConstantClothNormalStruct {
+    uint64_t particles_buffer;
+    uint64_t indices_buffer;
+    uint64_t vertex_triangle_starts_buffer;
+    uint64_t vertex_triangles_buffer;
+    uint64_t verticies_buffer;
+    uint32_t nb_vertex;
+};
+#pragma pack(pop)
+
+#pragma pack(push, 1)
+struct PushConstantSkinningStruct {
+    uint64_t verticies_buffer;
+    uint64_t skin_buffer;
+    uint64_t palette_buffer;
+    uint64_t skinned_verticies_buffer;
+    uint32_t nb_vertex;
+};
+#pragma pack(pop)
+
+
+struct ObjectGPU {
+    glm::mat4 world_matrix;
+    glm::mat4 normal_matrix;
+    // deforming meshes : address of their positions and normals for this frame, the vertex shaders read them
+    // instead of the vertex buffer when it is not 0 (index = gl_VertexIndex - dynamic_first_vertex)
+    uint64_t dynamic_verticies = 0;
+    uint32_t dynamic_first_vertex = 0;
+    uint32_t material_offset = 0;
+};
+
+// the only vertex attributes of a deforming mesh that change, streamed every tick (scalar layout in the shaders)
+struct DynamicVertexGPU {
+    glm::vec3 pos;
+    glm::vec3 normal;
+};
+
+// the 4 joints influencing a vertex of a skinned mesh and their weights (glTF JOINTS_0 / WEIGHTS_0)
+struct SkinVertexGPU {
+    glm::uvec4 joints;
+    glm::vec4 weights;
+};
+
 struct LightGPU{
     glm::vec4 color;
     glm::vec3 pos;
@@ -0,0 +1,125 @@
+#include "skinnedMeshObj.hpp"
+
+#include <algorithm>
+
+#include "commandBuffer/commandPool_handler.hpp"
+#include "sceneV2/render_data.hpp"
+
+namespace TTe {
+
+namespace {
+
+// GPU only buffer filled by a staging copy on the transfer queue
+template <typename T>
+Buffer uploadBuffer(Device *p_device, const std::vector<T> &p_data) {
+    Buffer buffer(
+        p_device, sizeof(T), std::max<size_t>(p_data.size(), 1), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        Buffer::BufferType::GPU_ONLY);
+    if (p_data.empty()) return buffer;
+
+    CommandBuffer cmd = std::move(CommandPoolHandler::getCommandPool(p_device, p_device->getTransferQueue())->createCommandBuffer(1)[0]);
+    cmd.beginCommandBuffer();
+    Buffer *staging = new Buffer(p_device, sizeof(T), p_data.size(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, Buffer::BufferType::STAGING, 0);
+    staging->writeToBuffer(const_cast<T *>(p_data.data()), p_data.size() * sizeof(T));
+    Buffer::copyBuffer(p_device, *staging, buffer, &cmd, p_data.size() * sizeof(T));
+    cmd.addRessourceToDestroy(staging);
+    cmd.endCommandBuffer();
+    cmd.submitCommandBuffer({}, {}, nullptr, true);
+    return buffer;
+}
+
+}  // namespace
+
+SkinnedMeshObj::SkinnedMeshObj(
+    Device *p_device,
+    Mesh *p_mesh,
+    Buffer p_skin_buffer,
+    std::vector<glm::mat4> p_inverse_bind_matrices,
+    std::shared_ptr<ComputePipeline> p_skinning_pipeline)
+    : m_device(p_device),
+      m_mesh(p_mesh),
+      m_skin_buffer(p_skin_buffer),
+      m_inverse_bind_matrices(std::move(p_inverse_bind_matrices)),
+      m_skinning_pipeline(p_skinning_pipeline) {
+    std::vector<DynamicVertexGPU> bind_pose(m_mesh->verticies.size());
+    for (size_t i = 0; i < bind_pose.size(); i++) {
+        bind_pose[i] = {m_mesh->verticies[i].pos, m_mesh->verticies[i].normal};
+    }
+    m_skinned_verticies = uploadBuffer(m_device, bind_pose);
+}
+
+Buffer SkinnedMeshObj::createSkinBuffer(Device *p_device, const std::vector<SkinVertexGPU> &p_skin) {
+    return uploadBuffer(p_device, p_skin);
+}
+
+void SkinnedMeshObj::simulation(glm::vec3, float, uint32_t, float, float) {
+    uint32_t nb_joint = std::min(m_joints.size(), m_inverse_bind_matrices.size());
+    if (nb_joint == 0) return;
+
+    // glTF ignores the transform of the skinned node : the palette brings the joints in its space and the vertex shaders apply it
+    glm::mat4 inv_world_matrix = glm::inverse(wMatrix());
+    m_palette.resize(nb_joint);
+    for (uint32_t j = 0; j < nb_joint; j++) {
+        m_palette[j] = inv_world_matrix * m_joints[j]->wMatrix() * m_inverse_bind_matrices[j];
+    }
+
+    // joints that did not move since the last upload cost no dispatch
+    std::lock_guard<std::mutex> lock(m_palette_mutex);
+    if (m_palette == m_palette_to_upload) return;
+    m_palette_to_upload = m_palette;
+    m_palette_dirty = true;
+}
+
+void SkinnedMeshObj::getExternalNodes(std::vector<Node *> &p_nodes) {
+    for (auto &joint : m_joints) p_nodes.push_back(joint.get());
+}
+
+void SkinnedMeshObj::recordGPUSimulation(CommandBuffer &p_cmd, uint32_t p_frame_index) {
+    {
+        std::lock_guard<std::mutex> lock(m_palette_mutex);
+        // the skinned vertices of the last dispatch stay valid while the joints do not move
+        if (!m_palette_dirty || m_palette_to_upload.empty()) return;
+
+        Buffer &palette_buffer = m_palette_buffers[p_frame_index];
+        if (palette_buffer.getInstancesCount() < m_palette_to_upload.size()) {
+            palette_buffer = Buffer(
+                m_device, sizeof(glm::mat4), m_palette_to_upload.size(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, Buffer::BufferType::DYNAMIC);
+        }
+        palette_buffer.writeToBuffer(m_palette_to_upload.data(), m_palette_to_upload.size() * sizeof(glm::mat4));
+        m_palette_dirty = false;
+    }
+
+    // the previous frame reads the skinned vertices in its vertex shaders
+    m_skinned_verticies.addBufferMemoryBarrier(p_cmd, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+    PushConstantSkinningStruct pc;
+    pc.verticies_buffer = m_mesh->getVertexBuffer().getBufferDeviceAddress(m_mesh->getFirstVertex() * sizeof(Vertex));
+    pc.skin_buffer = m_skin_buffer.getBufferDeviceAddress();
+    pc.palette_buffer = m_palette_buffers[p_frame_index].getBufferDeviceAddress();
+    pc.skinned_verticies_buffer = m_skinned_verticies.getBufferDeviceAddress();
+    pc.nb_vertex = m_mesh->nbVerticies();
+
+    m_skinning_pipeline->bindPipeline(p_cmd);
+    vkCmdPushConstants(p_cmd, m_skinning_pipeline->getPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pc), &pc);
+    m_skinning_pipeline->dispatch(p_cmd, pc.nb_vertex, 1, 1);
+
+    m_skinned_verticies.addBufferMemoryBarrier(p_cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT);
+}
+
+uint64_t SkinnedMeshObj::getGPUDynamicVerticies(uint32_t &p_first_vertex) {
+    p_first_vertex = m_mesh->getFirstVertex();
+    return m_skinned_verticies.getBufferDeviceAddress();
+}
+
+std::vector<MeshBlock> SkinnedMeshObj::getMeshBlock(uint32_t p_nb_max_triangle) {
+    std::vector<MeshBlock> blocks = m_mesh->getMeshBlock(p_nb_max_triangle);
+    BoundingBox bbox = m_mesh->getBoundingBox();
+    glm::vec3 margin = (bbox.pmax - bbox.pmin) * s_bounds_margin;
+    for (auto &block : blocks) {
+        block.pmin = bbox.pmin - margin;
+        block.pmax = bbox.pmax + margin;
+    }
+    return blocks;
+}
+
+}  // namespace TTe
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "GPU_data/buffer.hpp"
+#include "sceneV2/IIndirectRenderable.hpp"
+#include "sceneV2/Ianimatic.hpp"
+#include "sceneV2/mesh.hpp"
+#include "sceneV2/node.hpp"
+#include "shader/pipeline/compute_pipeline.hpp"
+#include "utils.hpp"
+
+namespace TTe {
+
+// instance of a glTF skinned mesh. The joint palette is computed from the joint nodes on the update thread, skinning.comp
+// writes the skinned positions and normals in a buffer owned by the instance and the deferred and shadow vertex shaders
+// read them through ObjectGPU::dynamic_verticies : the mesh is shared between instances and never modified
+class SkinnedMeshObj : public IIndirectRenderable, public IAnimatic, public Node {
+   public:
+    SkinnedMeshObj(
+        Device *p_device,
+        Mesh *p_mesh,
+        Buffer p_skin_buffer,
+        std::vector<glm::mat4> p_inverse_bind_matrices,
+        std::shared_ptr<ComputePipeline> p_skinning_pipeline);
+
+    SkinnedMeshObj(const SkinnedMeshObj &) = delete;
+    SkinnedMeshObj &operator=(const SkinnedMeshObj &) = delete;
+
+    // joints and weights of every vertex of a mesh, shared by all its instances
+    static Buffer createSkinBuffer(Device *p_device, const std::vector<SkinVertexGPU> &p_skin);
+
+    // joint nodes in the order of the skin, one per inverse bind matrix
+    void setJoints(std::vector<std::shared_ptr<Node>> p_joints) { m_joints = std::move(p_joints); }
+
+    void simulation(glm::vec3 gravite, float viscosite, uint32_t tick, float dt, float t) override;
+    void getExternalNodes(std::vector<Node *> &p_nodes) override;
+    void recordGPUSimulation(CommandBuffer &p_cmd, uint32_t p_frame_index) override;
+    uint64_t getGPUDynamicVerticies(uint32_t &p_first_vertex) override;
+
+    std::vector<MeshBlock> getMeshBlock(uint32_t p_nb_max_triangle) override;
+    void render(CommandBuffer &, RenderData &) override {}
+
+    // the skinned vertices leave the bind pose boxes of the blocks, they are culled with the mesh box grown by this factor
+    static constexpr float s_bounds_margin = 0.5f;
+
+   private:
+    Device *m_device = nullptr;
+    Mesh *m_mesh = nullptr;
+    Buffer m_skin_buffer;
+    std::vector<glm::mat4> m_inverse_bind_matrices;
+    std::vector<std::shared_ptr<Node>> m_joints;
+    std::shared_ptr<ComputePipeline> m_skinning_pipeline;
+
+    // palette of the last update, copied in the buffer of the frame by the render thread
+    std::vector<glm::mat4> m_palette;
+    std::mutex m_palette_mutex;
+    std::vector<glm::mat4> m_palette_to_upload;
+    bool m_palette_dirty = false;
+    std::array<Buffer, MAX_FRAMES_IN_FLIGHT> m_palette_buffers;
+
+    // positions and normals of the skinned vertices, bind pose until the first dispatch
+    Buffer m_skinned_verticies;
+};
+
+}  // namespace TTe
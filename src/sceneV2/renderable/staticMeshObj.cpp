@@ -79,34 +79,7 @@ void matrixTOPminAndPmax(glm::vec3& p_pmin, glm::vec3& p_pmax, glm::mat4 p_matri
     }
 }
 
-std::vector<MeshBlock> StaticMeshObj::getMeshBlock(uint32_t p_nb_max_triangle) {
-    std::vector<MeshBlock> returnValue;
-    std::stack<uint32_t> bvh_stack;
-    bvh_stack.push(0);
-    while (!bvh_stack.empty()) {
-        uint32_t index = bvh_stack.top();
-        bvh_stack.pop();
-
-        // if leaf
-        if (m_mesh->bvh[index].nb_triangle_to_draw <= p_nb_max_triangle) {
-            glm::vec3 pmin = m_mesh->bvh[index].bbox.pmin;
-            glm::vec3 pmax = m_mesh->bvh[index].bbox.pmax;
-            MeshBlock mesh_block;
-
-            mesh_block.indexOffset = m_mesh->getFirstIndex() + m_mesh->bvh[index].indicies_index;
-            mesh_block.vertexOffset = m_mesh->getFirstVertex();
-            mesh_block.indexSize = m_mesh->bvh[index].nb_triangle_to_draw * 3;
-            mesh_block.pmin = pmin;
-            mesh_block.pmax = pmax;
-            mesh_block.instancesID = this->m_id;
-            returnValue.push_back(mesh_block);
-        } else {
-            bvh_stack.push(m_mesh->bvh[index].index);
-            bvh_stack.push(m_mesh->bvh[index].index + 1);
-        }
-    }
-    return returnValue;
-}
+std::vector<MeshBlock> StaticMeshObj::getMeshBlock(uint32_t p_nb_max_triangle) { return m_mesh->getMeshBlock(p_nb_max_triangle); }
 
 void StaticMeshObj::render(CommandBuffer& p_cmd, RenderData& p_render_data) {
     glm::mat4 IVP_matrix =
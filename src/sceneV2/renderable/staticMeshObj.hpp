@@ -43,6 +43,7 @@ class StaticMeshObj : public IIndirectRenderable, public Node {
     
     
     virtual std::vector<MeshBlock> getMeshBlock(uint32_t p_nb_max_triangle) override;
+    virtual Mesh *getInstancedMesh() override { return m_mesh; }
 
     // overide hit and compute bounding box
     virtual BoundingBox computeBoundingBox() override;
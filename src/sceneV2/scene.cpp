@@ -4,14 +4,21 @@
 #include <GLFW/glfw3.h>
 #include <vulkan/vulkan_core.h>
 
+#include <algorithm>
 #include <array>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <glm/fwd.hpp>
 #include <glm/geometric.hpp>
 #include <glm/gtc/matrix_access.hpp>
+#include <glm/gtc/matrix_inverse.hpp>
+#include <glm/gtc/quaternion.hpp>
 #include <glm/matrix.hpp>
+#include <map>
 #include <memory>
+#include <stdexcept>
 #include <vector>
 
 #include "GPU_data/buffer.hpp"
@@ -20,6 +27,7 @@
 #include "descriptor/descriptorSet.hpp"
 #include "device.hpp"
 #include "dynamic_renderpass.hpp"
+#include "jobs/job_system.hpp"
 #include "sceneV2/IIndirectRenderable.hpp"
 #include "sceneV2/IRenderable.hpp"
 #include "sceneV2/Icollider.hpp"
@@ -80,35 +88,33 @@ void Scene::initSceneData(
     if (m_main_camera == nullptr) {
         addNode(-1, std::make_shared<CameraV2>());
     }
+    if (m_light_objects.size() == 0) {
+        Light l;
+        l.color = glm::vec3(0);
+        l.intensity = 0;
+        l.m_type = Light::POINT;
+        addNode(-1, std::make_shared<Light>(l));
+    }
     createDrawIndirectBuffers();
+    commitSnapshot();
+    acquireSnapshot();
     updateCameraBuffer();
-    updateObjectBuffer();
     updateMaterialBuffer();
-    updateLightBuffer();
     updateDescriptorSets();
     updateRenderPassDescriptorSets();
 }
 
+void Scene::simulateGPU(CommandBuffer& p_cmd, RenderData& p_render_data) {
+    for (auto& animatic_obj : m_animatic_objs) {
+        animatic_obj->recordGPUSimulation(p_cmd, p_render_data.frame_index);
+    }
+}
+
 void Scene::renderDeffered(CommandBuffer& p_cmd, RenderData& p_render_data) {
     p_render_data.basic_meshes = m_basic_meshes;
     p_render_data.cameras = &m_cameras;
 
-    uint32_t draw_count_init = 0;
-    m_count_indirect_buffers[m_main_camera_id][p_render_data.frame_index].writeToBuffer(&draw_count_init, sizeof(uint32_t), 0);
-    PushConstantCullStruct pc_cull;
-    pc_cull.cam_buffer = camera_buffer[p_render_data.frame_index].getBufferDeviceAddress();
-    pc_cull.obj_buffer = m_object_buffer.getBufferDeviceAddress();
-    pc_cull.mesh_blocks_buffer = m_mesh_block_buffer.getBufferDeviceAddress();
-    pc_cull.draw_cmds_buffer = m_draw_indirect_buffers[m_main_camera_id][p_render_data.frame_index].getBufferDeviceAddress();
-    pc_cull.draw_count_buffer = m_count_indirect_buffers[m_main_camera_id][p_render_data.frame_index].getBufferDeviceAddress();
-    pc_cull.camid = m_main_camera_id;
-    pc_cull.numberOfmesh_block = m_total_mesh_block;
-
-    m_cull_pipeline.bindPipeline(p_cmd);
-    vkCmdPushConstants(p_cmd, m_cull_pipeline.getPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pc_cull), &pc_cull);
-
-    m_cull_pipeline.dispatch(p_cmd, m_total_mesh_block, 1, 1);
-    m_draw_indirect_buffers[m_main_camera_id][p_render_data.frame_index].addBufferMemoryBarrier(p_cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT);
+    cullInstances(p_cmd, m_main_camera_id, p_render_data.frame_index);
 
     m_deffered_renderpass->beginRenderPass(p_cmd, p_render_data.swapchain_index);
 
@@ -121,12 +127,13 @@ void Scene::renderDeffered(CommandBuffer& p_cmd, RenderData& p_render_data) {
     p_render_data.render_pass->setDepthAndStencil(p_cmd, false);
 
     PushConstantStruct tp{
-        m_object_buffer.getBufferDeviceAddress(),
+        m_object_buffer[p_render_data.frame_index].getBufferDeviceAddress(),
         material_buffer.getBufferDeviceAddress(),
         camera_buffer[p_render_data.frame_index].getBufferDeviceAddress(),
-        m_light_buffer.getBufferDeviceAddress(),
+        m_light_buffer[p_render_data.frame_index].getBufferDeviceAddress(),
+        m_visible_instance_buffers[m_main_camera_id][p_render_data.frame_index].getBufferDeviceAddress(),
         m_main_camera_id,
-        static_cast<uint32_t>(m_light_objects.size())};
+        static_cast<uint32_t>(m_snapshots.front().lights.size())};
     p_render_data.push_constant = tp;
     // // set push_constant for cam_id
     vkCmdPushConstants(
@@ -151,7 +158,8 @@ void Scene::renderDeffered(CommandBuffer& p_cmd, RenderData& p_render_data) {
     // renderData.descriptorSets.push(scene_descriptor_set);
 
     vkCmdDrawIndexedIndirectCount(
-        p_cmd, m_draw_indirect_buffers[m_main_camera_id][p_render_data.frame_index], 0, m_count_indirect_buffers[m_main_camera_id][p_render_data.frame_index], 0, 100000,
+        p_cmd, m_draw_indirect_buffers[m_main_camera_id][p_render_data.frame_index], 0, m_count_indirect_buffers[m_main_camera_id][p_render_data.frame_index], 0,
+        m_total_mesh_block,
         sizeof(VkDrawIndexedIndirectCommand));
 
     for (auto& renderable : m_renderables) {
@@ -166,17 +174,26 @@ void Scene::renderShading(CommandBuffer& p_cmd, RenderData& p_renderData) {
     m_deffered_renderpass->transitionAttachment(p_renderData.swapchain_index, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, p_cmd);
     m_shadow_renderpass.transitionDepthAttachment(p_renderData.frame_index, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, p_cmd);
     m_shading_renderpass->transitionColorAttachment(p_renderData.swapchain_index, VK_IMAGE_LAYOUT_GENERAL, p_cmd);
-    m_shading_pipeline.bindPipeline(p_cmd);
+
+    // the light types absent from the scene are compiled out of the shading
+    bool directional = false;
+    bool point = false;
+    for (const LightGPU& light : m_snapshots.front().lights) {
+        directional |= light.Type == 0;
+        point |= light.Type == 1;
+    }
+    m_shading_pipeline.bindPipeline(p_cmd, m_shading_variants[directional][point]);
 
     std::vector<DescriptorSet*> descriptor_sets = {&m_deferred_descriptor_set[p_renderData.swapchain_index], &shadow_descriptor_sets[p_renderData.frame_index]};
     DescriptorSet::bindDescriptorSet(p_cmd, descriptor_sets, m_shading_pipeline.getPipelineLayout(), VK_PIPELINE_BIND_POINT_COMPUTE);
     PushConstantStruct tp{
-        m_object_buffer.getBufferDeviceAddress(),
+        m_object_buffer[p_renderData.frame_index].getBufferDeviceAddress(),
         material_buffer.getBufferDeviceAddress(),
         camera_buffer[p_renderData.frame_index].getBufferDeviceAddress(),
-        m_light_buffer.getBufferDeviceAddress(),
+        m_light_buffer[p_renderData.frame_index].getBufferDeviceAddress(),
+        m_visible_instance_buffers[m_main_camera_id][p_renderData.frame_index].getBufferDeviceAddress(),
         m_main_camera_id,
-        static_cast<uint32_t>(m_light_objects.size())};
+        static_cast<uint32_t>(m_snapshots.front().lights.size())};
     p_renderData.push_constant = tp;
     // // set push_constant for cam_id
     vkCmdPushConstants(
@@ -206,26 +223,10 @@ void Scene::renderShadowMaps(CommandBuffer& p_cmd, RenderData& p_render_data) {
     for (size_t i = 0; i < m_light_objects.size(); i++) {
         auto light = m_light_objects[i];
         if (!light->shadows_enabled) continue;
+        // light matrices were computed with the snapshot and are already in the camera buffer of this frame
         p_render_data.camera_id = light->cam_id;
-        light->updateMatrixFromPos(m_main_camera->transform.pos.value);
-        updateCameraBuffer(p_render_data.frame_index);
-
-        uint32_t draw_count_init = 0;
-        m_count_indirect_buffers[light->cam_id][p_render_data.frame_index].writeToBuffer(&draw_count_init, sizeof(uint32_t), 0);
-        PushConstantCullStruct pc_cull;
-        pc_cull.cam_buffer = camera_buffer[p_render_data.frame_index].getBufferDeviceAddress();
-        pc_cull.obj_buffer = m_object_buffer.getBufferDeviceAddress();
-        pc_cull.mesh_blocks_buffer = m_mesh_block_buffer.getBufferDeviceAddress();
-        pc_cull.draw_cmds_buffer = m_draw_indirect_buffers[light->cam_id][p_render_data.frame_index].getBufferDeviceAddress();
-        pc_cull.draw_count_buffer = m_count_indirect_buffers[light->cam_id][p_render_data.frame_index].getBufferDeviceAddress();
-        pc_cull.camid = light->cam_id;
-        pc_cull.numberOfmesh_block = m_total_mesh_block;
-
-        m_cull_pipeline.bindPipeline(p_cmd);
-        vkCmdPushConstants(p_cmd, m_cull_pipeline.getPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pc_cull), &pc_cull);
-
-        m_cull_pipeline.dispatch(p_cmd, m_total_mesh_block, 1, 1);
-        m_mesh_block_buffer.addBufferMemoryBarrier(p_cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT);
+
+        cullInstances(p_cmd, light->cam_id, p_render_data.frame_index);
 
         m_shadow_renderpass.beginRenderPass(p_cmd, p_render_data.frame_index);
 
@@ -234,10 +235,10 @@ void Scene::renderShadowMaps(CommandBuffer& p_cmd, RenderData& p_render_data) {
         DescriptorSet::bindDescriptorSet(p_cmd, descriptor_sets, m_shadow_pipeline.getPipelineLayout(), VK_PIPELINE_BIND_POINT_GRAPHICS);
 
         ShadowPushConstantStruct tp{
-            m_object_buffer.getBufferDeviceAddress(),
+            m_object_buffer[p_render_data.frame_index].getBufferDeviceAddress(),
             material_buffer.getBufferDeviceAddress(),
             camera_buffer[p_render_data.frame_index].getBufferDeviceAddress(),
-    
+            m_visible_instance_buffers[light->cam_id][p_render_data.frame_index].getBufferDeviceAddress(),
             light->cam_id};
         // p_render_data.push_constant = tp;
         // // set push_constant for cam_id
@@ -246,7 +247,7 @@ void Scene::renderShadowMaps(CommandBuffer& p_cmd, RenderData& p_render_data) {
 
         vkCmdDrawIndexedIndirectCount(
             p_cmd, m_draw_indirect_buffers[light->cam_id][p_render_data.frame_index], 0, m_count_indirect_buffers[light->cam_id][p_render_data.frame_index], 0,
-            100000, sizeof(VkDrawIndexedIndirectCommand));
+            m_total_mesh_block, sizeof(VkDrawIndexedIndirectCommand));
 
         // for (auto& renderable : m_renderables) {
         //     renderable->render(p_cmd, p_render_data);
@@ -256,6 +257,57 @@ void Scene::renderShadowMaps(CommandBuffer& p_cmd, RenderData& p_render_data) {
     }
 }
 
+void Scene::cullInstances(CommandBuffer& p_cmd, uint32_t p_camera_id, uint32_t p_frame_index) {
+    // the buffers of a frame are only used by that frame, they grow with the scene once its fence is signaled
+    Buffer& draw_buffer = m_draw_indirect_buffers[p_camera_id][p_frame_index];
+    Buffer& count_buffer = m_count_indirect_buffers[p_camera_id][p_frame_index];
+    Buffer& visible_count_buffer = m_visible_count_buffers[p_camera_id][p_frame_index];
+    Buffer& visible_instance_buffer = m_visible_instance_buffers[p_camera_id][p_frame_index];
+    if (draw_buffer.getInstancesCount() < std::max<uint32_t>(m_total_mesh_block, 1)) {
+        draw_buffer = Buffer(
+            m_device, sizeof(VkDrawIndexedIndirectCommand), std::max<uint32_t>(m_total_mesh_block * 2, 64),
+            VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, Buffer::BufferType::GPU_ONLY);
+        visible_count_buffer = Buffer(
+            m_device, sizeof(uint32_t), std::max<uint32_t>(m_total_mesh_block * 2, 64), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            Buffer::BufferType::DYNAMIC);
+    }
+    if (visible_instance_buffer.getInstancesCount() < std::max<uint32_t>(m_total_visible_slot, 1)) {
+        visible_instance_buffer = Buffer(
+            m_device, sizeof(uint32_t), std::max<uint32_t>(m_total_visible_slot * 2, 1024),
+            VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, Buffer::BufferType::GPU_ONLY);
+    }
+
+    uint32_t draw_count_init = 0;
+    count_buffer.writeToBuffer(&draw_count_init, sizeof(uint32_t), 0);
+    std::memset(visible_count_buffer.mapMemory(), 0, sizeof(uint32_t) * m_total_mesh_block);
+
+    PushConstantCullStruct pc_cull;
+    pc_cull.cam_buffer = camera_buffer[p_frame_index].getBufferDeviceAddress();
+    pc_cull.obj_buffer = m_object_buffer[p_frame_index].getBufferDeviceAddress();
+    pc_cull.mesh_blocks_buffer = m_mesh_block_buffer.getBufferDeviceAddress();
+    pc_cull.instance_buffer = m_instance_buffer.getBufferDeviceAddress();
+    pc_cull.visible_instance_buffer = visible_instance_buffer.getBufferDeviceAddress();
+    pc_cull.draw_cmds_buffer = draw_buffer.getBufferDeviceAddress();
+    pc_cull.draw_count_buffer = count_buffer.getBufferDeviceAddress();
+    pc_cull.visible_count_buffer = visible_count_buffer.getBufferDeviceAddress();
+    pc_cull.camid = p_camera_id;
+    pc_cull.numberOfmesh_block = m_total_mesh_block;
+    pc_cull.numberOfslots = m_total_visible_slot;
+
+    // one invocation per instance slot, then one per block to compact the draws of the blocks with visible instances
+    m_cull_pipeline.bindPipeline(p_cmd);
+    vkCmdPushConstants(p_cmd, m_cull_pipeline.getPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pc_cull), &pc_cull);
+    m_cull_pipeline.dispatch(p_cmd, m_total_visible_slot, 1, 1);
+    visible_count_buffer.addBufferMemoryBarrier(p_cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+    m_cull_pipeline.bindPipeline(p_cmd, m_cull_compact_variant);
+    vkCmdPushConstants(p_cmd, m_cull_pipeline.getPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pc_cull), &pc_cull);
+    m_cull_pipeline.dispatch(p_cmd, m_total_mesh_block, 1, 1);
+    draw_buffer.addBufferMemoryBarrier(p_cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT);
+    count_buffer.addBufferMemoryBarrier(p_cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT);
+    visible_instance_buffer.addBufferMemoryBarrier(p_cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT);
+}
+
 uint32_t Scene::getNewID() {
     if (!m_free_ids.empty()) {
         uint32_t id = m_free_ids.back();
@@ -271,6 +323,7 @@ uint32_t Scene::addNode(uint32_t p_parent_id, std::shared_ptr<Node> p_node) {
     }
     if (dynamic_cast<IIndirectRenderable*>(p_node.get())) {
         m_indirect_renderables.push_back(std::dynamic_pointer_cast<IIndirectRenderable>(p_node));
+        m_mesh_blocks_dirty = true;
     }
 
     if (dynamic_cast<CameraV2*>(p_node.get())) {
@@ -290,7 +343,13 @@ uint32_t Scene::addNode(uint32_t p_parent_id, std::shared_ptr<Node> p_node) {
     }
 
     if (dynamic_cast<IAnimatic*>(p_node.get())) {
-        m_animatic_objs.push_back(std::dynamic_pointer_cast<IAnimatic>(p_node));
+        auto animatic_obj = std::dynamic_pointer_cast<IAnimatic>(p_node);
+        if (animatic_obj->isKinematic()) {
+            m_animatic_objs.insert(m_animatic_objs.begin() + m_nb_kinematic_objs, animatic_obj);
+            m_nb_kinematic_objs++;
+        } else {
+            m_animatic_objs.push_back(animatic_obj);
+        }
     }
 
     if (dynamic_cast<ICollider*>(p_node.get())) {
@@ -335,7 +394,8 @@ void Scene::addStaticMesh(Mesh& p_mesh) {
         need_GPU_upload = true;
         vertex_buffer = Buffer(
             m_device, sizeof(Vertex), (p_mesh.verticies.size() + vertex_buffer.getInstancesCount()) * 1.5,
-            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, Buffer::BufferType::GPU_ONLY);
+            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            Buffer::BufferType::GPU_ONLY);
     }
 
     if (need_GPU_upload) {
@@ -362,27 +422,53 @@ uint32_t Scene::addImage(Image& p_image) {
 }
 
 void Scene::createDrawIndirectBuffers() {
-    for (size_t i = 0; i < m_cameras.size(); i++) {
-        std::array<Buffer, MAX_FRAMES_IN_FLIGHT> draw_buffers;
+    // sized for the current blocks by cullInstances, the first frames create them
+    for (size_t i = m_draw_indirect_buffers.size(); i < m_cameras.size(); i++) {
         std::array<Buffer, MAX_FRAMES_IN_FLIGHT> count_buffers;
         for (int j = 0; j < MAX_FRAMES_IN_FLIGHT; j++) {
-            draw_buffers[j] = Buffer(
-                m_device, sizeof(VkDrawIndexedIndirectCommand), 300000,
-                VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, Buffer::BufferType::GPU_ONLY);
-
             count_buffers[j] = Buffer(
                 m_device, sizeof(uint32_t), 1, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
                 Buffer::BufferType::DYNAMIC);
         }
-        m_draw_indirect_buffers.push_back(draw_buffers);
+        m_draw_indirect_buffers.push_back({});
         m_count_indirect_buffers.push_back(count_buffers);
+        m_visible_count_buffers.push_back({});
+        m_visible_instance_buffers.push_back({});
     }
 }
 
 void Scene::updateSim(float p_dt, float p_t, uint32_t p_tick) {
-    for (auto& animatic_obj : m_animatic_objs) {
-        animatic_obj->simulation(glm::vec3(0, -9.81, 0), 0.995, p_tick, p_dt, p_t, m_collision_objects);
-    }
+    // the matrices of the nodes are computed lazily, resolve them before each parallel step so the jobs only read them
+    std::vector<Node*> external_nodes;
+    auto resolve_world_matrices = [&]() {
+        for (auto& animatic_obj : m_animatic_objs) {
+            if (Node* node = dynamic_cast<Node*>(animatic_obj.get())) node->resolveWorldMatrices();
+            external_nodes.clear();
+            animatic_obj->getExternalNodes(external_nodes);
+            for (Node* node : external_nodes) node->wMatrix();
+        }
+        for (auto& collision_obj : m_collision_objects) {
+            if (Node* node = dynamic_cast<Node*>(collision_obj.get())) node->resolveWorldMatrices();
+        }
+    };
+    const uint32_t nb_animatic_objs = m_animatic_objs.size();
+
+    // kinematic objects move the colliders and the nodes the simulated objects are attached to
+    resolve_world_matrices();
+    JobSystem::parallelFor(0, m_nb_kinematic_objs, 1, [&](uint32_t i) {
+        m_animatic_objs[i]->simulation(m_gravity, m_visco, p_tick, p_dt, p_t);
+    });
+
+    resolve_world_matrices();
+    JobSystem::parallelFor(0, m_collision_objects.size(), 1, [&](uint32_t i) { m_collision_objects[i]->updateCollider(); });
+
+    JobSystem::parallelFor(m_nb_kinematic_objs, nb_animatic_objs, 1, [&](uint32_t i) {
+        m_animatic_objs[i]->simulation(m_gravity, m_visco, p_tick, p_dt, p_t);
+    });
+
+    JobSystem::parallelFor(0, nb_animatic_objs, 1, [&](uint32_t i) { m_animatic_objs[i]->collision(m_collision_objects); });
+
+    JobSystem::parallelFor(0, nb_animatic_objs, 1, [&](uint32_t i) { m_animatic_objs[i]->updateDeformedMesh(); });
 }
 
 void Scene::updateFromInput(Window* p_window, float p_dt) {
@@ -391,96 +477,311 @@ void Scene::updateFromInput(Window* p_window, float p_dt) {
     }
 }
 
+void Scene::commitSnapshot(float p_tick_duration) {
+    SceneSnapshot& snapshot = m_snapshots.back();
+
+    // state of the last commit becomes the previous state, new entries start without motion
+    snapshot.previous_objects = m_object_data;
+    snapshot.previous_lights = m_light_data;
+    snapshot.previous_cameras = m_camera_data;
+
+    // lights first, the object loop below clears the flag for every node
+    m_light_data.resize(m_light_objects.size());
+    for (size_t i = 0; i < m_light_objects.size(); i++) {
+        auto& light = m_light_objects[i];
+        if (!light->uploaded_to_GPU) {
+            LightGPU& l = m_light_data[i];
+            l.color = glm::vec4(light->color, light->intensity);
+            l.pos = light->wMatrix() * glm::vec4(0, 0, 0, 1);
+            l.orientation = light->getParent()->wNormalMatrix() * light->transform.rot.value;
+            l.Type = light->m_type;
+        }
+        if (light->shadows_enabled) {
+            light->updateMatrixFromPos(m_main_camera->transform.pos.value);
+        }
+    }
+
+    for (auto& obj : m_objects) {
+        if (m_object_data.size() <= obj.first) {
+            m_object_data.resize(obj.first + 1);
+        }
+        if (!obj.second->uploaded_to_GPU) {
+            m_object_data[obj.first].world_matrix = obj.second->wMatrix();
+            m_object_data[obj.first].normal_matrix = obj.second->wNormalMatrix();
+            m_object_data[obj.first].material_offset = 0;
+            obj.second->uploaded_to_GPU = true;
+        }
+    }
+    for (auto& animatic_obj : m_animatic_objs) {
+        Node* node = dynamic_cast<Node*>(animatic_obj.get());
+        uint32_t first_vertex = 0;
+        uint64_t address = animatic_obj->getGPUDynamicVerticies(first_vertex);
+        if (!node || address == 0) continue;
+        m_object_data[node->getId()].dynamic_verticies = address;
+        m_object_data[node->getId()].dynamic_first_vertex = first_vertex;
+    }
+
+    if (m_mesh_blocks_dirty) {
+        buildMeshBlocks();
+        m_mesh_blocks_dirty = false;
+        m_mesh_blocks_version++;
+    }
+
+    m_camera_data.resize(m_cameras.size());
+    for (size_t i = 0; i < m_cameras.size(); i++) {
+        m_camera_data[i].projection = m_cameras[i]->getProjectionMatrix();
+        m_camera_data[i].view = m_cameras[i]->getViewMatrix();
+        m_camera_data[i].invView = glm::inverse(m_camera_data[i].view);
+    }
+
+    snapshot.objects = m_object_data;
+    snapshot.lights = m_light_data;
+    snapshot.cameras = m_camera_data;
+    snapshot.previous_objects.insert(
+        snapshot.previous_objects.end(), m_object_data.begin() + std::min(snapshot.previous_objects.size(), m_object_data.size()),
+        m_object_data.end());
+    snapshot.previous_lights.insert(
+        snapshot.previous_lights.end(), m_light_data.begin() + std::min(snapshot.previous_lights.size(), m_light_data.size()),
+        m_light_data.end());
+    snapshot.previous_cameras.insert(
+        snapshot.previous_cameras.end(), m_camera_data.begin() + std::min(snapshot.previous_cameras.size(), m_camera_data.size()),
+        m_camera_data.end());
+
+    // only positions and normals of the deformed meshes, uv and materials stay in the scene vertex buffer
+    size_t nb_dynamic = 0;
+    for (auto& animatic_obj : m_animatic_objs) {
+        Mesh* mesh = animatic_obj->getDynamicMesh();
+        Node* node = dynamic_cast<Node*>(animatic_obj.get());
+        if (!mesh || !node || mesh->verticies.empty()) continue;
+        if (snapshot.dynamic_verticies.size() <= nb_dynamic) {
+            snapshot.dynamic_verticies.resize(nb_dynamic + 1);
+        }
+        SceneSnapshot::DynamicVerticies& dynamic_mesh = snapshot.dynamic_verticies[nb_dynamic];
+        dynamic_mesh.object_id = static_cast<uint32_t>(node->getId());
+        dynamic_mesh.first_vertex = mesh->getFirstVertex();
+        dynamic_mesh.verticies.resize(mesh->verticies.size());
+        for (size_t i = 0; i < mesh->verticies.size(); i++) {
+            dynamic_mesh.verticies[i] = {mesh->verticies[i].pos, mesh->verticies[i].normal};
+        }
+        nb_dynamic++;
+    }
+    snapshot.dynamic_verticies.resize(nb_dynamic);
+
+    if (snapshot.mesh_blocks_version != m_mesh_blocks_version) {
+        snapshot.mesh_blocks = m_mesh_blocks;
+        snapshot.instance_ids = m_instance_ids;
+        snapshot.total_instance_slot = m_total_instance_slot;
+        snapshot.mesh_blocks_version = m_mesh_blocks_version;
+    }
+
+    snapshot.commit_time = std::chrono::steady_clock::now();
+    snapshot.tick_duration = p_tick_duration;
+    snapshot.version = ++m_snapshot_version;
+    m_snapshots.publish();
+}
+
+bool Scene::acquireSnapshot(uint32_t p_frame_index) {
+    bool new_snapshot = m_snapshots.acquire();
+
+    // matrices are interpolated every frame, vertices are only copied in the regions of this frame older than the snapshot
+    updateDynamicVerticies(p_frame_index);
+    updateObjectBuffer(p_frame_index);
+    updateLightBuffer(p_frame_index);
+    return new_snapshot;
+}
+
+float Scene::getInterpolationAlpha() const {
+    const SceneSnapshot& snapshot = m_snapshots.front();
+    if (snapshot.tick_duration <= 0.f) return 1.f;
+    float elapsed = std::chrono::duration<float>(std::chrono::steady_clock::now() - snapshot.commit_time).count();
+    return glm::clamp(elapsed / snapshot.tick_duration, 0.f, 1.f);
+}
+
+// linear blend of the matrices, only for the projections
+template <typename T>
+static T lerpMatrix(const T& p_a, const T& p_b, float p_alpha) {
+    return p_a + (p_b - p_a) * p_alpha;
+}
+
+// splits an affine matrix in translation, rotation and scale. Returns false for a degenerated matrix
+static bool decomposeTransform(const glm::mat4& p_matrix, glm::vec3& p_translation, glm::quat& p_rotation, glm::vec3& p_scale) {
+    glm::mat3 basis(p_matrix);
+    p_scale = glm::vec3(glm::length(basis[0]), glm::length(basis[1]), glm::length(basis[2]));
+    if (p_scale.x < 1e-6f || p_scale.y < 1e-6f || p_scale.z < 1e-6f) return false;
+    // a mirrored basis keeps a proper rotation with a negative scale
+    if (glm::determinant(basis) < 0.f) p_scale.x = -p_scale.x;
+    basis[0] /= p_scale.x;
+    basis[1] /= p_scale.y;
+    basis[2] /= p_scale.z;
+    p_rotation = glm::quat_cast(basis);
+    p_translation = glm::vec3(p_matrix[3]);
+    return true;
+}
+
+// interpolates translation and scale linearly and the rotation with a slerp, a componentwise blend of two rotations
+// shears the matrix
+static glm::mat4 interpolateTransform(const glm::mat4& p_a, const glm::mat4& p_b, float p_alpha) {
+    glm::vec3 translation_a, translation_b, scale_a, scale_b;
+    glm::quat rotation_a, rotation_b;
+    if (!decomposeTransform(p_a, translation_a, rotation_a, scale_a) || !decomposeTransform(p_b, translation_b, rotation_b, scale_b)) {
+        return p_alpha < 0.5f ? p_a : p_b;
+    }
+    glm::mat4 matrix = glm::mat4_cast(glm::slerp(rotation_a, rotation_b, p_alpha));
+    matrix[0] *= glm::mix(scale_a.x, scale_b.x, p_alpha);
+    matrix[1] *= glm::mix(scale_a.y, scale_b.y, p_alpha);
+    matrix[2] *= glm::mix(scale_a.z, scale_b.z, p_alpha);
+    matrix[3] = glm::vec4(glm::mix(translation_a, translation_b, p_alpha), 1.f);
+    return matrix;
+}
+
 void Scene::updateCameraBuffer(uint32_t p_frame_index) {
-    if (m_cameras.size() == 0) return;
+    const SceneSnapshot& snapshot = m_snapshots.front();
+    if (snapshot.cameras.size() == 0) return;
 
-    if (camera_buffer[p_frame_index].getInstancesCount() < m_cameras.size()) {
-        camera_buffer[p_frame_index] =
-            Buffer(m_device, sizeof(Ubo), m_cameras.size(), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, Buffer::BufferType::DYNAMIC);
+    float alpha = getInterpolationAlpha();
+    std::vector<Ubo>& ubos = m_interpolated_cameras;
+    ubos.resize(snapshot.cameras.size());
+    for (size_t i = 0; i < ubos.size(); i++) {
+        ubos[i].projection = lerpMatrix(snapshot.previous_cameras[i].projection, snapshot.cameras[i].projection, alpha);
+        ubos[i].view = interpolateTransform(snapshot.previous_cameras[i].view, snapshot.cameras[i].view, alpha);
+        ubos[i].invView = glm::inverse(ubos[i].view);
     }
-    std::vector<Ubo> ubos;
 
-    for (auto cam : m_cameras) {
-        Ubo ubo;
-        ubo.projection = cam->getProjectionMatrix();
-        ubo.view = cam->getViewMatrix();
-        ubo.invView = glm::inverse(cam->getViewMatrix());
-        ubos.push_back(ubo);
+    if (camera_buffer[p_frame_index].getInstancesCount() < ubos.size()) {
+        camera_buffer[p_frame_index] =
+            Buffer(m_device, sizeof(Ubo), ubos.size(), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, Buffer::BufferType::DYNAMIC);
     }
 
     camera_buffer[p_frame_index].writeToBuffer(ubos.data(), sizeof(Ubo) * ubos.size());
 }
 
-struct Object_data {
-    glm::mat4 world_matrix;
-    glm::mat4 normal_matrix;
-    glm::vec3 padding{0};
-    uint32_t material_offset = 0;
-};
+void Scene::updateObjectBuffer(uint32_t p_frame_index) {
+    const SceneSnapshot& snapshot = m_snapshots.front();
+    // the previous frame may still read its own buffer, only the buffer of this frame is rewritten
+    Buffer& object_buffer = m_object_buffer[p_frame_index];
+    if (object_buffer.getInstancesCount() < std::max<size_t>(snapshot.objects.size(), 1)) {
+        object_buffer = Buffer(
+            m_device, sizeof(ObjectGPU), snapshot.objects.size() * 2, VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, Buffer::BufferType::DYNAMIC);
+    }
 
-void Scene::updateObjectBuffer() {
-    if (m_object_buffer.getInstancesCount() < m_objects.size()) {
-        m_object_buffer = Buffer(
-            m_device, sizeof(Object_data), m_objects.size() * 2, VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, Buffer::BufferType::DYNAMIC);
-        for (auto& obj : m_objects) {
-            obj.second->uploaded_to_GPU = false;
-        }
+    float alpha = getInterpolationAlpha();
+    m_interpolated_objects.resize(snapshot.objects.size());
+    for (size_t i = 0; i < snapshot.objects.size(); i++) {
+        m_interpolated_objects[i] = snapshot.objects[i];
+        glm::mat4 world_matrix = interpolateTransform(snapshot.previous_objects[i].world_matrix, snapshot.objects[i].world_matrix, alpha);
+        m_interpolated_objects[i].world_matrix = world_matrix;
+        m_interpolated_objects[i].normal_matrix = glm::mat4(glm::inverseTranspose(glm::mat3(world_matrix)));
+    }
+    for (auto& dynamic_mesh : snapshot.dynamic_verticies) {
+        auto stream = m_dynamic_streams.find(dynamic_mesh.object_id);
+        if (stream == m_dynamic_streams.end() || dynamic_mesh.object_id >= m_interpolated_objects.size()) continue;
+        m_interpolated_objects[dynamic_mesh.object_id].dynamic_verticies = stream->second.buffers[p_frame_index].getBufferDeviceAddress();
+        m_interpolated_objects[dynamic_mesh.object_id].dynamic_first_vertex = dynamic_mesh.first_vertex;
+    }
+    object_buffer.writeToBuffer(m_interpolated_objects.data(), sizeof(ObjectGPU) * m_interpolated_objects.size(), 0);
 
-        m_mesh_block_buffer =
-            Buffer(m_device, sizeof(MeshBlock), 300000, VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, Buffer::BufferType::DYNAMIC);
+    // blocks are culled on GPU with the object matrices, they only change when renderables are added
+    if (snapshot.mesh_blocks_version != m_uploaded_mesh_blocks_version) {
+        updateMeshBlockBuffer();
+        m_uploaded_mesh_blocks_version = snapshot.mesh_blocks_version;
     }
+}
 
-    m_total_mesh_block = 0;
-    for (auto& obj : m_objects) {
-        if (!obj.second->uploaded_to_GPU) {
-            Object_data data;
-            data.world_matrix = obj.second->wMatrix();
-            data.normal_matrix = obj.second->wNormalMatrix();
-            data.material_offset = 0;
-            m_object_buffer.writeToBuffer(&data, sizeof(Object_data), sizeof(Object_data) * obj.second->getId());
-            obj.second->uploaded_to_GPU = true;
+void Scene::buildMeshBlocks() {
+    m_mesh_blocks.clear();
+    m_instance_ids.clear();
+    m_total_instance_slot = 0;
+
+    auto add_blocks = [&](std::vector<MeshBlock> p_blocks, const std::vector<uint32_t>& p_ids) {
+        uint32_t first_instance = m_instance_ids.size();
+        m_instance_ids.insert(m_instance_ids.end(), p_ids.begin(), p_ids.end());
+        for (auto& block : p_blocks) {
+            block.firstInstance = first_instance;
+            block.instanceCount = p_ids.size();
+            block.visibleOffset = m_total_instance_slot;
+            m_total_instance_slot += p_ids.size();
+            m_mesh_blocks.push_back(block);
+        }
+    };
 
-            auto renderable_obj = std::dynamic_pointer_cast<IIndirectRenderable>(obj.second);
+    // group renderables sharing the same mesh, the others keep their own blocks
+    std::map<Mesh*, std::vector<uint32_t>> instanced_meshes;
+    for (auto& obj : m_objects) {
+        auto renderable_obj = std::dynamic_pointer_cast<IIndirectRenderable>(obj.second);
+        if (!renderable_obj) continue;
 
-            if (renderable_obj) {
-                auto mesh_blocks = renderable_obj->getMeshBlock(2000);
-                m_mesh_block_buffer.writeToBuffer(
-                    mesh_blocks.data(), sizeof(MeshBlock) * mesh_blocks.size(), sizeof(MeshBlock) * m_total_mesh_block);
-                m_total_mesh_block += mesh_blocks.size();
-            }
+        Mesh* mesh = renderable_obj->getInstancedMesh();
+        if (mesh) {
+            instanced_meshes[mesh].push_back(obj.first);
+        } else {
+            add_blocks(renderable_obj->getMeshBlock(2000), {obj.first});
         }
     }
+    for (auto& instanced_mesh : instanced_meshes) {
+        add_blocks(instanced_mesh.first->getMeshBlock(2000), instanced_mesh.second);
+    }
 }
 
-void Scene::updateLightBuffer() {
-    if (m_light_objects.size() == 0) {
-        Light l;
-        l.color = glm::vec3(0);
-        l.intensity = 0;
-        l.m_type = Light::POINT;
-        addNode(-1, std::make_shared<Light>(l));
+void Scene::updateMeshBlockBuffer() {
+    const SceneSnapshot& snapshot = m_snapshots.front();
+
+    if (m_mesh_block_buffer.getInstancesCount() < snapshot.mesh_blocks.size()) {
+        m_mesh_block_buffer = Buffer(
+            m_device, sizeof(MeshBlock), std::max<size_t>(snapshot.mesh_blocks.size() * 2, 300000), VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+            Buffer::BufferType::DYNAMIC);
+    }
+    if (m_instance_buffer.getInstancesCount() < std::max<size_t>(snapshot.instance_ids.size(), 1)) {
+        m_instance_buffer = Buffer(
+            m_device, sizeof(uint32_t), std::max<size_t>(snapshot.instance_ids.size() * 2, 1024), VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+            Buffer::BufferType::DYNAMIC);
     }
 
-    if (m_light_buffer.getInstancesCount() < m_light_objects.size()) {
-        m_light_buffer = Buffer(
-            m_device, sizeof(LightGPU), m_light_objects.size() * 2, VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, Buffer::BufferType::DYNAMIC);
+    m_mesh_block_buffer.writeToBuffer(snapshot.mesh_blocks.data(), sizeof(MeshBlock) * snapshot.mesh_blocks.size(), 0);
+    m_instance_buffer.writeToBuffer(snapshot.instance_ids.data(), sizeof(uint32_t) * snapshot.instance_ids.size(), 0);
+    m_total_mesh_block = snapshot.mesh_blocks.size();
+    m_total_visible_slot = snapshot.total_instance_slot;
+}
 
-        for (auto& light : m_light_objects) {
-            light->uploaded_to_GPU = false;
-        }
+void Scene::updateLightBuffer(uint32_t p_frame_index) {
+    const SceneSnapshot& snapshot = m_snapshots.front();
+    if (snapshot.lights.size() == 0) return;
+
+    float alpha = getInterpolationAlpha();
+    std::vector<LightGPU>& lights = m_interpolated_lights;
+    lights.resize(snapshot.lights.size());
+    for (size_t i = 0; i < lights.size(); i++) {
+        lights[i] = snapshot.lights[i];
+        lights[i].pos = glm::mix(snapshot.previous_lights[i].pos, snapshot.lights[i].pos, alpha);
     }
-    int i = 0;
-    for (auto& light : m_light_objects) {
-        if (!light->uploaded_to_GPU) {
-            LightGPU l;
-            l.color = glm::vec4(light->color, light->intensity);
-            l.pos = light->wMatrix() * glm::vec4(0, 0, 0, 1);
-            l.orientation = light->getParent()->wNormalMatrix() * light->transform.rot.value;
-            l.Type = light->m_type;
-            light->uploaded_to_GPU = true;
-            m_light_buffer.writeToBuffer(&l, sizeof(LightGPU), sizeof(LightGPU) * i);
+
+    Buffer& light_buffer = m_light_buffer[p_frame_index];
+    if (light_buffer.getInstancesCount() < lights.size()) {
+        light_buffer = Buffer(
+            m_device, sizeof(LightGPU), lights.size() * 2, VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, Buffer::BufferType::DYNAMIC);
+    }
+    light_buffer.writeToBuffer(lights.data(), sizeof(LightGPU) * lights.size(), 0);
+}
+
+// one persistently mapped buffer per frame in flight : the buffer written here, or replaced when the mesh changes size, is
+// never read by a frame still on the GPU, so a tick costs a memcpy, without staging buffer or submit. Its address reaches
+// the shaders through the object buffer of the same frame
+void Scene::updateDynamicVerticies(uint32_t p_frame_index) {
+    const SceneSnapshot& snapshot = m_snapshots.front();
+    for (auto& dynamic_mesh : snapshot.dynamic_verticies) {
+        DynamicVertexStream& stream = m_dynamic_streams[dynamic_mesh.object_id];
+        uint32_t nb_vertex = dynamic_mesh.verticies.size();
+        Buffer& buffer = stream.buffers[p_frame_index];
+        if (stream.nb_vertex[p_frame_index] != nb_vertex) {
+            // the buffer of the other frames is released when they come back here
+            buffer = Buffer(m_device, sizeof(DynamicVertexGPU), nb_vertex, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, Buffer::BufferType::DYNAMIC);
+            stream.nb_vertex[p_frame_index] = nb_vertex;
+            stream.versions[p_frame_index] = 0;
+        }
+
+        if (stream.versions[p_frame_index] != snapshot.version) {
+            buffer.writeToBuffer(const_cast<DynamicVertexGPU*>(dynamic_mesh.verticies.data()), nb_vertex * sizeof(DynamicVertexGPU), 0);
+            stream.versions[p_frame_index] = snapshot.version;
         }
-        i++;
     }
 }
 
@@ -507,8 +808,7 @@ void Scene::updateMaterialBuffer() {
 }
 
 void Scene::createDescriptorSets() { 
-    scene_descriptor_set = DescriptorSet(m_device, m_mesh_pipeline.getDescriptorSetLayout(0)); 
-
+    // the scene descriptor set is sized to the loaded textures, it is created by updateDescriptorSets
     for(int i =0; i<MAX_FRAMES_IN_FLIGHT; i++) {
         shadow_descriptor_sets[i] = DescriptorSet(m_device, m_shading_pipeline.getDescriptorsSetLayout()[1]);
     }
@@ -528,12 +828,18 @@ void Scene::updateDescriptorSets() {
         Image default_image = Image(m_device, default_image_create_info);
         images.push_back(default_image);
     }
+    if (images.size() > DescriptorSetLayout::s_runtime_array_capacity) {
+        throw std::runtime_error("too many textures : " + std::to_string(images.size()));
+    }
+    // textures[] is the variable binding of the set : the descriptor buffer only holds the loaded textures
+    scene_descriptor_set = DescriptorSet(m_device, m_mesh_pipeline.getDescriptorSetLayout(0), images.size());
+
     std::vector<VkDescriptorImageInfo> image_infos;
     for (auto& texture : images) {
         image_infos.push_back(texture.getDescriptorImageInfo(samplerType::LINEAR));
     }
-    scene_descriptor_set.writeImagesDescriptor(0, image_infos);
-    scene_descriptor_set.writeImageDescriptor(1, m_skybox_image.getDescriptorImageInfo(samplerType::LINEAR));
+    scene_descriptor_set.writeImageDescriptor(0, m_skybox_image.getDescriptorImageInfo(samplerType::LINEAR));
+    scene_descriptor_set.writeImagesDescriptor(1, image_infos);
 }
 
 void Scene::updateRenderPassDescriptorSets() {
@@ -580,6 +886,8 @@ void Scene::createPipelines() {
     pipeline_create_info.vexter_shader_file = "TTengine-2/shaders/deffered.vert";
 #endif
     m_mesh_pipeline = GraphicPipeline(m_device, pipeline_create_info);
+    // scene_descriptor_set is allocated from the set 0 of the mesh pipeline and bound with the skybox and shadow pipelines
+    pipeline_create_info.shared_descriptors_set_layout = {{0, m_mesh_pipeline.getDescriptorSetLayout(0)}};
 
 #ifdef DEFAULT_APP_PATH
     pipeline_create_info.fragment_shader_file = "shaders/bgV2.frag";
@@ -590,17 +898,28 @@ void Scene::createPipelines() {
 #endif
     m_skybox_pipeline = GraphicPipeline(m_device, pipeline_create_info);
 
+    // variant 0 handles every light type, with shadows
+    ShaderPermutation shading_permutation{{"SHADOWS"}, {{0, VK_TRUE}, {1, VK_TRUE}}};
 #ifdef DEFAULT_APP_PATH
-    m_shading_pipeline = ComputePipeline(m_device, "shaders/shading.comp");
+    m_shading_pipeline = ComputePipeline(m_device, "shaders/shading.comp", shading_permutation);
 #else
-    m_shading_pipeline = ComputePipeline(m_device, "TTengine-2/shaders/shading.comp");
+    m_shading_pipeline = ComputePipeline(m_device, "TTengine-2/shaders/shading.comp", shading_permutation);
 #endif
+    for (uint32_t directional = 0; directional < 2; directional++) {
+        for (uint32_t point = 0; point < 2; point++) {
+            ShaderPermutation permutation;
+            if (directional) permutation.defines.push_back("SHADOWS");
+            permutation.constants = {{0, directional}, {1, point}};
+            m_shading_variants[directional][point] = m_shading_pipeline.addVariant(permutation);
+        }
+    }
 
 #ifdef DEFAULT_APP_PATH
     m_cull_pipeline = ComputePipeline(m_device, "shaders/cull.comp");
 #else
     m_cull_pipeline = ComputePipeline(m_device, "TTengine-2/shaders/cull.comp");
 #endif
+    m_cull_compact_variant = m_cull_pipeline.addVariant({{}, {{0, VK_TRUE}}});
 
 #ifdef DEFAULT_APP_PATH
     pipeline_create_info.fragment_shader_file = "shaders/shadow.frag";
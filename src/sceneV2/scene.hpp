@@ -23,6 +23,7 @@
 #include "sceneV2/loader/gltf_loader.hpp"
 #include "sceneV2/mesh.hpp"
 #include "sceneV2/node.hpp"
+#include "sceneV2/scene_snapshot.hpp"
 #include "shader/pipeline/compute_pipeline.hpp"
 #include "shader/pipeline/graphic_pipeline.hpp"
 #include "struct.hpp"
@@ -45,6 +46,9 @@ class Scene : public Node {
 
     void Param(std::filesystem::path p_fichier_param);
 
+    // render thread : run the pending steps of the objects simulated on the GPU, outside of any render pass
+    void simulateGPU(CommandBuffer &p_cmd, RenderData &p_render_data);
+
     void renderShadowMaps(CommandBuffer &p_cmd, RenderData &p_render_data);
     void renderDeffered(CommandBuffer &p_cmd, RenderData &p_render_data);
     void renderShading(CommandBuffer &p_cmd, RenderData &p_render_data);
@@ -66,14 +70,29 @@ class Scene : public Node {
     std::shared_ptr<Node> getNode(uint32_t p_id) { return m_objects[p_id]; }
 
     std::vector<Material> &getMaterials() { return m_materials; }
+
+    void setGravity(glm::vec3 p_gravity) { m_gravity = p_gravity; }
+    glm::vec3 getGravity() const { return m_gravity; }
+    // velocities of the simulated objects are multiplied by it at each step
+    void setDamping(float p_damping) { m_visco = p_damping; }
+    float getDamping() const { return m_visco; }
     std::vector<std::shared_ptr<Light>> &getLights() { return m_light_objects; }
 
 
 
+    // update thread : copy transforms, lights, cameras and deformed vertices in the back snapshot and publish it,
+    // p_tick_duration is the time until the next commit, used to interpolate on the render side
+    void commitSnapshot(float p_tick_duration = 0.f);
+    // render thread : take the last published snapshot and upload the state interpolated between its last two ticks,
+    // return false if nothing new was published
+    bool acquireSnapshot(uint32_t p_frame_index = 0);
+
+    // upload from the front snapshot, render thread only
     void updateCameraBuffer(uint32_t p_frameIndex = 0);
     void updateMaterialBuffer();
-    void updateObjectBuffer();
-    void updateLightBuffer();
+    void updateObjectBuffer(uint32_t p_frame_index);
+    void updateLightBuffer(uint32_t p_frame_index);
+    void updateDynamicVerticies(uint32_t p_frame_index);
     void updateDescriptorSets();
     void updateRenderPassDescriptorSets();
 
@@ -93,6 +112,10 @@ class Scene : public Node {
 
    private:
     void createDrawIndirectBuffers();
+    // culls the instances of every block for a camera, fills the indirect draws of that camera for the frame
+    void cullInstances(CommandBuffer &p_cmd, uint32_t p_camera_id, uint32_t p_frame_index);
+    void buildMeshBlocks();
+    void updateMeshBlockBuffer();
     void createPipelines();
     void createDescriptorSets();
 
@@ -109,20 +132,57 @@ class Scene : public Node {
 
     
     
-    Buffer m_object_buffer;
-    Buffer m_light_buffer;
+    // rewritten every frame with the interpolated state, one per frame in flight
+    std::array<Buffer, MAX_FRAMES_IN_FLIGHT> m_object_buffer;
+    std::array<Buffer, MAX_FRAMES_IN_FLIGHT> m_light_buffer;
 
     std::vector<std::array<Buffer, MAX_FRAMES_IN_FLIGHT>> m_draw_indirect_buffers;
     std::vector<std::array<Buffer, MAX_FRAMES_IN_FLIGHT>> m_count_indirect_buffers;
+    std::vector<std::array<Buffer, MAX_FRAMES_IN_FLIGHT>> m_visible_instance_buffers;
+    // visible instances of each block, filled by the first cull pass
+    std::vector<std::array<Buffer, MAX_FRAMES_IN_FLIGHT>> m_visible_count_buffers;
 
     Buffer m_mesh_block_buffer;
     uint m_total_mesh_block = 0;
+    uint32_t m_total_visible_slot = 0;
+
+    // object ids grouped by mesh, each mesh block points to the range of its mesh
+    Buffer m_instance_buffer;
+    uint32_t m_uploaded_mesh_blocks_version = 0;
+
+    // render thread side of the snapshot
+    float getInterpolationAlpha() const;
+    std::vector<ObjectGPU> m_interpolated_objects;
+    std::vector<LightGPU> m_interpolated_lights;
+    std::vector<Ubo> m_interpolated_cameras;
+
+    // positions and normals of the deforming meshes, one buffer per frame in flight
+    struct DynamicVertexStream {
+        std::array<Buffer, MAX_FRAMES_IN_FLIGHT> buffers;
+        std::array<uint32_t, MAX_FRAMES_IN_FLIGHT> nb_vertex{};
+        std::array<uint64_t, MAX_FRAMES_IN_FLIGHT> versions{};  // snapshot copied in each buffer
+    };
+    std::map<uint32_t, DynamicVertexStream> m_dynamic_streams;  // by object id
+
+    // update thread side of the snapshot
+    TripleBuffer<SceneSnapshot> m_snapshots;
+    std::vector<ObjectGPU> m_object_data;
+    std::vector<LightGPU> m_light_data;
+    std::vector<Ubo> m_camera_data;
+    std::vector<MeshBlock> m_mesh_blocks;
+    std::vector<uint32_t> m_instance_ids;
+    uint32_t m_total_instance_slot = 0;
+    uint32_t m_mesh_blocks_version = 0;
+    bool m_mesh_blocks_dirty = true;
+    uint64_t m_snapshot_version = 0;
 
     std::shared_ptr<CameraV2> m_main_camera;
     uint32_t m_main_camera_id = 0;
 
     std::vector<std::shared_ptr<CameraV2>> m_cameras{};
+    // kinematic objects first, they are stepped before the others
     std::vector<std::shared_ptr<IAnimatic>> m_animatic_objs;
+    uint32_t m_nb_kinematic_objs = 0;
     std::vector<std::shared_ptr<IRenderable>> m_renderables;
     std::vector<std::shared_ptr<IIndirectRenderable>> m_indirect_renderables;
     std::vector<std::shared_ptr<ICollider>> m_collision_objects;
@@ -137,18 +197,21 @@ class Scene : public Node {
 
     GraphicPipeline m_skybox_pipeline;
     ComputePipeline m_shading_pipeline;
+    // variant of the shading pipeline by [has directional lights][has point lights]
+    uint32_t m_shading_variants[2][2] = {};
     GraphicPipeline m_mesh_pipeline;
     
     GraphicPipeline m_shadow_pipeline;
 
     ComputePipeline m_cull_pipeline;
+    uint32_t m_cull_compact_variant = 0;
 
     Device *m_device = nullptr;
 
     // for physics simulation
     glm::vec3 m_gravity{0.0f, -9.81f, 0.0f};
     int m_nb_iter;
-    float m_visco;
+    float m_visco = 0.995f;
 
     friend class GLTFLoader;
 };
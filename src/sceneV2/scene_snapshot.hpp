@@ -0,0 +1,86 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "sceneV2/mesh.hpp"
+#include "sceneV2/render_data.hpp"
+#include "struct.hpp"
+
+namespace TTe {
+
+// everything the render thread needs from the simulated scene, written by the update thread
+struct SceneSnapshot {
+    struct DynamicVerticies {
+        uint32_t object_id = 0;
+        uint32_t first_vertex = 0;  // first vertex of the mesh in the scene vertex buffer
+        std::vector<DynamicVertexGPU> verticies;
+    };
+
+    std::vector<ObjectGPU> objects;  // indexed by node id
+    std::vector<LightGPU> lights;
+    std::vector<Ubo> cameras;
+    std::vector<DynamicVerticies> dynamic_verticies;
+
+    // state of the previous tick, the render thread interpolates between it and the current one
+    std::vector<ObjectGPU> previous_objects;
+    std::vector<LightGPU> previous_lights;
+    std::vector<Ubo> previous_cameras;
+    std::chrono::steady_clock::time_point commit_time;
+    float tick_duration = 0.f;
+
+    // only copied when the set of indirect renderables changed
+    std::vector<MeshBlock> mesh_blocks;
+    std::vector<uint32_t> instance_ids;
+    uint32_t total_instance_slot = 0;
+    uint32_t mesh_blocks_version = 0;
+
+    uint64_t version = 0;
+};
+
+// lock-free triple buffer : the writer owns the back slot, the reader owns the front slot
+// and the last published slot is exchanged with an atomic, so neither thread waits for the other
+template <typename T>
+class TripleBuffer {
+   public:
+    TripleBuffer() = default;
+
+    // not thread safe, only used when the owner is moved during setup
+    TripleBuffer(TripleBuffer &&other)
+        : m_slots(std::move(other.m_slots)), m_back(other.m_back), m_middle(other.m_middle.load()), m_front(other.m_front) {}
+    TripleBuffer &operator=(TripleBuffer &&other) {
+        if (this != &other) {
+            m_slots = std::move(other.m_slots);
+            m_back = other.m_back;
+            m_middle = other.m_middle.load();
+            m_front = other.m_front;
+        }
+        return *this;
+    }
+
+    // writer side
+    T &back() { return m_slots[m_back]; }
+    void publish() { m_back = m_middle.exchange(m_back | s_fresh_bit, std::memory_order_acq_rel) & s_index_mask; }
+
+    // reader side, return false if nothing was published since the last acquire
+    bool acquire() {
+        if ((m_middle.load(std::memory_order_relaxed) & s_fresh_bit) == 0) return false;
+        m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & s_index_mask;
+        return true;
+    }
+    const T &front() const { return m_slots[m_front]; }
+
+   private:
+    static constexpr uint8_t s_fresh_bit = 0x4;
+    static constexpr uint8_t s_index_mask = 0x3;
+
+    std::array<T, 3> m_slots;
+    uint8_t m_back = 0;
+    std::atomic<uint8_t> m_middle = 1;
+    uint8_t m_front = 2;
+};
+
+}  // namespace TTe
@@ -0,0 +1,246 @@
+#include "hot_reload.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+#include "imgui.h"
+#include "shader/pipeline.hpp"
+#include "shader/shader_manager.hpp"
+#include "utils.hpp"
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#ifndef ENGINE_DIR
+#define ENGINE_DIR "../"
+#endif
+
+namespace TTe {
+
+int HotReload::s_inotify_fd = -1;
+std::thread HotReload::s_thread;
+std::atomic<bool> HotReload::s_running{false};
+std::shared_mutex HotReload::s_pipelines_mutex;
+std::unordered_map<Pipeline *, std::vector<std::filesystem::path>> HotReload::s_pipelines;
+std::mutex HotReload::s_mutex;
+std::unordered_map<int, std::filesystem::path> HotReload::s_directories;
+std::vector<Pipeline *> HotReload::s_reloaded;
+std::unordered_map<Pipeline *, HotReload::Error> HotReload::s_errors;
+std::deque<HotReload::RetiredShaders> HotReload::s_retired;
+uint64_t HotReload::s_frame = 0;
+JobCounter HotReload::s_jobs;
+
+void HotReload::init() {
+#ifdef __linux__
+    s_inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (s_inotify_fd < 0) {
+        std::cerr << "shader hot reload disabled : inotify_init1 failed" << std::endl;
+        return;
+    }
+    {
+        std::shared_lock<std::shared_mutex> pipelines_lock(s_pipelines_mutex);
+        std::lock_guard<std::mutex> lock(s_mutex);
+        for (auto &pipeline : s_pipelines) watchDirectories(pipeline.second);
+    }
+    s_running = true;
+    s_thread = std::thread(&HotReload::watchLoop);
+#endif
+}
+
+void HotReload::shutdown() {
+    s_running = false;
+    if (s_thread.joinable()) s_thread.join();
+    JobSystem::wait(s_jobs);
+#ifdef __linux__
+    if (s_inotify_fd >= 0) close(s_inotify_fd);
+#endif
+    s_inotify_fd = -1;
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_directories.clear();
+    s_retired.clear();
+}
+
+void HotReload::watch(Pipeline *p_pipeline) {
+    std::vector<std::filesystem::path> dependencies = getDependencies(p_pipeline);
+    std::unique_lock<std::shared_mutex> pipelines_lock(s_pipelines_mutex);
+    std::lock_guard<std::mutex> lock(s_mutex);
+    watchDirectories(dependencies);
+    s_pipelines[p_pipeline] = std::move(dependencies);
+}
+
+void HotReload::unwatch(Pipeline *p_pipeline) {
+    std::unique_lock<std::shared_mutex> pipelines_lock(s_pipelines_mutex);
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_pipelines.erase(p_pipeline);
+    s_errors.erase(p_pipeline);
+    s_reloaded.erase(std::remove(s_reloaded.begin(), s_reloaded.end(), p_pipeline), s_reloaded.end());
+}
+
+void HotReload::replace(Pipeline *p_old, Pipeline *p_new) {
+    std::unique_lock<std::shared_mutex> pipelines_lock(s_pipelines_mutex);
+    std::lock_guard<std::mutex> lock(s_mutex);
+    auto pipeline = s_pipelines.find(p_old);
+    if (pipeline == s_pipelines.end()) return;
+    s_pipelines[p_new] = std::move(pipeline->second);
+    s_pipelines.erase(p_old);
+
+    auto error = s_errors.find(p_old);
+    if (error != s_errors.end()) {
+        s_errors[p_new] = std::move(error->second);
+        s_errors.erase(p_old);
+    }
+    std::replace(s_reloaded.begin(), s_reloaded.end(), p_old, p_new);
+}
+
+void HotReload::update(bool p_swap) {
+    // a pipeline created on another thread holds the lock until a running reload is finished, the swap waits for the
+    // next frame instead of stalling this one
+    std::shared_lock<std::shared_mutex> pipelines_lock(s_pipelines_mutex, std::try_to_lock);
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_frame++;
+
+    // the frames recorded before a swap may still be executed by the next MAX_FRAMES_IN_FLIGHT frames
+    while (!s_retired.empty() && s_retired.front().frame + MAX_FRAMES_IN_FLIGHT < s_frame) {
+        s_retired.pop_front();
+    }
+
+    if (!p_swap || !pipelines_lock.owns_lock() || s_reloaded.empty()) return;
+    for (Pipeline *pipeline : s_reloaded) {
+        s_retired.push_back({s_frame, pipeline->swapReloadedShaders()});
+    }
+    s_reloaded.clear();
+}
+
+void HotReload::drawErrors() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (s_errors.empty()) return;
+
+    ImGui::Begin("Shader errors");
+    ImGui::TextUnformatted("the last compiled version of these pipelines is still used");
+    for (auto &error : s_errors) {
+        ImGui::Separator();
+        ImGui::TextColored(ImVec4(1.f, 0.4f, 0.4f, 1.f), "%s", error.second.label.c_str());
+        ImGui::TextUnformatted(error.second.log.c_str());
+    }
+    ImGui::End();
+}
+
+void HotReload::watchLoop() {
+#ifdef __linux__
+    alignas(inotify_event) char buffer[4096];
+    while (s_running) {
+        pollfd poll_fd = {s_inotify_fd, POLLIN, 0};
+        // wakes up regularly to see the shutdown
+        if (poll(&poll_fd, 1, 100) <= 0) continue;
+
+        // an editor saves a file in several steps (write, rename...), the events following within 50 ms are merged
+        std::vector<std::filesystem::path> changed;
+        do {
+            ssize_t length;
+            while ((length = read(s_inotify_fd, buffer, sizeof(buffer))) > 0) {
+                for (char *event_ptr = buffer; event_ptr < buffer + length;) {
+                    const inotify_event *event = reinterpret_cast<const inotify_event *>(event_ptr);
+                    if (event->len > 0) {
+                        std::lock_guard<std::mutex> lock(s_mutex);
+                        auto directory = s_directories.find(event->wd);
+                        if (directory != s_directories.end()) changed.push_back((directory->second / event->name).lexically_normal());
+                    }
+                    event_ptr += sizeof(inotify_event) + event->len;
+                }
+            }
+        } while (poll(&poll_fd, 1, 50) > 0);
+
+        if (!changed.empty()) reloadChanged(changed);
+    }
+#endif
+}
+
+void HotReload::reloadChanged(std::vector<std::filesystem::path> &p_files) {
+    std::sort(p_files.begin(), p_files.end());
+    p_files.erase(std::unique(p_files.begin(), p_files.end()), p_files.end());
+    ShaderManager::invalidate(p_files);
+
+    std::vector<Pipeline *> pipelines;
+    {
+        std::shared_lock<std::shared_mutex> pipelines_lock(s_pipelines_mutex);
+        std::lock_guard<std::mutex> lock(s_mutex);
+        for (auto &pipeline : s_pipelines) {
+            bool changed = std::any_of(pipeline.second.begin(), pipeline.second.end(), [&](const std::filesystem::path &p_file) {
+                return std::binary_search(p_files.begin(), p_files.end(), p_file);
+            });
+            if (changed) pipelines.push_back(pipeline.first);
+        }
+    }
+
+    // the pipeline may be destroyed before the job starts, reload checks it is still registered
+    for (Pipeline *pipeline : pipelines) {
+        JobSystem::run([pipeline]() { reload(pipeline); }, &s_jobs);
+    }
+}
+
+void HotReload::reload(Pipeline *p_pipeline) {
+    std::shared_lock<std::shared_mutex> pipelines_lock(s_pipelines_mutex);
+    if (!s_pipelines.count(p_pipeline)) return;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    std::string error;
+    try {
+        p_pipeline->reloadShaders();
+    } catch (const std::exception &e) {
+        error = e.what();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    std::vector<std::filesystem::path> dependencies = getDependencies(p_pipeline);
+    std::string label = dependencies.empty() ? std::string("pipeline") : dependencies[0].generic_string();
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (!error.empty()) {
+        // the dependencies are kept, the shader in error may not know all its includes
+        s_errors[p_pipeline] = {label, error};
+        std::cout << "Shader reload failed: " + label + "\n" + error + "\n" << std::flush;
+        return;
+    }
+
+    // the new sources may include other files
+    watchDirectories(dependencies);
+    s_pipelines[p_pipeline] = std::move(dependencies);
+    s_errors.erase(p_pipeline);
+    if (std::find(s_reloaded.begin(), s_reloaded.end(), p_pipeline) == s_reloaded.end()) s_reloaded.push_back(p_pipeline);
+    std::cout << "Shader reloaded: " + label + " in " + std::to_string(std::chrono::duration<float, std::milli>(end - start).count()) +
+                     " ms\n"
+              << std::flush;
+}
+
+std::vector<std::filesystem::path> HotReload::getDependencies(Pipeline *p_pipeline) {
+    std::vector<std::filesystem::path> dependencies;
+    for (auto &source : p_pipeline->getShaderSources()) {
+        for (std::filesystem::path &file : ShaderManager::getDependencies(source.first, source.second)) {
+            if (std::find(dependencies.begin(), dependencies.end(), file) == dependencies.end()) dependencies.push_back(file);
+        }
+    }
+    return dependencies;
+}
+
+void HotReload::watchDirectories(const std::vector<std::filesystem::path> &p_files) {
+#ifdef __linux__
+    if (s_inotify_fd < 0) return;
+    for (const std::filesystem::path &file : p_files) {
+        std::filesystem::path directory = file.parent_path();
+        bool watched = std::any_of(
+            s_directories.begin(), s_directories.end(), [&](auto &p_watched) { return p_watched.second == directory; });
+        if (watched) continue;
+        // the folder is watched rather than the file, an editor may replace the file by a new one
+        int watch_descriptor =
+            inotify_add_watch(s_inotify_fd, (std::filesystem::path(ENGINE_DIR) / directory).c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (watch_descriptor >= 0) s_directories[watch_descriptor] = directory;
+    }
+#endif
+}
+
+}  // namespace TTe
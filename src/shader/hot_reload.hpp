@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "jobs/job_system.hpp"
+#include "shader/shader.hpp"
+
+namespace TTe {
+class Pipeline;
+
+// rebuilds the pipelines whose shader sources change on disk while the engine runs. A thread watches (inotify) the folders
+// of the sources and includes of every pipeline, the changed pipelines are compiled again on the job system and swapped by
+// the render thread between two frames. A pipeline that does not compile keeps its last good shaders, the compiler log is
+// shown in an ImGui window until it is fixed
+class HotReload {
+   public:
+    static void init();
+    // the device must be idle, the retired shaders are destroyed
+    static void shutdown();
+
+    // called by the pipelines : registered once built, until destroyed or moved. Waits for a reload of the pipeline
+    // running on a worker
+    static void watch(Pipeline *p_pipeline);
+    static void unwatch(Pipeline *p_pipeline);
+    static void replace(Pipeline *p_old, Pipeline *p_new);
+
+    // render thread, before recording a frame : swaps the reloaded pipelines and destroys the shaders they replaced
+    // once no frame in flight can use them. p_swap is false while another thread records commands, the frame is counted
+    static void update(bool p_swap);
+    // window listing the pipelines in error, inside an ImGui frame
+    static void drawErrors();
+
+   private:
+    struct RetiredShaders {
+        uint64_t frame = 0;
+        std::vector<Shader> shaders;
+    };
+
+    struct Error {
+        std::string label;
+        std::string log;
+    };
+
+    static void watchLoop();
+    static void reloadChanged(std::vector<std::filesystem::path> &p_files);
+    static void reload(Pipeline *p_pipeline);
+    static std::vector<std::filesystem::path> getDependencies(Pipeline *p_pipeline);
+    // s_mutex held
+    static void watchDirectories(const std::vector<std::filesystem::path> &p_files);
+
+    static int s_inotify_fd;
+    static std::thread s_thread;
+    static std::atomic<bool> s_running;
+
+    // shared by the reload jobs and the swap, exclusive to add or remove a pipeline : a pipeline is not moved or
+    // destroyed while it is reloaded
+    static std::shared_mutex s_pipelines_mutex;
+    // sources and includes of every pipeline, the values are also guarded by s_mutex
+    static std::unordered_map<Pipeline *, std::vector<std::filesystem::path>> s_pipelines;
+
+    static std::mutex s_mutex;
+    // watch descriptor -> folder, relative to the engine directory like the shader paths
+    static std::unordered_map<int, std::filesystem::path> s_directories;
+    // pipelines with reloaded shaders waiting for the next frame
+    static std::vector<Pipeline *> s_reloaded;
+    static std::unordered_map<Pipeline *, Error> s_errors;
+    static std::deque<RetiredShaders> s_retired;
+    static uint64_t s_frame;
+    static JobCounter s_jobs;
+};
+
+}  // namespace TTe
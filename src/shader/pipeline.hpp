@@ -1,11 +1,16 @@
 #pragma once
 
 #include <cstdint>
+#include <filesystem>
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "../descriptor/descriptorSetLayout.hpp"
 #include "../device.hpp"
 #include "commandBuffer/command_buffer.hpp"
+#include "shader/shader.hpp"
 #include "volk.h"
 
 namespace TTe {
@@ -13,11 +18,18 @@ namespace TTe {
 class Pipeline {
    public:
     virtual void bindPipeline(const CommandBuffer &cmdBuffer) = 0;
-    // virtual void reloadShader(VkShaderStageFlagBits shaderStageToReload) = 0;
     std::shared_ptr<DescriptorSetLayout> getDescriptorSetLayout(uint32_t id) { return m_pipeline_descriptors_sets_layout_list[id]; }
     VkPipelineLayout getPipelineLayout() { return m_vk_pipeline_layout; };
     VkShaderStageFlags getPushConstantStage(){return m_push_constant_info.stageFlags;}
 
+    // hot reload : builds every variant again from the current sources, on a job system worker. The new shaders use the
+    // same pipeline layout and wait in the pipeline until swapReloadedShaders. Throws with the compiler log on error
+    virtual void reloadShaders() = 0;
+    // called between two frames, returns the replaced shaders to destroy once the frames in flight are finished
+    virtual std::vector<Shader> swapReloadedShaders() = 0;
+    // shader file and defines of every stage of every variant
+    virtual std::vector<std::pair<std::filesystem::path, std::vector<std::string>>> getShaderSources() = 0;
+
    private:
    std::map<uint32_t, std::shared_ptr<DescriptorSetLayout>> m_pipeline_descriptors_sets_layout_list;
    
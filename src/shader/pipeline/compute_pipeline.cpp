@@ -2,22 +2,34 @@
 #include "compute_pipeline.hpp"
 #include <cstdint>
 
+#include "shader/hot_reload.hpp"
+
 
 #include "structs_vk.hpp"
 
 namespace TTe {
 
-ComputePipeline::ComputePipeline(Device* p_device, std::filesystem::path p_compute_shader_name) : m_device(p_device) {
-    createShaders(p_compute_shader_name);
+ComputePipeline::ComputePipeline(Device* p_device, std::filesystem::path p_compute_shader_name, const ShaderPermutation& p_permutation)
+    : m_compute_shader_path(p_compute_shader_name), m_device(p_device) {
+    createShaders(p_permutation);
     createPipelineLayout();
+    HotReload::watch(this);
 }
 
 ComputePipeline::~ComputePipeline() {
+    HotReload::unwatch(this);
     vkDestroyPipelineLayout(*m_device, m_pipeline_layout, nullptr);
 }
 
 ComputePipeline::ComputePipeline(ComputePipeline&& other) {
-    m_compute_shader = std::move(other.m_compute_shader);
+    // waits for a reload of other still running
+    HotReload::replace(&other, this);
+    m_compute_shader_path = std::move(other.m_compute_shader_path);
+    m_compute_shaders = std::move(other.m_compute_shaders);
+    m_permutations = std::move(other.m_permutations);
+    m_reloaded_shaders = std::move(other.m_reloaded_shaders);
+    m_variant_ids = std::move(other.m_variant_ids);
+    m_bound_variant = other.m_bound_variant;
     m_pipeline_layout = other.m_pipeline_layout;
     m_device = other.m_device;
     m_push_constant_info = other.m_push_constant_info;
@@ -29,7 +41,14 @@ ComputePipeline& ComputePipeline::operator=(ComputePipeline&& other) {
         if (m_pipeline_layout != VK_NULL_HANDLE) {
             vkDestroyPipelineLayout(*m_device, m_pipeline_layout, nullptr);
         }
-        m_compute_shader = std::move(other.m_compute_shader);
+        HotReload::unwatch(this);
+        HotReload::replace(&other, this);
+        m_compute_shader_path = std::move(other.m_compute_shader_path);
+        m_compute_shaders = std::move(other.m_compute_shaders);
+        m_permutations = std::move(other.m_permutations);
+        m_reloaded_shaders = std::move(other.m_reloaded_shaders);
+        m_variant_ids = std::move(other.m_variant_ids);
+        m_bound_variant = other.m_bound_variant;
         m_pipeline_layout = other.m_pipeline_layout;
         m_device = other.m_device;
         m_push_constant_info = other.m_push_constant_info;
@@ -38,15 +57,16 @@ ComputePipeline& ComputePipeline::operator=(ComputePipeline&& other) {
     return *this;
 }
 
-void ComputePipeline::bindPipeline(const CommandBuffer& p_cmd_buffer) {
-    VkShaderEXT sh = m_compute_shader;
+void ComputePipeline::bindPipeline(const CommandBuffer& p_cmd_buffer, uint32_t p_variant) {
+    m_bound_variant = p_variant;
+    VkShaderEXT sh = m_compute_shaders[p_variant];
     VkShaderStageFlagBits sf = VK_SHADER_STAGE_COMPUTE_BIT;
     vkCmdBindShadersEXT(p_cmd_buffer, 1, &sf, &sh);
 }
 
 void ComputePipeline::dispatch(const CommandBuffer& p_cmd_buffer, uint32_t p_nb_of_invocation_x, uint32_t p_nb_of_invocation_y, uint32_t p_nb_of_invocation_z) {
     // calculate the number of workgroups
-    VkExtent3D work_group_size = m_compute_shader.getComputeWorkGroupSize();
+    VkExtent3D work_group_size = m_compute_shaders[m_bound_variant].getComputeWorkGroupSize();
     uint32_t work_group_count_x = p_nb_of_invocation_x / work_group_size.width + ((p_nb_of_invocation_x % work_group_size.width != 0) ? 1 : 0);
     uint32_t work_group_count_y = p_nb_of_invocation_y / work_group_size.height + ((p_nb_of_invocation_y % work_group_size.height != 0) ? 1 : 0);
     uint32_t work_group_count_z = p_nb_of_invocation_z / work_group_size.depth + ((p_nb_of_invocation_z % work_group_size.depth != 0) ? 1 : 0);
@@ -56,20 +76,88 @@ void ComputePipeline::dispatch(const CommandBuffer& p_cmd_buffer, uint32_t p_nb_
 }
 
 
-void ComputePipeline::createShaders(std::filesystem::path& p_compute_shader_path) {
-    m_compute_shader = Shader(m_device, p_compute_shader_path, VK_SHADER_STAGE_COMPUTE_BIT);
-    m_compute_shader.buildShader();
+void ComputePipeline::createShaders(const ShaderPermutation& p_permutation) {
+    m_compute_shaders.emplace_back(m_device, m_compute_shader_path, VK_SHADER_STAGE_COMPUTE_BIT, 0, p_permutation);
+    m_compute_shaders.back().buildShader();
+    m_permutations.push_back(p_permutation);
+    m_variant_ids[p_permutation.getKey()] = 0;
+
+    m_push_constant_info = m_compute_shaders.back().getPushConstants();
+}
+
+uint32_t ComputePipeline::addVariant(const ShaderPermutation& p_permutation) {
+    auto variant = m_variant_ids.find(p_permutation.getKey());
+    if (variant != m_variant_ids.end()) return variant->second;
 
-    m_push_constant_info = m_compute_shader.getPushConstants();
+    Shader shader = createVariantShader(p_permutation, getDescriptorsSetLayout());
+    std::lock_guard<std::mutex> lock(m_reload_mutex);
+    m_compute_shaders.push_back(std::move(shader));
+    m_permutations.push_back(p_permutation);
+    m_variant_ids[p_permutation.getKey()] = m_compute_shaders.size() - 1;
+    return m_compute_shaders.size() - 1;
+}
+
+Shader ComputePipeline::createVariantShader(
+    const ShaderPermutation& p_permutation, const std::map<uint32_t, std::shared_ptr<DescriptorSetLayout>>& p_descriptors_set_layout) {
+    Shader shader(m_device, m_compute_shader_path, VK_SHADER_STAGE_COMPUTE_BIT, 0, p_permutation);
+    // the variant is built with the set layouts of the pipeline, its bindings must be part of them
+    if (shader.getPushConstants().size > m_push_constant_info.size || !shader.fitsDescriptorsSetLayout(p_descriptors_set_layout)) {
+        throw std::runtime_error(
+            "variant " + p_permutation.getKey() + " of " + m_compute_shader_path.string() + " does not match the pipeline layout");
+    }
+
+    // a variant reflecting a smaller range or other stages is still built with the push constant range of the pipeline layout
+    shader.setDescriptorsSetLayout(p_descriptors_set_layout);
+    shader.setPushConstant(m_push_constant_info);
+    shader.createShaderInfo();
+    shader.buildShader();
+    return shader;
+}
+
+void ComputePipeline::reloadShaders() {
+    std::vector<ShaderPermutation> permutations;
+    std::map<uint32_t, std::shared_ptr<DescriptorSetLayout>> descriptors_set_layout;
+    {
+        std::lock_guard<std::mutex> lock(m_reload_mutex);
+        permutations = m_permutations;
+        descriptors_set_layout = getDescriptorsSetLayout();
+    }
+
+    // variant 0 included : the descriptor sets and the pipeline layout are kept, a reloaded shader must fit in them
+    std::vector<Shader> shaders;
+    for (const ShaderPermutation& permutation : permutations) {
+        shaders.push_back(createVariantShader(permutation, descriptors_set_layout));
+    }
+
+    std::lock_guard<std::mutex> lock(m_reload_mutex);
+    m_reloaded_shaders = std::move(shaders);
+}
+
+std::vector<Shader> ComputePipeline::swapReloadedShaders() {
+    std::lock_guard<std::mutex> lock(m_reload_mutex);
+    std::vector<Shader> retired;
+    // the variants added while the reload was running are not replaced
+    for (size_t i = 0; i < m_reloaded_shaders.size() && i < m_compute_shaders.size(); i++) {
+        retired.push_back(std::move(m_compute_shaders[i]));
+        m_compute_shaders[i] = std::move(m_reloaded_shaders[i]);
+    }
+    m_reloaded_shaders.clear();
+    return retired;
+}
+
+std::vector<std::pair<std::filesystem::path, std::vector<std::string>>> ComputePipeline::getShaderSources() {
+    std::lock_guard<std::mutex> lock(m_reload_mutex);
+    std::vector<std::pair<std::filesystem::path, std::vector<std::string>>> sources;
+    for (const ShaderPermutation& permutation : m_permutations) {
+        sources.emplace_back(m_compute_shader_path, permutation.defines);
+    }
+    return sources;
 }
 
 void ComputePipeline::createPipelineLayout() {
     auto pipeline_layout_info = make<VkPipelineLayoutCreateInfo>();
-    std::vector<VkDescriptorSetLayout> descriptor_set_layout_vector;
-    for (auto& descriptor_set_layout : m_compute_shader.getDescriptorsSetLayout()) {
-        descriptor_set_layout_vector.push_back(*descriptor_set_layout);
-    }
-    VkPushConstantRange pc = m_compute_shader.getPushConstants();
+    std::vector<VkDescriptorSetLayout> descriptor_set_layout_vector = m_compute_shaders[0].getVkDescriptorsSetLayout();
+    VkPushConstantRange pc = m_push_constant_info;
     pipeline_layout_info.pushConstantRangeCount = 1;
     pipeline_layout_info.pPushConstantRanges = &pc;
     pipeline_layout_info.setLayoutCount = static_cast<uint32_t>(descriptor_set_layout_vector.size());
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "../../descriptor//descriptorSetLayout.hpp"
@@ -15,7 +18,7 @@ class ComputePipeline : public Pipeline {
    public:
    ComputePipeline() {};
     // Constructor
-    ComputePipeline(Device* p_device, std::filesystem::path p_compute_shader_path);
+    ComputePipeline(Device* p_device, std::filesystem::path p_compute_shader_path, const ShaderPermutation& p_permutation = {});
     // Destructor
     ~ComputePipeline();
 
@@ -28,19 +31,40 @@ class ComputePipeline : public Pipeline {
     ComputePipeline& operator=(ComputePipeline&& other);
 
 
-    void bindPipeline(const CommandBuffer& p_cmd_buffer);
+    // variant 0 is the permutation given to the constructor. A variant shares the pipeline layout, its descriptor sets
+    // must fit in the ones of variant 0. Adding a permutation already added returns its id
+    uint32_t addVariant(const ShaderPermutation& p_permutation);
+
+    void bindPipeline(const CommandBuffer& p_cmd_buffer) { bindPipeline(p_cmd_buffer, 0); }
+    // dispatch uses the work group size of the last bound variant
+    void bindPipeline(const CommandBuffer& p_cmd_buffer, uint32_t p_variant);
     void dispatch(const CommandBuffer& p_cmd_buffer, uint32_t p_nb_of_invocation_x = 1, uint32_t p_nb_of_invocation_y = 1, uint32_t p_nb_of_invocation_z = 1);
 
-    // void reloadShader(VkShaderStageFlagBits shaderStageToReload);
+    void reloadShaders() override;
+    std::vector<Shader> swapReloadedShaders() override;
+    std::vector<std::pair<std::filesystem::path, std::vector<std::string>>> getShaderSources() override;
 
     VkPipelineLayout getPipelineLayout() { return m_pipeline_layout; };
-    std::vector<std::shared_ptr<DescriptorSetLayout>>& getDescriptorsSetLayout() { return m_compute_shader.getDescriptorsSetLayout(); }
+    std::map<uint32_t, std::shared_ptr<DescriptorSetLayout>>& getDescriptorsSetLayout() {
+        return m_compute_shaders[0].getDescriptorsSetLayout();
+    }
 
    private:
-    void createShaders(std::filesystem::path& p_compute_shader_path);
+    void createShaders(const ShaderPermutation& p_permutation);
     void createPipelineLayout();
+    Shader createVariantShader(
+        const ShaderPermutation& p_permutation, const std::map<uint32_t, std::shared_ptr<DescriptorSetLayout>>& p_descriptors_set_layout);
 
-    Shader m_compute_shader;
+    std::filesystem::path m_compute_shader_path;
+    // one shader and permutation per variant
+    std::vector<Shader> m_compute_shaders;
+    std::vector<ShaderPermutation> m_permutations;
+    // built by reloadShaders on a worker, swapped by the render thread. The lock is only taken by the threads changing
+    // the variants, binding them does not
+    std::vector<Shader> m_reloaded_shaders;
+    std::mutex m_reload_mutex;
+    std::unordered_map<std::string, uint32_t> m_variant_ids;
+    uint32_t m_bound_variant = 0;
 
     VkPipelineLayout m_pipeline_layout = VK_NULL_HANDLE;
 
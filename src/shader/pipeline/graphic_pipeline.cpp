@@ -6,31 +6,43 @@
 #include <cstddef>
 
 #include "commandBuffer/command_buffer.hpp"
+#include "shader/hot_reload.hpp"
 #include "struct.hpp"
 #include "structs_vk.hpp"
 
 namespace TTe {
 
-GraphicPipeline::GraphicPipeline(Device* p_device, GraphicPipelineCreateInfo& p_pipeline_create_info) : m_device(p_device) {
+GraphicPipeline::GraphicPipeline(Device* p_device, GraphicPipelineCreateInfo& p_pipeline_create_info)
+    : m_create_info(p_pipeline_create_info), m_device(p_device) {
     setPipelineStage(p_pipeline_create_info);
-    createShaders(p_pipeline_create_info);
+    m_variants.emplace_back();
+    createShaders(p_pipeline_create_info, m_variants.back(), true);
+    m_permutations.push_back(p_pipeline_create_info.permutation);
+    m_variant_ids[p_pipeline_create_info.permutation.getKey()] = 0;
     createPipelineLayout();
     createVertexShaderInfo();
+    HotReload::watch(this);
 }
 
 GraphicPipeline::~GraphicPipeline() {
+    HotReload::unwatch(this);
     // m_shaders_map.clear();
     if (m_vk_pipeline_layout != VK_NULL_HANDLE) vkDestroyPipelineLayout(*m_device, m_vk_pipeline_layout, nullptr);
 }
 
 GraphicPipeline::GraphicPipeline(GraphicPipeline&& other) {
+    // waits for a reload of other still running
+    HotReload::replace(&other, this);
     m_vertex_input_binding = other.m_vertex_input_binding;
     m_vertex_attributes = std::move(other.m_vertex_attributes);
 
-    m_shaders_map = std::move(other.m_shaders_map);
+    m_create_info = other.m_create_info;
+    m_variants = std::move(other.m_variants);
+    m_permutations = std::move(other.m_permutations);
+    m_reloaded_variants = std::move(other.m_reloaded_variants);
+    m_variant_ids = std::move(other.m_variant_ids);
 
     m_pipeline_stage_flags = other.m_pipeline_stage_flags;
-    m_pipeline_descriptors_sets_layout = std::move(other.m_pipeline_descriptors_sets_layout);
     m_pipeline_descriptors_sets_layout_list = std::move(other.m_pipeline_descriptors_sets_layout_list);
     m_vk_pipeline_layout = other.m_vk_pipeline_layout;
     m_push_constant_info = other.m_push_constant_info;
@@ -41,14 +53,19 @@ GraphicPipeline::GraphicPipeline(GraphicPipeline&& other) {
 
 GraphicPipeline& GraphicPipeline::operator=(GraphicPipeline&& other) {
     if (this != &other) {
+        HotReload::unwatch(this);
+        HotReload::replace(&other, this);
         m_vertex_input_binding = other.m_vertex_input_binding;
         m_vertex_attributes = std::move(other.m_vertex_attributes);
 
-        m_shaders_map = std::move(other.m_shaders_map);
+        m_create_info = other.m_create_info;
+        m_variants = std::move(other.m_variants);
+        m_permutations = std::move(other.m_permutations);
+        m_reloaded_variants = std::move(other.m_reloaded_variants);
+        m_variant_ids = std::move(other.m_variant_ids);
 
         m_pipeline_stage_flags = other.m_pipeline_stage_flags;
-        m_pipeline_descriptors_sets_layout = std::move(other.m_pipeline_descriptors_sets_layout);
-        m_pipeline_descriptors_sets_layout_list = std::move(other.m_pipeline_descriptors_sets_layout_list);
+            m_pipeline_descriptors_sets_layout_list = std::move(other.m_pipeline_descriptors_sets_layout_list);
         m_vk_pipeline_layout = other.m_vk_pipeline_layout;
         m_push_constant_info = other.m_push_constant_info;
 
@@ -58,11 +75,27 @@ GraphicPipeline& GraphicPipeline::operator=(GraphicPipeline&& other) {
     return *this;
 }
 
-void GraphicPipeline::bindPipeline(const CommandBuffer& p_cmd_buffer) {
+uint32_t GraphicPipeline::addVariant(const ShaderPermutation& p_permutation) {
+    auto variant = m_variant_ids.find(p_permutation.getKey());
+    if (variant != m_variant_ids.end()) return variant->second;
+
+    GraphicPipelineCreateInfo create_info = m_create_info;
+    create_info.permutation = p_permutation;
+    std::map<VkShaderStageFlagBits, Shader> shaders_map;
+    createShaders(create_info, shaders_map, false);
+
+    std::lock_guard<std::mutex> lock(m_reload_mutex);
+    m_variants.push_back(std::move(shaders_map));
+    m_permutations.push_back(p_permutation);
+    m_variant_ids[p_permutation.getKey()] = m_variants.size() - 1;
+    return m_variants.size() - 1;
+}
+
+void GraphicPipeline::bindPipeline(const CommandBuffer& p_cmd_buffer, uint32_t p_variant) {
     std::vector<VkShaderEXT> shaders;
     std::vector<VkShaderStageFlagBits> shader_flags;
 
-    for (auto& shader : m_shaders_map) {
+    for (auto& shader : m_variants[p_variant]) {
         shaders.push_back(shader.second);
         shader_flags.push_back(shader.first);
     }
@@ -109,73 +142,54 @@ void GraphicPipeline::setPipelineStage(GraphicPipelineCreateInfo& p_pipeline_cre
 }
 
 Shader GraphicPipeline::createFragmentShader(GraphicPipelineCreateInfo& p_pipeline_create_info) {
-    Shader fragment_shader(m_device, p_pipeline_create_info.fragment_shader_file, m_pipeline_stage_flags, 0);
-    // HotReload::addShaderToWatch(p_pipeline_create_info.fragment_shader_file, this);
-    for (auto& descriptor_setlayout : fragment_shader.getDescriptorsSetLayout()) {
-        m_pipeline_descriptors_sets_layout[descriptor_setlayout->getId()] = descriptor_setlayout;
-    }
+    Shader fragment_shader(
+        m_device, p_pipeline_create_info.fragment_shader_file, m_pipeline_stage_flags, 0, p_pipeline_create_info.permutation);
     return fragment_shader;
 }
 
 Shader GraphicPipeline::createTaskShader(GraphicPipelineCreateInfo& p_pipeline_create_info, VkShaderStageFlagBits p_next_stage_flag) {
-    Shader task_shader(m_device, p_pipeline_create_info.vexter_shader_file, m_pipeline_stage_flags, p_next_stage_flag);
-    // HotReload::addShaderToWatch(p_pipeline_create_info.vexter_shader_file, this);
-    for (auto& descriptor_setlayout : task_shader.getDescriptorsSetLayout()) {
-        m_pipeline_descriptors_sets_layout[descriptor_setlayout->getId()] = descriptor_setlayout;
-    }
+    Shader task_shader(
+        m_device, p_pipeline_create_info.vexter_shader_file, m_pipeline_stage_flags, p_next_stage_flag, p_pipeline_create_info.permutation);
     return task_shader;
 }
 
 Shader GraphicPipeline::createMeshShader(GraphicPipelineCreateInfo& p_pipeline_create_info, VkShaderStageFlagBits p_next_stage_flag) {
-    Shader mesh_shader(m_device, p_pipeline_create_info.vexter_shader_file, m_pipeline_stage_flags, p_next_stage_flag);
-    // HotReload::addShaderToWatch(p_pipeline_create_info.vexter_shader_file, this);
-    for (auto& descriptor_setlayout : mesh_shader.getDescriptorsSetLayout()) {
-        m_pipeline_descriptors_sets_layout[descriptor_setlayout->getId()] = descriptor_setlayout;
-    }
+    Shader mesh_shader(
+        m_device, p_pipeline_create_info.vexter_shader_file, m_pipeline_stage_flags, p_next_stage_flag, p_pipeline_create_info.permutation);
     return mesh_shader;
 }
 
 Shader GraphicPipeline::createVertexShader(GraphicPipelineCreateInfo& p_pipeline_create_info, VkShaderStageFlagBits p_next_stage_flag) {
-    Shader vertex_shader(m_device, p_pipeline_create_info.vexter_shader_file, m_pipeline_stage_flags, p_next_stage_flag);
-    // HotReload::addShaderToWatch(p_pipeline_create_info.vexter_shader_file, this);
-    for (auto& descriptor_setlayout : vertex_shader.getDescriptorsSetLayout()) {
-        m_pipeline_descriptors_sets_layout[descriptor_setlayout->getId()] = descriptor_setlayout;
-    }
+    Shader vertex_shader(
+        m_device, p_pipeline_create_info.vexter_shader_file, m_pipeline_stage_flags, p_next_stage_flag, p_pipeline_create_info.permutation);
     return vertex_shader;
 }
 
 Shader GraphicPipeline::createTesselationControlShader(
     GraphicPipelineCreateInfo& p_pipeline_create_info, VkShaderStageFlagBits p_next_stage_flag) {
     Shader tesselation_control_shader(
-        m_device, p_pipeline_create_info.tesselation_control_shader_file, m_pipeline_stage_flags, p_next_stage_flag);
-    // HotReload::addShaderToWatch(p_pipeline_create_info.tesselation_control_shader_file, this);
-    for (auto& descriptor_setlayout : tesselation_control_shader.getDescriptorsSetLayout()) {
-        m_pipeline_descriptors_sets_layout[descriptor_setlayout->getId()] = descriptor_setlayout;
-    }
+        m_device, p_pipeline_create_info.tesselation_control_shader_file, m_pipeline_stage_flags, p_next_stage_flag,
+        p_pipeline_create_info.permutation);
     return tesselation_control_shader;
 }
 
 Shader GraphicPipeline::createTesselationEvaluationShader(
     GraphicPipelineCreateInfo& p_pipeline_create_info, VkShaderStageFlagBits p_next_stage_flag) {
     Shader tesselation_evaluation_shader(
-        m_device, p_pipeline_create_info.tesselation_evaluation_shader_file, m_pipeline_stage_flags, p_next_stage_flag);
-    // HotReload::addShaderToWatch(p_pipeline_create_info.tesselation_evaluation_shader_file, this);
-    for (auto& descriptor_setlayout : tesselation_evaluation_shader.getDescriptorsSetLayout()) {
-        m_pipeline_descriptors_sets_layout[descriptor_setlayout->getId()] = descriptor_setlayout;
-    }
+        m_device, p_pipeline_create_info.tesselation_evaluation_shader_file, m_pipeline_stage_flags, p_next_stage_flag,
+        p_pipeline_create_info.permutation);
     return tesselation_evaluation_shader;
 }
 
 Shader GraphicPipeline::createGeometryShader(GraphicPipelineCreateInfo& p_pipeline_create_info, VkShaderStageFlagBits p_next_stage_flag) {
-    Shader geometry_shader(m_device, p_pipeline_create_info.geometry_shader_file, m_pipeline_stage_flags, p_next_stage_flag);
-    // HotReload::addShaderToWatch(p_pipeline_create_info.geometry_shader_file, this);
-    for (auto& descriptor_setlayout : geometry_shader.getDescriptorsSetLayout()) {
-        m_pipeline_descriptors_sets_layout[descriptor_setlayout->getId()] = descriptor_setlayout;
-    }
+    Shader geometry_shader(
+        m_device, p_pipeline_create_info.geometry_shader_file, m_pipeline_stage_flags, p_next_stage_flag,
+        p_pipeline_create_info.permutation);
     return geometry_shader;
 }
 
-void GraphicPipeline::createShaders(GraphicPipelineCreateInfo& p_pipeline_create_info) {
+void GraphicPipeline::createShaders(
+    GraphicPipelineCreateInfo& p_pipeline_create_info, std::map<VkShaderStageFlagBits, Shader>& p_shaders_map, bool p_base_variant) {
     assert(
         (!p_pipeline_create_info.fragment_shader_file.empty() && !p_pipeline_create_info.vexter_shader_file.empty()) &&
         "Un vertex et un fragment shader sont requi pour faire une pipeline");
@@ -184,10 +198,10 @@ void GraphicPipeline::createShaders(GraphicPipelineCreateInfo& p_pipeline_create
     VkShaderStageFlagBits next_stage_flag;
 
     if (!p_pipeline_create_info.task_shader_file.empty()) {
-        m_shaders_map[VK_SHADER_STAGE_TASK_BIT_EXT] = createTaskShader(p_pipeline_create_info, VK_SHADER_STAGE_MESH_BIT_EXT);
-        builds_shader_vector.push_back(&m_shaders_map[VK_SHADER_STAGE_TASK_BIT_EXT]);
-        m_shaders_map[VK_SHADER_STAGE_MESH_BIT_EXT] = createMeshShader(p_pipeline_create_info, VK_SHADER_STAGE_FRAGMENT_BIT);
-        builds_shader_vector.push_back(&m_shaders_map[VK_SHADER_STAGE_MESH_BIT_EXT]);
+        p_shaders_map[VK_SHADER_STAGE_TASK_BIT_EXT] = createTaskShader(p_pipeline_create_info, VK_SHADER_STAGE_MESH_BIT_EXT);
+        builds_shader_vector.push_back(&p_shaders_map[VK_SHADER_STAGE_TASK_BIT_EXT]);
+        p_shaders_map[VK_SHADER_STAGE_MESH_BIT_EXT] = createMeshShader(p_pipeline_create_info, VK_SHADER_STAGE_FRAGMENT_BIT);
+        builds_shader_vector.push_back(&p_shaders_map[VK_SHADER_STAGE_MESH_BIT_EXT]);
 
 
     } else {
@@ -199,14 +213,14 @@ void GraphicPipeline::createShaders(GraphicPipelineCreateInfo& p_pipeline_create
             next_stage_flag = VK_SHADER_STAGE_FRAGMENT_BIT;
         }
 
-        m_shaders_map[VK_SHADER_STAGE_VERTEX_BIT] = createVertexShader(p_pipeline_create_info, next_stage_flag);
-        builds_shader_vector.push_back(&m_shaders_map[VK_SHADER_STAGE_VERTEX_BIT]);
+        p_shaders_map[VK_SHADER_STAGE_VERTEX_BIT] = createVertexShader(p_pipeline_create_info, next_stage_flag);
+        builds_shader_vector.push_back(&p_shaders_map[VK_SHADER_STAGE_VERTEX_BIT]);
 
         if (!p_pipeline_create_info.tesselation_evaluation_shader_file.empty()) {
             next_stage_flag = VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
-            m_shaders_map[VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT] =
+            p_shaders_map[VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT] =
                 createTesselationEvaluationShader(p_pipeline_create_info, next_stage_flag);
-            builds_shader_vector.push_back(&m_shaders_map[VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT]);
+            builds_shader_vector.push_back(&p_shaders_map[VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT]);
 
             if (!p_pipeline_create_info.geometry_shader_file.empty()) {
                 next_stage_flag = VK_SHADER_STAGE_GEOMETRY_BIT;
@@ -214,34 +228,66 @@ void GraphicPipeline::createShaders(GraphicPipelineCreateInfo& p_pipeline_create
                 next_stage_flag = VK_SHADER_STAGE_FRAGMENT_BIT;
             }
 
-            m_shaders_map[VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT] =
+            p_shaders_map[VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT] =
                 createTesselationControlShader(p_pipeline_create_info, next_stage_flag);
-            builds_shader_vector.push_back(&m_shaders_map[VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT]);
+            builds_shader_vector.push_back(&p_shaders_map[VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT]);
         }
 
         if (!p_pipeline_create_info.geometry_shader_file.empty()) {
             next_stage_flag = VK_SHADER_STAGE_FRAGMENT_BIT;
-            m_shaders_map[VK_SHADER_STAGE_GEOMETRY_BIT] = createGeometryShader(p_pipeline_create_info, next_stage_flag);
-            builds_shader_vector.push_back(&m_shaders_map[VK_SHADER_STAGE_GEOMETRY_BIT]);
+            p_shaders_map[VK_SHADER_STAGE_GEOMETRY_BIT] = createGeometryShader(p_pipeline_create_info, next_stage_flag);
+            builds_shader_vector.push_back(&p_shaders_map[VK_SHADER_STAGE_GEOMETRY_BIT]);
         }
     }
 
-    m_shaders_map[VK_SHADER_STAGE_FRAGMENT_BIT] = createFragmentShader(p_pipeline_create_info);
-    builds_shader_vector.push_back(&m_shaders_map[VK_SHADER_STAGE_FRAGMENT_BIT]);
+    p_shaders_map[VK_SHADER_STAGE_FRAGMENT_BIT] = createFragmentShader(p_pipeline_create_info);
+    builds_shader_vector.push_back(&p_shaders_map[VK_SHADER_STAGE_FRAGMENT_BIT]);
+
+    // every stage is built with the same set layouts, the ones of the pipeline layout
+    std::map<uint32_t, std::shared_ptr<DescriptorSetLayout>> descriptors_set_layout =
+        Shader::mergeDescriptorsSetLayout(m_device, builds_shader_vector);
+    for (auto& shared : p_pipeline_create_info.shared_descriptors_set_layout) {
+        auto merged = descriptors_set_layout.find(shared.first);
+        if (merged != descriptors_set_layout.end() &&
+            (!shared.second->contains(*merged->second) ||
+             (merged->second->getVariableBinding() != DescriptorSetLayout::s_no_variable_binding &&
+              merged->second->getVariableBinding() != shared.second->getVariableBinding()))) {
+            throw std::runtime_error("set " + std::to_string(shared.first) + " does not fit in the shared set layout");
+        }
+        descriptors_set_layout[shared.first] = shared.second;
+    }
+    if (p_base_variant) {
+        m_pipeline_descriptors_sets_layout_list = descriptors_set_layout;
+    } else {
+        for (Shader* shader : builds_shader_vector) {
+            if (!shader->fitsDescriptorsSetLayout(m_pipeline_descriptors_sets_layout_list)) {
+                throw std::runtime_error("variant " + p_pipeline_create_info.permutation.getKey() + " does not match the pipeline layout");
+            }
+        }
+    }
+    for (Shader* shader : builds_shader_vector) {
+        shader->setDescriptorsSetLayout(m_pipeline_descriptors_sets_layout_list);
+    }
 
-    m_push_constant_info = make<VkPushConstantRange>();
+    VkPushConstantRange push_constant_info = make<VkPushConstantRange>();
     // parcour the shaders to get the push constant
-    for (auto& shader : m_shaders_map) {
+    for (auto& shader : p_shaders_map) {
         auto shader_push_constant_info = shader.second.getPushConstants();
-        m_push_constant_info.stageFlags |= shader.first;
+        push_constant_info.stageFlags |= shader.first;
         if (shader_push_constant_info.size > 0) {
-            if (shader_push_constant_info.size > m_push_constant_info.size) {
-                m_push_constant_info.size = shader_push_constant_info.size;
+            if (shader_push_constant_info.size > push_constant_info.size) {
+                push_constant_info.size = shader_push_constant_info.size;
             }
         }
     }
+    // the variants use the push constant range of the pipeline layout
+    if (p_base_variant) {
+        m_push_constant_info = push_constant_info;
+    } else if (push_constant_info.size > m_push_constant_info.size) {
+        throw std::runtime_error("variant " + p_pipeline_create_info.permutation.getKey() + " does not match the pipeline layout");
+    }
 
-    for (auto& shader : m_shaders_map) {
+    for (auto& shader : p_shaders_map) {
         shader.second.setPushConstant(m_push_constant_info);
         shader.second.createShaderInfo();
     }
@@ -250,23 +296,53 @@ void GraphicPipeline::createShaders(GraphicPipelineCreateInfo& p_pipeline_create
     Shader::buildLinkedShaders(m_device, builds_shader_vector);
 }
 
-void GraphicPipeline::reloadShader(VkShaderStageFlagBits p_shader_stage_to_reload) {
-    // m_shaders_map[shaderStageToReload]->reloadShaderData();
-    // std::vector<Shader*> buildsShaderVector;
-    // for (auto& shader : m_shaders_map) {
-    //     vkDestroyShaderEXT(m_device->m_device(), shader.second->getShaderHandler(), nullptr);
-    //     buildsShaderVector.push_back(shader.second);
-    // }
-    // Shader::buildLinkedShaders(m_device, buildsShaderVector);
+void GraphicPipeline::reloadShaders() {
+    std::vector<ShaderPermutation> permutations;
+    {
+        std::lock_guard<std::mutex> lock(m_reload_mutex);
+        permutations = m_permutations;
+    }
+
+    // variant 0 included : the descriptor sets and the pipeline layout are kept, a reloaded variant must fit in them
+    std::vector<std::map<VkShaderStageFlagBits, Shader>> variants(permutations.size());
+    for (size_t i = 0; i < permutations.size(); i++) {
+        GraphicPipelineCreateInfo create_info = m_create_info;
+        create_info.permutation = permutations[i];
+        createShaders(create_info, variants[i], false);
+    }
+
+    std::lock_guard<std::mutex> lock(m_reload_mutex);
+    m_reloaded_variants = std::move(variants);
 }
 
-void GraphicPipeline::createPipelineLayout() {
-    std::vector<VkDescriptorSetLayout> descriptor_set_layout_vector;
+std::vector<Shader> GraphicPipeline::swapReloadedShaders() {
+    std::lock_guard<std::mutex> lock(m_reload_mutex);
+    std::vector<Shader> retired;
+    // the variants added while the reload was running are not replaced
+    for (size_t i = 0; i < m_reloaded_variants.size() && i < m_variants.size(); i++) {
+        for (auto& shader : m_variants[i]) retired.push_back(std::move(shader.second));
+        m_variants[i] = std::move(m_reloaded_variants[i]);
+    }
+    m_reloaded_variants.clear();
+    return retired;
+}
 
-    for (auto& descriptor_set_layout : m_pipeline_descriptors_sets_layout) {
-        m_pipeline_descriptors_sets_layout_list[descriptor_set_layout.first[0]] = descriptor_set_layout.second;
+std::vector<std::pair<std::filesystem::path, std::vector<std::string>>> GraphicPipeline::getShaderSources() {
+    std::lock_guard<std::mutex> lock(m_reload_mutex);
+    std::vector<std::pair<std::filesystem::path, std::vector<std::string>>> sources;
+    for (const ShaderPermutation& permutation : m_permutations) {
+        for (const std::filesystem::path* file :
+             {&m_create_info.task_shader_file, &m_create_info.vexter_shader_file, &m_create_info.fragment_shader_file,
+              &m_create_info.tesselation_control_shader_file, &m_create_info.tesselation_evaluation_shader_file,
+              &m_create_info.geometry_shader_file}) {
+            if (!file->empty()) sources.emplace_back(*file, permutation.defines);
+        }
     }
+    return sources;
+}
 
+void GraphicPipeline::createPipelineLayout() {
+    std::vector<VkDescriptorSetLayout> descriptor_set_layout_vector;
     for (auto& descriptor_set_layout : m_pipeline_descriptors_sets_layout_list) {
         descriptor_set_layout_vector.push_back(*descriptor_set_layout.second);
     }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <mutex>
+
 #include "commandBuffer/command_buffer.hpp"
 #include "shader/pipeline.hpp"
 #include "shader/shader.hpp"
@@ -13,6 +15,11 @@ struct GraphicPipelineCreateInfo{
     std::filesystem::path tesselation_control_shader_file;
     std::filesystem::path tesselation_evaluation_shader_file;
     std::filesystem::path geometry_shader_file;
+    // defines and specialization constants of every stage
+    ShaderPermutation permutation;
+    // set layouts taken from another pipeline, a descriptor set is then bound with both. The bindings of the stages must fit
+    // in them
+    std::map<uint32_t, std::shared_ptr<DescriptorSetLayout>> shared_descriptors_set_layout;
 };
 
 class GraphicPipeline : public Pipeline {
@@ -32,11 +39,21 @@ class GraphicPipeline : public Pipeline {
     std::shared_ptr<DescriptorSetLayout> getDescriptorSetLayout(uint32_t p_id){return m_pipeline_descriptors_sets_layout_list[p_id];}
     
 
-    void bindPipeline(const CommandBuffer &p_cmd_buffer);
-    void reloadShader(VkShaderStageFlagBits p_shader_stage_to_reload);
+    // variant 0 is the permutation of the create info, a variant compiles every stage with p_permutation. It shares the
+    // pipeline layout : its descriptor sets must fit in the ones of variant 0. Adding a permutation already added returns its id
+    uint32_t addVariant(const ShaderPermutation &p_permutation);
+
+    void bindPipeline(const CommandBuffer &p_cmd_buffer) { bindPipeline(p_cmd_buffer, 0); }
+    void bindPipeline(const CommandBuffer &p_cmd_buffer, uint32_t p_variant);
+
+    void reloadShaders() override;
+    std::vector<Shader> swapReloadedShaders() override;
+    std::vector<std::pair<std::filesystem::path, std::vector<std::string>>> getShaderSources() override;
    private:
 
-    void createShaders(GraphicPipelineCreateInfo& p_pipeline_create_info);
+    // p_base_variant sets the layouts of the pipeline, the other variants must fit in them
+    void createShaders(
+        GraphicPipelineCreateInfo& p_pipeline_create_info, std::map<VkShaderStageFlagBits, Shader>& p_shaders_map, bool p_base_variant);
 
     Shader  createFragmentShader(GraphicPipelineCreateInfo& p_pipeline_create_info);
     Shader  createTaskShader(GraphicPipelineCreateInfo& p_pipeline_create_info, VkShaderStageFlagBits p_next_stage_flag);
@@ -59,9 +76,16 @@ class GraphicPipeline : public Pipeline {
     VkVertexInputBindingDescription2EXT m_vertex_input_binding = {};
     std::vector<VkVertexInputAttributeDescription2EXT> m_vertex_attributes;
 
-    std::map<VkShaderStageFlagBits, Shader> m_shaders_map;
+    GraphicPipelineCreateInfo m_create_info;
+    // linked shaders of every stage and permutation, one per variant
+    std::vector<std::map<VkShaderStageFlagBits, Shader>> m_variants;
+    std::vector<ShaderPermutation> m_permutations;
+    // built by reloadShaders on a worker, swapped by the render thread. The lock is only taken by the threads changing
+    // the variants, binding them does not
+    std::vector<std::map<VkShaderStageFlagBits, Shader>> m_reloaded_variants;
+    std::mutex m_reload_mutex;
+    std::unordered_map<std::string, uint32_t> m_variant_ids;
     
-    std::unordered_map<std::vector<uint32_t>, std::shared_ptr<DescriptorSetLayout>> m_pipeline_descriptors_sets_layout;
     std::map<uint32_t ,std::shared_ptr<DescriptorSetLayout>> m_pipeline_descriptors_sets_layout_list;
 
     
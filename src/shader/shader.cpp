@@ -1,293 +1,49 @@
 
 #include "shader.hpp"
 
-#include <glslang/Include/glslang_c_interface.h>
-
-// Required for use of glslang_default_resource
-#include <glslang/Include/glslang_c_shader_types.h>
-#include <glslang/Public/resource_limits_c.h>
-
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <filesystem>
-#include <fstream>
-#include <iostream>
 #include <map>
-#include <ostream>
 #include <stdexcept>
 #include <string>
 #include <vector>
 
-#include "md5.h"
-#include "spirv.hpp"
-#include "spirv_cross.hpp"
+#include "shader/shader_manager.hpp"
 #include "structs_vk.hpp"
 #include "volk.h"
 
-#ifndef ENGINE_DIR
-#define ENGINE_DIR "../"
-#endif
-
 namespace TTe {
-void addSamplerBinding(
-    spirv_cross::SmallVector<spirv_cross::Resource> &p_separate_samplers,
-    spirv_cross::Compiler &p_comp,
-    std::map<uint32_t, std::map<uint32_t, VkDescriptorSetLayoutBinding>> &p_set_bindings,
-    VkShaderStageFlags descriptor_stage) {
-    for (const spirv_cross::Resource &resource : p_separate_samplers) {
-        VkDescriptorSetLayoutBinding binding = make<VkDescriptorSetLayoutBinding>();
-        const spirv_cross::SPIRType &m_type = p_comp.get_type(resource.type_id);
-        uint32_t set = p_comp.get_decoration(resource.id, spv::DecorationDescriptorSet);
-        binding.binding = p_comp.get_decoration(resource.id, spv::DecorationBinding);
-
-        if (m_type.array.size() > 0) {
-            binding.descriptorCount = m_type.array[0];
-            if (binding.descriptorCount == 1) {
-                binding.descriptorCount = 1000;
-            }
-        } else {
-            binding.descriptorCount = 1;
-        }
-        binding.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
-        binding.stageFlags = descriptor_stage;
-        p_set_bindings[set][binding.binding] = binding;
-    }
-}
 
-void addSampledImagesBinding(
-    spirv_cross::SmallVector<spirv_cross::Resource> &p_sampled_images,
-    spirv_cross::Compiler &p_comp,
-    std::map<uint32_t, std::map<uint32_t, VkDescriptorSetLayoutBinding>> &p_set_bindings,
-    VkShaderStageFlags descriptor_stage) {
-    for (const spirv_cross::Resource &resource : p_sampled_images) {
-        VkDescriptorSetLayoutBinding binding = make<VkDescriptorSetLayoutBinding>();
-        const spirv_cross::SPIRType &m_type = p_comp.get_type(resource.type_id);
-        uint32_t set = p_comp.get_decoration(resource.id, spv::DecorationDescriptorSet);
-        binding.binding = p_comp.get_decoration(resource.id, spv::DecorationBinding);
-
-        if (m_type.array.size() > 0) {
-            binding.descriptorCount = m_type.array[0];
-            if (binding.descriptorCount == 1) {
-                binding.descriptorCount = 1000;
-            }
-        } else {
-            binding.descriptorCount = 1;
-        }
-        binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        binding.stageFlags = descriptor_stage;
-        p_set_bindings[set][binding.binding] = binding;
-    }
+std::string ShaderPermutation::getKey() const {
+    std::string key;
+    for (const std::string &define : defines) key += define + ";";
+    for (auto &constant : constants) key += "#" + std::to_string(constant.first) + "=" + std::to_string(constant.second) + ";";
+    return key;
 }
 
-void addSeparateImagesBinding(
-    spirv_cross::SmallVector<spirv_cross::Resource> &p_separate_images,
-    spirv_cross::Compiler &p_comp,
-    std::map<uint32_t, std::map<uint32_t, VkDescriptorSetLayoutBinding>> &p_set_bindings,
-    VkShaderStageFlags descriptor_stage) {
-    for (const spirv_cross::Resource &resource : p_separate_images) {
-        if (p_comp.get_type(resource.type_id).image.dim != spv::DimBuffer) {
-            VkDescriptorSetLayoutBinding binding = make<VkDescriptorSetLayoutBinding>();
-            const spirv_cross::SPIRType &m_type = p_comp.get_type(resource.type_id);
-            uint32_t set = p_comp.get_decoration(resource.id, spv::DecorationDescriptorSet);
-            binding.binding = p_comp.get_decoration(resource.id, spv::DecorationBinding);
-
-            if (m_type.array.size() > 0) {
-                binding.descriptorCount = m_type.array[0];
-                if (binding.descriptorCount == 1) {
-                    binding.descriptorCount = 1000;
-                }
-            } else {
-                binding.descriptorCount = 1;
-            }
-            binding.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-            binding.stageFlags = descriptor_stage;
-            p_set_bindings[set][binding.binding] = binding;
-        }
-    }
-}
-
-void addStorageImagesBinding(
-    spirv_cross::SmallVector<spirv_cross::Resource> &p_storage_images,
-    spirv_cross::Compiler &p_comp,
-    std::map<uint32_t, std::map<uint32_t, VkDescriptorSetLayoutBinding>> &p_set_bindings,
-    VkShaderStageFlags descriptor_stage) {
-    for (const spirv_cross::Resource &resource : p_storage_images) {
-        if (p_comp.get_type(resource.type_id).image.dim != spv::DimBuffer) {
-            VkDescriptorSetLayoutBinding binding = make<VkDescriptorSetLayoutBinding>();
-            const spirv_cross::SPIRType &m_type = p_comp.get_type(resource.type_id);
-            uint32_t set = p_comp.get_decoration(resource.id, spv::DecorationDescriptorSet);
-            binding.binding = p_comp.get_decoration(resource.id, spv::DecorationBinding);
-
-            if (m_type.array.size() > 0) {
-                binding.descriptorCount = m_type.array[0];
-                if (binding.descriptorCount == 1) {
-                    binding.descriptorCount = 1000;
-                }
-            } else {
-                binding.descriptorCount = 1;
-            }
-            binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-            binding.stageFlags = descriptor_stage;
-            p_set_bindings[set][binding.binding] = binding;
-        }
-    }
-}
-
-void addUniformTexelBufferBinding(
-    spirv_cross::SmallVector<spirv_cross::Resource> &p_separate_images,
-    spirv_cross::Compiler &p_comp,
-    std::map<uint32_t, std::map<uint32_t, VkDescriptorSetLayoutBinding>> &p_set_bindings,
-    VkShaderStageFlags descriptor_stage) {
-    for (const spirv_cross::Resource &resource : p_separate_images) {
-        if (p_comp.get_type(resource.type_id).image.dim == spv::DimBuffer) {
-            VkDescriptorSetLayoutBinding binding = make<VkDescriptorSetLayoutBinding>();
-            const spirv_cross::SPIRType &m_type = p_comp.get_type(resource.type_id);
-            uint32_t set = p_comp.get_decoration(resource.id, spv::DecorationDescriptorSet);
-            binding.binding = p_comp.get_decoration(resource.id, spv::DecorationBinding);
-
-            if (m_type.array.size() > 0) {
-                binding.descriptorCount = m_type.array[0];
-                if (binding.descriptorCount == 1) {
-                    binding.descriptorCount = 1000;
-                }
-            } else {
-                binding.descriptorCount = 1;
-            }
-            binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
-            binding.stageFlags = descriptor_stage;
-            p_set_bindings[set][binding.binding] = binding;
-        }
-    }
-}
-
-void addStorageTexelBufferBinding(
-    spirv_cross::SmallVector<spirv_cross::Resource> &p_storage_images,
-    spirv_cross::Compiler &p_comp,
-    std::map<uint32_t, std::map<uint32_t, VkDescriptorSetLayoutBinding>> &p_set_bindings,
-    VkShaderStageFlags descriptor_stage) {
-    for (const spirv_cross::Resource &resource : p_storage_images) {
-        if (p_comp.get_type(resource.type_id).image.dim == spv::DimBuffer) {
-            VkDescriptorSetLayoutBinding binding = make<VkDescriptorSetLayoutBinding>();
-            const spirv_cross::SPIRType &m_type = p_comp.get_type(resource.type_id);
-            uint32_t set = p_comp.get_decoration(resource.id, spv::DecorationDescriptorSet);
-            binding.binding = p_comp.get_decoration(resource.id, spv::DecorationBinding);
-
-            if (m_type.array.size() > 0) {
-                binding.descriptorCount = m_type.array[0];
-                if (binding.descriptorCount == 1) {
-                    binding.descriptorCount = 1000;
-                }
-            } else {
-                binding.descriptorCount = 1;
-            }
-            binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER;
-            binding.stageFlags = descriptor_stage;
-            p_set_bindings[set][binding.binding] = binding;
-        }
-    }
-}
-
-void addUniformBufferBinding(
-    spirv_cross::SmallVector<spirv_cross::Resource> &p_uniform_buffers,
-    spirv_cross::Compiler &p_comp,
-    std::map<uint32_t, std::map<uint32_t, VkDescriptorSetLayoutBinding>> &p_set_bindings,
-    VkShaderStageFlags descriptor_stage) {
-    for (const spirv_cross::Resource &resource : p_uniform_buffers) {
-        VkDescriptorSetLayoutBinding binding = make<VkDescriptorSetLayoutBinding>();
-
-        const spirv_cross::SPIRType &m_type = p_comp.get_type(resource.type_id);
-        uint32_t set = p_comp.get_decoration(resource.id, spv::DecorationDescriptorSet);
-        binding.binding = p_comp.get_decoration(resource.id, spv::DecorationBinding);
-
-        if (m_type.array.size() > 0) {
-            binding.descriptorCount = m_type.array[0];
-            if (binding.descriptorCount == 1) {
-                binding.descriptorCount = 1000;
-            }
-        } else {
-            binding.descriptorCount = 1;
-        }
-        binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        binding.stageFlags = descriptor_stage;
-        p_set_bindings[set][binding.binding] = binding;
-    }
-}
-
-void addStorageBufferBinding(
-    spirv_cross::SmallVector<spirv_cross::Resource> &p_storage_buffers,
-    spirv_cross::Compiler &p_comp,
-    std::map<uint32_t, std::map<uint32_t, VkDescriptorSetLayoutBinding>> &p_set_bindings,
-    VkShaderStageFlags descriptor_stage) {
-    for (const spirv_cross::Resource &resource : p_storage_buffers) {
-        VkDescriptorSetLayoutBinding binding = make<VkDescriptorSetLayoutBinding>();
-        const spirv_cross::SPIRType &m_type = p_comp.get_type(resource.type_id);
-        uint32_t set = p_comp.get_decoration(resource.id, spv::DecorationDescriptorSet);
-        binding.binding = p_comp.get_decoration(resource.id, spv::DecorationBinding);
-
-        if (m_type.array.size() > 0) {
-            binding.descriptorCount = m_type.array[0];
-            if (binding.descriptorCount == 1) {
-                binding.descriptorCount = 1000;
-            }
-        } else {
-            binding.descriptorCount = 1;
-        }
-        binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-        binding.stageFlags = descriptor_stage;
-        p_set_bindings[set][binding.binding] = binding;
-    }
-}
-
-void addAccelerationStructureBinding(
-    spirv_cross::SmallVector<spirv_cross::Resource> &p_acceleration_structures,
-    spirv_cross::Compiler &p_comp,
-    std::map<uint32_t, std::map<uint32_t, VkDescriptorSetLayoutBinding>> &p_set_bindings,
-    VkShaderStageFlags descriptor_stage) {
-    for (const spirv_cross::Resource &resource : p_acceleration_structures) {
-        VkDescriptorSetLayoutBinding binding = make<VkDescriptorSetLayoutBinding>();
-        const spirv_cross::SPIRType &m_type = p_comp.get_type(resource.type_id);
-        uint32_t set = p_comp.get_decoration(resource.id, spv::DecorationDescriptorSet);
-        binding.binding = p_comp.get_decoration(resource.id, spv::DecorationBinding);
-
-        if (m_type.array.size() > 0) {
-            binding.descriptorCount = m_type.array[0];
-            if (binding.descriptorCount == 1) {
-                binding.descriptorCount = 1000;
-            }
-        } else {
-            binding.descriptorCount = 1;
-        }
-        binding.descriptorType = VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
-        binding.stageFlags = descriptor_stage;
-        p_set_bindings[set][binding.binding] = binding;
-    }
-}
-}  // namespace TTe
-
-namespace TTe {
-
 Shader::Shader() {}
 
-Shader::Shader(Device *p_device, std::filesystem::path p_shader_path, VkShaderStageFlags p_descriptor_stage, VkShaderStageFlags p_next_shader_stage)
+Shader::Shader(
+    Device *p_device,
+    std::filesystem::path p_shader_path,
+    VkShaderStageFlags p_descriptor_stage,
+    VkShaderStageFlags p_next_shader_stage,
+    const ShaderPermutation &p_permutation)
     : m_shader_path(p_shader_path), m_next_shader_stage(p_next_shader_stage), m_device(p_device) {
     m_shader_stage = getShaderStageFlagsBitFromFileName(m_shader_path);
-    loadShaderGLSLCode();
+    // compiled by the precompilation of Engine::init, or now for a variant or a shader outside the shader folder
+    m_compiled = ShaderManager::get(m_shader_path, p_permutation.defines);
 
-    std::filesystem::path shader_file = std::filesystem::path(m_shader_path).filename();
-    std::filesystem::path shader_folder = std::filesystem::path(m_shader_path).parent_path();
-
-    if (!std::ifstream((std::filesystem::path(ENGINE_DIR) / shader_folder / "spirv" / shader_file).concat(".spv")).good() ||
-        getSavedHash() != getShaderSourceCodeHash()) {
-        compileToSPIRV();
+    for (auto &constant : p_permutation.constants) {
+        m_specialization_entries.push_back({constant.first, uint32_t(m_specialization_data.size() * sizeof(uint32_t)), sizeof(uint32_t)});
+        m_specialization_data.push_back(constant.second);
     }
 
-    loadShaderSPVCode();
     createDescriptorSetLayout(p_descriptor_stage);
     createPushConstant(p_descriptor_stage);
     createShaderInfo();
-
-    // shaderCode.clear();
-    m_shader_source_code.clear();
 }
 
 Shader::~Shader() {
@@ -308,9 +64,13 @@ Shader::Shader(Shader &&other) {
     m_next_shader_stage = other.m_next_shader_stage;
     m_shader_stage = other.m_shader_stage;
     m_device = other.m_device;
-    m_shader_code = std::move(other.m_shader_code);
+    m_compiled = std::move(other.m_compiled);
     m_descriptors_set_layout = std::move(other.m_descriptors_set_layout);
     m_compute_work_group_size = other.m_compute_work_group_size;
+    m_specialization_entries = std::move(other.m_specialization_entries);
+    m_specialization_data = std::move(other.m_specialization_data);
+    m_specialization_info = other.m_specialization_info;
+    updateCreateInfoPointers();
     other.m_shader = VK_NULL_HANDLE;
     other.m_shader_module = VK_NULL_HANDLE;
 }
@@ -331,256 +91,157 @@ Shader &Shader::operator=(Shader &&other) {
         m_next_shader_stage = other.m_next_shader_stage;
         m_shader_stage = other.m_shader_stage;
         m_device = other.m_device;
-        m_shader_code = std::move(other.m_shader_code);
+        m_compiled = std::move(other.m_compiled);
         m_descriptors_set_layout = std::move(other.m_descriptors_set_layout);
         m_compute_work_group_size = other.m_compute_work_group_size;
+        m_specialization_entries = std::move(other.m_specialization_entries);
+        m_specialization_data = std::move(other.m_specialization_data);
+        m_specialization_info = other.m_specialization_info;
+        updateCreateInfoPointers();
         other.m_shader = VK_NULL_HANDLE;
         other.m_shader_module = VK_NULL_HANDLE;
     }
     return *this;
 }
 
-void Shader::loadShaderSPVCode() {
-    std::filesystem::path shader_file = std::filesystem::path(m_shader_path).filename();
-    std::filesystem::path shader_folder = std::filesystem::path(m_shader_path).parent_path();
-
-    m_shader_code.clear();
-    std::filesystem::path m_shader_path = std::filesystem::path(ENGINE_DIR) / shader_folder / "spirv" / shader_file;
-    m_shader_path.concat(".spv");
-    std::ifstream file{m_shader_path, std::ios::ate | std::ios::binary};
-    if (!file.is_open()) {
-        throw std::runtime_error(
-            "failed to open file :" / std::filesystem::path(ENGINE_DIR) / shader_folder / "spirv" / shader_file / ".spv");
-    }
-
-    size_t file_size = static_cast<size_t>(file.tellg());
-    m_shader_code.resize(file_size / sizeof(uint32_t));
-    file.seekg(0);
-    file.read(reinterpret_cast<char *>(m_shader_code.data()), file_size);
-    file.close();
-    m_shader_create_info.codeSize = m_shader_code.size() * sizeof(m_shader_code[0]);
-    m_shader_create_info.pCode = m_shader_code.data();
-}
-
-void Shader::loadShaderGLSLCode() {
-    std::ifstream file{ENGINE_DIR / m_shader_path, std::ios::ate};
-    if (!file.is_open()) {
-        throw std::runtime_error("failed to open file :" / std::filesystem::path(ENGINE_DIR) / m_shader_path);
+void Shader::createDescriptorSetLayout(VkShaderStageFlags p_descriptor_stage) {
+    std::map<uint32_t, std::map<uint32_t, VkDescriptorSetLayoutBinding>> set_bindings;
+    std::map<uint32_t, uint32_t> runtime_array_bindings;
+    for (const ShaderReflection::Binding &reflected : m_compiled->reflection.bindings) {
+        VkDescriptorSetLayoutBinding binding = make<VkDescriptorSetLayoutBinding>();
+        binding.binding = reflected.binding;
+        binding.descriptorCount = reflected.count;
+        binding.descriptorType = reflected.type;
+        binding.stageFlags = p_descriptor_stage;
+        if (reflected.count == 0) {
+            binding.descriptorCount = DescriptorSetLayout::s_runtime_array_capacity;
+            runtime_array_bindings[reflected.set] = reflected.binding;
+        }
+        set_bindings[reflected.set][binding.binding] = binding;
     }
+    m_compute_work_group_size = m_compiled->reflection.work_group_size;
 
-    size_t file_size = static_cast<size_t>(file.tellg());
-    m_shader_source_code.resize(file_size);
-    file.seekg(0);
-    file.read(m_shader_source_code.data(), file_size);
-    file.close();
-
-    // if last is not \0 add it
-    if (m_shader_source_code.back() != '\0') {
-        m_shader_source_code.push_back('\0');
+    for (auto &descriptor_set : set_bindings) {
+        // only the last binding of a set can have a variable count, a runtime array elsewhere keeps its whole capacity
+        uint32_t variable_binding = DescriptorSetLayout::s_no_variable_binding;
+        auto runtime_array = runtime_array_bindings.find(descriptor_set.first);
+        if (runtime_array != runtime_array_bindings.end() && runtime_array->second == descriptor_set.second.rbegin()->first) {
+            variable_binding = runtime_array->second;
+        }
+        m_descriptors_set_layout[descriptor_set.first] =
+            DescriptorSetLayout::createDescriptorSetLayout(m_device, descriptor_set.second, variable_binding);
     }
+    fillEmptySets(m_device, m_descriptors_set_layout);
 }
 
-typedef struct SpirVBinary {
-    std::vector<uint32_t> words;  // SPIR-V words
-    int size;                     // number of words in SPIR-V binary
-} SpirVBinary;
-
-// from glslang readme
-void Shader::compileToSPIRV() {
-    glslang_input_t input{};
-    input.language = GLSLANG_SOURCE_GLSL;
-    input.stage = getGLSLangStageFromShaderStage(m_shader_stage);
-    input.client = GLSLANG_CLIENT_VULKAN;
-    input.client_version = GLSLANG_TARGET_VULKAN_1_3;
-    input.target_language = GLSLANG_TARGET_SPV;
-    input.target_language_version = GLSLANG_TARGET_SPV_1_6;
-    input.code = m_shader_source_code.data();
-    input.default_version = 460;
-    input.default_profile = GLSLANG_NO_PROFILE;
-    input.forward_compatible = 0;
-    input.messages = GLSLANG_MSG_DEFAULT_BIT;
-    input.resource = glslang_default_resource();
-
-    glslang_shader_t *shader = glslang_shader_create(&input);
-
-    SpirVBinary bin = {
-        .words = {},
-        .size = 0,
-    };
-    if (!glslang_shader_preprocess(shader, &input)) {
-        printf("GLSL preprocessing failed %s\n", m_shader_path.c_str());
-        printf("%s\n", glslang_shader_get_info_log(shader));
-        printf("%s\n", glslang_shader_get_info_debug_log(shader));
-        printf("%s\n", input.code);
-        glslang_shader_delete(shader);
-        throw std::runtime_error("GLSL preprocessing failed");
-    }
-
-    if (!glslang_shader_parse(shader, &input)) {
-        printf("GLSL parsing failed %s\n", m_shader_path.c_str());
-        printf("%s\n", glslang_shader_get_info_log(shader));
-        printf("%s\n", glslang_shader_get_info_debug_log(shader));
-        printf("%s\n", glslang_shader_get_preprocessed_code(shader));
-        glslang_shader_delete(shader);
-        throw std::runtime_error("GLSL parsing failed");
-    }
-
-    glslang_program_t *program = glslang_program_create();
-    glslang_program_add_shader(program, shader);
-
-    if (!glslang_program_link(program, GLSLANG_MSG_SPV_RULES_BIT | GLSLANG_MSG_VULKAN_RULES_BIT)) {
-        printf("GLSL linking failed %s\n", m_shader_path.c_str());
-        printf("%s\n", glslang_program_get_info_log(program));
-        printf("%s\n", glslang_program_get_info_debug_log(program));
-        glslang_program_delete(program);
-        glslang_shader_delete(shader);
-        throw std::runtime_error("GLSL linking failed");
-    }
-
-    glslang_spv_options_t spv_options = {
-        .generate_debug_info = false,
-        .disable_optimizer = false,
-        .optimize_size = false,
-        .disassemble = false,
-        .validate = false,
-    };
-
-    glslang_program_SPIRV_generate_with_options(program, input.stage, &spv_options);
-
-    bin.size = glslang_program_SPIRV_get_size(program);
-    bin.words.resize(bin.size);
-    glslang_program_SPIRV_get(program, bin.words.data());
-
-    const char *spirv_messages = glslang_program_SPIRV_get_messages(program);
-    if (spirv_messages) printf("(%s) %s\b", m_shader_path.c_str(), spirv_messages);
-
-    glslang_program_delete(program);
-    glslang_shader_delete(shader);
-
-    std::filesystem::path shader_file = std::filesystem::path(m_shader_path).filename();
-    std::filesystem::path shader_folder = std::filesystem::path(m_shader_path).parent_path();
-
-    // write SPIR-V binary to file
-    std::ofstream outFile((std::filesystem::path(ENGINE_DIR) / shader_folder / "spirv" / shader_file).concat(".spv"), std::ios::binary);
-    if (!outFile.is_open()) {
-        throw std::runtime_error(
-            "failed to open file for writing SPIR-V binary: " / std::filesystem::path(ENGINE_DIR) / shader_folder / "spirv" / shader_file /
-            ".spv");
+void Shader::fillEmptySets(Device *p_device, std::map<uint32_t, std::shared_ptr<DescriptorSetLayout>> &p_descriptors_set_layout) {
+    if (p_descriptors_set_layout.empty()) return;
+    for (uint32_t set = 0; set < p_descriptors_set_layout.rbegin()->first; set++) {
+        if (!p_descriptors_set_layout.count(set)) {
+            p_descriptors_set_layout[set] = DescriptorSetLayout::createDescriptorSetLayout(p_device, {});
+        }
     }
-    outFile.write(reinterpret_cast<const char *>(bin.words.data()), bin.size * sizeof(uint32_t));
-    outFile.close();
-
-    std::cout << "Shader compiled to SPIR-V: " << shader_file << std::endl;
-    saveHash();
-}
-
-std::string Shader::getShaderSourceCodeHash() {
-    Chocobo1::MD5 md5;
-
-    md5.addData(m_shader_source_code.data(), m_shader_source_code.size());
-    return md5.finalize().toString();
 }
 
-void Shader::saveHash() {
-    std::string hash = getShaderSourceCodeHash();
-
-    std::filesystem::path shader_file = std::filesystem::path(m_shader_path).filename();
-    std::filesystem::path shader_folder = std::filesystem::path(m_shader_path).parent_path();
-
-    std::ofstream hash_file((std::filesystem::path(ENGINE_DIR) / shader_folder / "hash" / shader_file).concat(".hash"), std::ios::binary);
-    if (!hash_file.is_open()) {
-        throw std::runtime_error(
-            "failed to open file for writing hash: " /
-            (std::filesystem::path(ENGINE_DIR) / shader_folder / "hash" / shader_file).concat(".hash"));
+std::vector<VkDescriptorSetLayout> Shader::getVkDescriptorsSetLayout() const {
+    std::vector<VkDescriptorSetLayout> list_descriptor;
+    for (auto &descriptor_set_layout : m_descriptors_set_layout) {
+        list_descriptor.push_back(*descriptor_set_layout.second);
     }
-    hash_file.write(hash.data(), hash.size());
-    hash_file.close();
+    return list_descriptor;
 }
 
-std::string Shader::getSavedHash() {
-    std::filesystem::path shader_file = std::filesystem::path(m_shader_path).filename();
-    std::filesystem::path shader_folder = std::filesystem::path(m_shader_path).parent_path();
+void Shader::setDescriptorsSetLayout(const std::map<uint32_t, std::shared_ptr<DescriptorSetLayout>> &p_descriptors_set_layout) {
+    m_descriptors_set_layout = p_descriptors_set_layout;
+    m_shader_create_info.setLayoutCount = m_descriptors_set_layout.size();
+}
 
-    std::ifstream hash_file((std::filesystem::path(ENGINE_DIR) / shader_folder / "hash" / shader_file).concat(".hash"), std::ios::binary);
-    if (!hash_file.is_open()) {
-        throw std::runtime_error(
-            "failed to open file for reading hash: " /
-            (std::filesystem::path(ENGINE_DIR) / shader_folder / "hash" / shader_file).concat(".hash"));
+bool Shader::fitsDescriptorsSetLayout(const std::map<uint32_t, std::shared_ptr<DescriptorSetLayout>> &p_descriptors_set_layout) const {
+    for (auto &descriptor_set_layout : m_descriptors_set_layout) {
+        auto other = p_descriptors_set_layout.find(descriptor_set_layout.first);
+        if (descriptor_set_layout.second->getLayoutBindings().empty()) continue;
+        if (other == p_descriptors_set_layout.end() || !other->second->contains(*descriptor_set_layout.second)) return false;
     }
-    std::string hash;
-    hash_file.seekg(0, std::ios::end);
-    hash.resize(hash_file.tellg());
-    hash_file.seekg(0, std::ios::beg);
-    hash_file.read(hash.data(), hash.size());
-    hash_file.close();
-    return hash;
+    return true;
 }
 
-void Shader::createDescriptorSetLayout(VkShaderStageFlags p_descriptor_stage) {
+std::map<uint32_t, std::shared_ptr<DescriptorSetLayout>> Shader::mergeDescriptorsSetLayout(
+    Device *p_device, const std::vector<Shader *> &p_shaders) {
     std::map<uint32_t, std::map<uint32_t, VkDescriptorSetLayoutBinding>> set_bindings;
-    spirv_cross::Compiler comp(m_shader_code);
-    spirv_cross::ShaderResources res = comp.get_shader_resources();
-
-    comp.get_execution_mode_argument(spv::ExecutionMode::ExecutionModeLocalSize, 0);
-    addSamplerBinding(res.separate_samplers, comp, set_bindings, p_descriptor_stage);
-    addSampledImagesBinding(res.sampled_images, comp, set_bindings, p_descriptor_stage);
-    addSeparateImagesBinding(res.separate_images, comp, set_bindings, p_descriptor_stage);
-    addStorageImagesBinding(res.storage_images, comp, set_bindings, p_descriptor_stage);
-    addUniformTexelBufferBinding(res.separate_images, comp, set_bindings, p_descriptor_stage);
-    addStorageTexelBufferBinding(res.storage_images, comp, set_bindings, p_descriptor_stage);
-    addUniformBufferBinding(res.uniform_buffers, comp, set_bindings, p_descriptor_stage);
-    addStorageBufferBinding(res.storage_buffers, comp, set_bindings, p_descriptor_stage);
-    addAccelerationStructureBinding(res.acceleration_structures, comp, set_bindings, p_descriptor_stage);
-    if (m_shader_stage == VK_SHADER_STAGE_COMPUTE_BIT) {
-        m_compute_work_group_size.width = comp.get_execution_mode_argument(spv::ExecutionMode::ExecutionModeLocalSize, 0);
-        m_compute_work_group_size.height = comp.get_execution_mode_argument(spv::ExecutionMode::ExecutionModeLocalSize, 1);
-        m_compute_work_group_size.depth = comp.get_execution_mode_argument(spv::ExecutionMode::ExecutionModeLocalSize, 2);
+    std::map<uint32_t, uint32_t> variable_bindings;
+    for (Shader *shader : p_shaders) {
+        for (auto &descriptor_set_layout : shader->getDescriptorsSetLayout()) {
+            std::map<uint32_t, VkDescriptorSetLayoutBinding> &bindings = set_bindings[descriptor_set_layout.first];
+            for (auto &binding : descriptor_set_layout.second->getLayoutBindings()) {
+                auto merged = bindings.find(binding.first);
+                if (merged == bindings.end()) {
+                    bindings[binding.first] = binding.second;
+                } else if (merged->second.descriptorType != binding.second.descriptorType) {
+                    throw std::runtime_error(
+                        "binding " + std::to_string(binding.first) + " of set " + std::to_string(descriptor_set_layout.first) +
+                        " has a different type in two stages");
+                } else {
+                    merged->second.descriptorCount = std::max(merged->second.descriptorCount, binding.second.descriptorCount);
+                    merged->second.stageFlags |= binding.second.stageFlags;
+                }
+            }
+            if (descriptor_set_layout.second->getVariableBinding() != DescriptorSetLayout::s_no_variable_binding) {
+                variable_bindings[descriptor_set_layout.first] = descriptor_set_layout.second->getVariableBinding();
+            }
+        }
     }
 
+    std::map<uint32_t, std::shared_ptr<DescriptorSetLayout>> descriptors_set_layout;
     for (auto &descriptor_set : set_bindings) {
-        m_descriptors_set_layout.push_back(DescriptorSetLayout::createDescriptorSetLayout(m_device, descriptor_set.second, descriptor_set.first));
+        uint32_t variable_binding = DescriptorSetLayout::s_no_variable_binding;
+        auto variable = variable_bindings.find(descriptor_set.first);
+        if (variable != variable_bindings.end() && variable->second == descriptor_set.second.rbegin()->first) {
+            variable_binding = variable->second;
+        }
+        descriptors_set_layout[descriptor_set.first] =
+            DescriptorSetLayout::createDescriptorSetLayout(p_device, descriptor_set.second, variable_binding);
     }
+    fillEmptySets(p_device, descriptors_set_layout);
+    return descriptors_set_layout;
 }
 
 void Shader::createPushConstant(VkShaderStageFlags p_descriptor_stage) {
-    spirv_cross::Compiler comp(m_shader_code);
-
     m_push_constants = make<VkPushConstantRange>();
     m_push_constants.offset = 0;
     m_push_constants.stageFlags = p_descriptor_stage;
-    auto ranges = comp.get_shader_resources().push_constant_buffers;
-    for (auto &res : ranges) {
-        auto &m_type = comp.get_type(res.base_type_id);
-        uint32_t size = comp.get_declared_struct_size(m_type);
-        m_push_constants.size = size;
-    }
+    m_push_constants.size = m_compiled->reflection.push_constant_size;
 }
 
 void Shader::createShaderInfo() {
-    // listDescriptor = new VkDescriptorSetLayout[descriptorsSetLayout.size()];
-    // for (int i = 0; i < descriptorsSetLayout.size(); i++) {
-    //     listDescriptor[i] = *descriptorsSetLayout[i];
-    // }
-
     m_shader_create_info = make<VkShaderCreateInfoEXT>();
     m_shader_create_info.flags = 0;
     m_shader_create_info.stage = m_shader_stage;
     m_shader_create_info.nextStage = m_next_shader_stage;
     m_shader_create_info.codeType = VK_SHADER_CODE_TYPE_SPIRV_EXT;
-    m_shader_create_info.codeSize = m_shader_code.size() * sizeof(m_shader_code[0]);
-    m_shader_create_info.pCode = m_shader_code.data();
+    m_shader_create_info.codeSize = m_compiled->spirv.size() * sizeof(uint32_t);
+    m_shader_create_info.pCode = m_compiled->spirv.data();
     m_shader_create_info.pName = "main";
     m_shader_create_info.setLayoutCount = m_descriptors_set_layout.size();
-    // m_shader_create_info.pSetLayouts = listDescriptor;
     m_shader_create_info.pushConstantRangeCount = (m_push_constants.size > 0) ? 1 : 0;
+
+    m_specialization_info = {};
+    m_specialization_info.mapEntryCount = m_specialization_entries.size();
+    m_specialization_info.dataSize = m_specialization_data.size() * sizeof(uint32_t);
+    updateCreateInfoPointers();
+}
+
+void Shader::updateCreateInfoPointers() {
+    m_specialization_info.pMapEntries = m_specialization_entries.data();
+    m_specialization_info.pData = m_specialization_data.data();
     m_shader_create_info.pPushConstantRanges = (m_push_constants.size > 0) ? &m_push_constants : nullptr;
+    m_shader_create_info.pSpecializationInfo = m_specialization_entries.empty() ? nullptr : &m_specialization_info;
 }
 
 // Creation of shader module for Ray-Tracing
 void Shader::createShaderModule() {
     auto module_create_info = make<VkShaderModuleCreateInfo>();
-    module_create_info.codeSize = m_shader_code.size() * sizeof(m_shader_code[0]);
-    module_create_info.pCode = m_shader_code.data();
+    module_create_info.codeSize = m_compiled->spirv.size() * sizeof(uint32_t);
+    module_create_info.pCode = m_compiled->spirv.data();
     auto res = vkCreateShaderModule(*m_device, &module_create_info, NULL, &m_shader_module);
     if (res != VK_SUCCESS) {
         throw std::runtime_error("failed to create shader module");
@@ -588,10 +249,8 @@ void Shader::createShaderModule() {
 }
 
 void Shader::buildShader() {
-    std::vector<VkDescriptorSetLayout> list_descriptor;
-    for (size_t i = 0; i < m_descriptors_set_layout.size(); i++) {
-        list_descriptor.push_back(*m_descriptors_set_layout[i]);
-    }
+    std::vector<VkDescriptorSetLayout> list_descriptor = getVkDescriptorsSetLayout();
+    m_shader_create_info.setLayoutCount = list_descriptor.size();
     m_shader_create_info.pSetLayouts = list_descriptor.data();
 
     VkResult result = vkCreateShadersEXT(*m_device, 1, &m_shader_create_info, nullptr, &m_shader);
@@ -607,9 +266,7 @@ void Shader::buildLinkedShaders(Device *p_device, std::vector<Shader *> &p_shade
     for (size_t i = 0; i < p_shaders.size(); i++) {
         shaders_create_infos.push_back(p_shaders[i]->getShaderCreateInfo());
         shaders_create_infos[i].flags |= VK_SHADER_CREATE_LINK_STAGE_BIT_EXT;
-        for (size_t j = 0; j < p_shaders[i]->getDescriptorsSetLayout().size(); j++) {
-            list_descriptor[i].push_back(*p_shaders[i]->getDescriptorsSetLayout()[j]);
-        }
+        list_descriptor[i] = p_shaders[i]->getVkDescriptorsSetLayout();
         shaders_create_infos[i].setLayoutCount = list_descriptor[i].size();
         shaders_create_infos[i].pSetLayouts = list_descriptor[i].data();
     }
@@ -676,35 +333,4 @@ VkShaderStageFlagBits Shader::getShaderStageFlagsBitFromFileName(std::filesystem
     }
 }
 
-glslang_stage_t Shader::getGLSLangStageFromShaderStage(VkShaderStageFlagBits p_shader_stage) const {
-    switch (p_shader_stage) {
-        case VK_SHADER_STAGE_VERTEX_BIT:
-            return GLSLANG_STAGE_VERTEX;
-        case VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT:
-            return GLSLANG_STAGE_TESSCONTROL;
-        case VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT:
-            return GLSLANG_STAGE_TESSCONTROL;
-        case VK_SHADER_STAGE_GEOMETRY_BIT:
-            return GLSLANG_STAGE_GEOMETRY;
-        case VK_SHADER_STAGE_FRAGMENT_BIT:
-            return GLSLANG_STAGE_FRAGMENT;
-        case VK_SHADER_STAGE_COMPUTE_BIT:
-            return GLSLANG_STAGE_COMPUTE;
-        case VK_SHADER_STAGE_RAYGEN_BIT_KHR:
-            return GLSLANG_STAGE_RAYGEN;
-        case VK_SHADER_STAGE_INTERSECTION_BIT_KHR:
-            return GLSLANG_STAGE_INTERSECT;
-        case VK_SHADER_STAGE_ANY_HIT_BIT_KHR:
-            return GLSLANG_STAGE_ANYHIT;
-        case VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR:
-            return GLSLANG_STAGE_CLOSESTHIT;
-        case VK_SHADER_STAGE_MISS_BIT_KHR:
-            return GLSLANG_STAGE_MISS;
-        case VK_SHADER_STAGE_CALLABLE_BIT_KHR:
-            return GLSLANG_STAGE_CALLABLE;
-        default:
-            throw std::runtime_error("not supported shader stage");
-    }
-}
-
 }  // namespace TTe
@@ -2,21 +2,38 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
 #include <filesystem>
-#include <glslang/Include/glslang_c_interface.h>
 
 #include "../descriptor/descriptorSetLayout.hpp"
 #include "../device.hpp"
+#include "shader_manager.hpp"
 #include "volk.h"
 namespace TTe {
+
+// a variant of a shader : the defines select the code compiled to SPIR-V, the specialization constants
+// (layout(constant_id = id) const) are set when the shader object is created and the driver removes the branches they disable
+struct ShaderPermutation {
+    std::vector<std::string> defines;
+    // constant_id -> 32 bits value : bool, int, uint or the bits of a float
+    std::map<uint32_t, uint32_t> constants;
+
+    std::string getKey() const;
+};
+
 class Shader {
    public:
     // Constructor
     Shader();
-    Shader(Device *p_device, std::filesystem::path p_shader_file, VkShaderStageFlags p_descriptor_stage, VkShaderStageFlags p_next_shader_stage = 0);
+    Shader(
+        Device *p_device,
+        std::filesystem::path p_shader_file,
+        VkShaderStageFlags p_descriptor_stage,
+        VkShaderStageFlags p_next_shader_stage = 0,
+        const ShaderPermutation &p_permutation = {});
 
     // Destructor
     ~Shader();
@@ -43,7 +60,17 @@ class Shader {
     const VkShaderCreateInfoEXT &getShaderCreateInfo() const { return m_shader_create_info; }
     const VkPushConstantRange &getPushConstants() const { return m_push_constants; }
     const VkExtent3D &getComputeWorkGroupSize() const { return m_compute_work_group_size; }
-    std::vector<std::shared_ptr<DescriptorSetLayout>> &getDescriptorsSetLayout() { return m_descriptors_set_layout; }
+    // layout of every set from 0 to the last one used, the sets the shader does not use have an empty layout
+    std::map<uint32_t, std::shared_ptr<DescriptorSetLayout>> &getDescriptorsSetLayout() { return m_descriptors_set_layout; }
+    std::vector<VkDescriptorSetLayout> getVkDescriptorsSetLayout() const;
+    // the layouts of a pipeline, which must contain the ones of the shader
+    void setDescriptorsSetLayout(const std::map<uint32_t, std::shared_ptr<DescriptorSetLayout>> &p_descriptors_set_layout);
+    // every set of the shader fits in the set of the same number in p_descriptors_set_layout
+    bool fitsDescriptorsSetLayout(const std::map<uint32_t, std::shared_ptr<DescriptorSetLayout>> &p_descriptors_set_layout) const;
+
+    // one layout per set for all the stages of a pipeline : the union of the bindings each stage uses in that set
+    static std::map<uint32_t, std::shared_ptr<DescriptorSetLayout>> mergeDescriptorsSetLayout(
+        Device *p_device, const std::vector<Shader *> &p_shaders);
 
     static VkShaderStageFlagBits getShaderStageFlagsBitFromFileName(std::filesystem::path p_shader_file);
     
@@ -52,23 +79,20 @@ class Shader {
     void setPushConstant(VkPushConstantRange p_push_constant) { m_push_constants = p_push_constant; }
     void createShaderInfo();
    protected:
-    void loadShaderSPVCode();
-    void loadShaderGLSLCode();
-    void compileToSPIRV();
-    
-    std::string getShaderSourceCodeHash();
-    void saveHash();
-    std::string getSavedHash();
-
+    // the create info points to members, moved with the shader
+    void updateCreateInfoPointers();
     void createDescriptorSetLayout(VkShaderStageFlags p_descriptor_stage);
+    static void fillEmptySets(Device *p_device, std::map<uint32_t, std::shared_ptr<DescriptorSetLayout>> &p_descriptors_set_layout);
     void createPushConstant(VkShaderStageFlags p_descriptor_stage);
 
-    glslang_stage_t getGLSLangStageFromShaderStage(VkShaderStageFlagBits p_shader_stage) const;
+    // SPIR-V and reflection, shared with the other shaders built from the same file
+    std::shared_ptr<const CompiledShader> m_compiled;
 
-    std::vector<uint32_t> m_shader_code;
-    std::vector<char> m_shader_source_code;
+    std::vector<VkSpecializationMapEntry> m_specialization_entries;
+    std::vector<uint32_t> m_specialization_data;
+    VkSpecializationInfo m_specialization_info = {};
 
-    std::vector<std::shared_ptr<DescriptorSetLayout>> m_descriptors_set_layout;
+    std::map<uint32_t, std::shared_ptr<DescriptorSetLayout>> m_descriptors_set_layout;
 
     VkPushConstantRange m_push_constants = {};
 
@@ -0,0 +1,617 @@
+#include "shader_manager.hpp"
+
+#include <glslang/Include/glslang_c_interface.h>
+#include <glslang/Public/resource_limits_c.h>
+#include <glslang/build_info.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <stdexcept>
+
+#include "jobs/job_system.hpp"
+#include "md5.h"
+#include "shader/shader.hpp"
+#include "spirv.hpp"
+#include "spirv_cross.hpp"
+
+#ifndef ENGINE_DIR
+#define ENGINE_DIR "../"
+#endif
+
+namespace TTe {
+
+std::mutex ShaderManager::s_mutex;
+std::filesystem::path ShaderManager::s_cache_file;
+std::unordered_map<std::string, ShaderManager::Entry> ShaderManager::s_entries;
+std::vector<char> ShaderManager::s_cache_data;
+std::unordered_map<std::string, ShaderManager::CacheRecord> ShaderManager::s_cache_records;
+bool ShaderManager::s_dirty = false;
+
+namespace {
+
+constexpr char s_cache_magic[4] = {'T', 'T', 'S', 'C'};
+constexpr uint32_t s_cache_version = 2;
+
+// everything besides the sources that changes the SPIR-V or its reflection
+const std::string s_compiler_version = "glslang " + std::to_string(GLSLANG_VERSION_MAJOR) + "." + std::to_string(GLSLANG_VERSION_MINOR) +
+                                       "." + std::to_string(GLSLANG_VERSION_PATCH) + GLSLANG_VERSION_FLAVOR +
+                                       " vulkan1.3 spirv1.6 glsl460 cache " + std::to_string(s_cache_version);
+
+bool readFile(const std::filesystem::path &p_path, std::string &p_content) {
+    std::ifstream file(std::filesystem::path(ENGINE_DIR) / p_path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) return false;
+    p_content.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(p_content.data(), p_content.size());
+    return bool(file);
+}
+
+// file of an #include : next to the including file for "name", then in the folder of the compiled shader
+std::filesystem::path resolveInclude(
+    const std::string &p_name, const std::filesystem::path &p_includer, const std::filesystem::path &p_shader, bool p_local) {
+    if (p_local) {
+        std::filesystem::path local = (p_includer.parent_path() / p_name).lexically_normal();
+        if (std::filesystem::exists(std::filesystem::path(ENGINE_DIR) / local)) return local;
+    }
+    return (p_shader.parent_path() / p_name).lexically_normal();
+}
+
+// source of a shader and of every file it includes, read once for the hash and the compilation
+struct ShaderSources {
+    std::filesystem::path shader;
+    // the shader first, then its includes in the order they are found
+    std::vector<std::filesystem::path> files;
+    std::map<std::filesystem::path, std::string> contents;
+};
+
+void readSources(const std::filesystem::path &p_file, ShaderSources &p_sources) {
+    if (p_sources.contents.count(p_file)) return;
+    std::string &content = p_sources.contents[p_file];
+    p_sources.files.push_back(p_file);
+    if (!readFile(p_file, content)) {
+        if (p_file == p_sources.shader) {
+            throw std::runtime_error("failed to open file :" + (std::filesystem::path(ENGINE_DIR) / p_file).string());
+        }
+        // a missing include is reported by the compiler, its absence is part of the hash
+        return;
+    }
+
+    // #include "name" or #include <name> at the start of a line
+    std::vector<std::pair<std::string, bool>> includes;
+    size_t line = 0;
+    while (line < content.size()) {
+        size_t end = content.find('\n', line);
+        if (end == std::string::npos) end = content.size();
+        size_t i = content.find_first_not_of(" \t", line);
+        if (i < end && content[i] == '#') {
+            i = content.find_first_not_of(" \t", i + 1);
+            if (i < end && content.compare(i, 7, "include") == 0) {
+                i = content.find_first_not_of(" \t", i + 7);
+                if (i < end && (content[i] == '"' || content[i] == '<')) {
+                    size_t close = content.find(content[i] == '"' ? '"' : '>', i + 1);
+                    if (close < end) includes.emplace_back(content.substr(i + 1, close - i - 1), content[i] == '"');
+                }
+            }
+        }
+        line = end + 1;
+    }
+
+    for (auto &include : includes) readSources(resolveInclude(include.first, p_file, p_sources.shader, include.second), p_sources);
+}
+
+std::string computeKey(const ShaderSources &p_sources, const std::vector<std::string> &p_defines) {
+    Chocobo1::MD5 md5;
+    md5.addData(s_compiler_version.data(), s_compiler_version.size() + 1);
+    std::string stage = p_sources.shader.extension().string();
+    md5.addData(stage.data(), stage.size() + 1);
+    for (const std::string &define : p_defines) md5.addData(define.data(), define.size() + 1);
+    for (const std::filesystem::path &file : p_sources.files) {
+        std::string name = file.generic_string();
+        const std::string &content = p_sources.contents.at(file);
+        md5.addData(name.data(), name.size() + 1);
+        md5.addData(content.data(), content.size());
+    }
+    return md5.finalize().toString();
+}
+
+glslang_stage_t getGLSLangStage(VkShaderStageFlagBits p_shader_stage) {
+    switch (p_shader_stage) {
+        case VK_SHADER_STAGE_VERTEX_BIT:
+            return GLSLANG_STAGE_VERTEX;
+        case VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT:
+            return GLSLANG_STAGE_TESSCONTROL;
+        case VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT:
+            return GLSLANG_STAGE_TESSEVALUATION;
+        case VK_SHADER_STAGE_GEOMETRY_BIT:
+            return GLSLANG_STAGE_GEOMETRY;
+        case VK_SHADER_STAGE_FRAGMENT_BIT:
+            return GLSLANG_STAGE_FRAGMENT;
+        case VK_SHADER_STAGE_COMPUTE_BIT:
+            return GLSLANG_STAGE_COMPUTE;
+        case VK_SHADER_STAGE_RAYGEN_BIT_KHR:
+            return GLSLANG_STAGE_RAYGEN;
+        case VK_SHADER_STAGE_INTERSECTION_BIT_KHR:
+            return GLSLANG_STAGE_INTERSECT;
+        case VK_SHADER_STAGE_ANY_HIT_BIT_KHR:
+            return GLSLANG_STAGE_ANYHIT;
+        case VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR:
+            return GLSLANG_STAGE_CLOSESTHIT;
+        case VK_SHADER_STAGE_MISS_BIT_KHR:
+            return GLSLANG_STAGE_MISS;
+        case VK_SHADER_STAGE_CALLABLE_BIT_KHR:
+            return GLSLANG_STAGE_CALLABLE;
+        case VK_SHADER_STAGE_TASK_BIT_EXT:
+            return GLSLANG_STAGE_TASK;
+        case VK_SHADER_STAGE_MESH_BIT_EXT:
+            return GLSLANG_STAGE_MESH;
+        default:
+            throw std::runtime_error("not supported shader stage");
+    }
+}
+
+// the includes given to glslang are the files read for the hash
+struct IncludeContext {
+    const ShaderSources *sources;
+};
+
+struct IncludeResult {
+    glsl_include_result_t result;
+    std::string name;
+};
+
+glsl_include_result_t *includeFile(void *p_context, const char *p_header_name, const char *p_includer_name, bool p_local) {
+    const ShaderSources &sources = *static_cast<IncludeContext *>(p_context)->sources;
+    std::filesystem::path includer = (p_includer_name && *p_includer_name) ? std::filesystem::path(p_includer_name) : sources.shader;
+    std::filesystem::path file = resolveInclude(p_header_name, includer, sources.shader, p_local);
+    auto content = sources.contents.find(file);
+    if (content == sources.contents.end() || content->second.empty()) return nullptr;
+
+    IncludeResult *include = new IncludeResult();
+    include->name = file.generic_string();
+    include->result.header_name = include->name.c_str();
+    include->result.header_data = content->second.data();
+    include->result.header_length = content->second.size();
+    return &include->result;
+}
+
+int freeIncludeResult(void *, glsl_include_result_t *p_result) {
+    delete reinterpret_cast<IncludeResult *>(p_result);
+    return 0;
+}
+
+// from glslang readme
+std::vector<uint32_t> compileToSPIRV(
+    const ShaderSources &p_sources, const std::vector<std::string> &p_defines, VkShaderStageFlagBits p_stage) {
+    const std::string &code = p_sources.contents.at(p_sources.shader);
+    IncludeContext include_context{&p_sources};
+
+    glslang_input_t input{};
+    input.language = GLSLANG_SOURCE_GLSL;
+    input.stage = getGLSLangStage(p_stage);
+    input.client = GLSLANG_CLIENT_VULKAN;
+    input.client_version = GLSLANG_TARGET_VULKAN_1_3;
+    input.target_language = GLSLANG_TARGET_SPV;
+    input.target_language_version = GLSLANG_TARGET_SPV_1_6;
+    input.code = code.c_str();
+    input.default_version = 460;
+    input.default_profile = GLSLANG_NO_PROFILE;
+    input.forward_compatible = 0;
+    input.messages = GLSLANG_MSG_DEFAULT_BIT;
+    input.resource = glslang_default_resource();
+    input.callbacks.include_local = [](void *p_ctx, const char *p_header, const char *p_includer, size_t) {
+        return includeFile(p_ctx, p_header, p_includer, true);
+    };
+    input.callbacks.include_system = [](void *p_ctx, const char *p_header, const char *p_includer, size_t) {
+        return includeFile(p_ctx, p_header, p_includer, false);
+    };
+    input.callbacks.free_include_result = freeIncludeResult;
+    input.callbacks_ctx = &include_context;
+
+    glslang_shader_t *shader = glslang_shader_create(&input);
+
+    // the defines come before the first line of the source, "NAME=VALUE" becomes "#define NAME VALUE"
+    std::string preamble;
+    for (std::string define : p_defines) {
+        std::replace(define.begin(), define.end(), '=', ' ');
+        preamble += "#define " + define + "\n";
+    }
+    if (!preamble.empty()) glslang_shader_set_preamble(shader, preamble.c_str());
+
+    std::string name = p_sources.shader.generic_string();
+    if (!glslang_shader_preprocess(shader, &input)) {
+        std::string log = "GLSL preprocessing failed " + name + "\n" + glslang_shader_get_info_log(shader) +
+                          glslang_shader_get_info_debug_log(shader);
+        glslang_shader_delete(shader);
+        throw std::runtime_error(log);
+    }
+
+    if (!glslang_shader_parse(shader, &input)) {
+        std::string log =
+            "GLSL parsing failed " + name + "\n" + glslang_shader_get_info_log(shader) + glslang_shader_get_info_debug_log(shader);
+        glslang_shader_delete(shader);
+        throw std::runtime_error(log);
+    }
+
+    glslang_program_t *program = glslang_program_create();
+    glslang_program_add_shader(program, shader);
+
+    if (!glslang_program_link(program, GLSLANG_MSG_SPV_RULES_BIT | GLSLANG_MSG_VULKAN_RULES_BIT)) {
+        std::string log =
+            "GLSL linking failed " + name + "\n" + glslang_program_get_info_log(program) + glslang_program_get_info_debug_log(program);
+        glslang_program_delete(program);
+        glslang_shader_delete(shader);
+        throw std::runtime_error(log);
+    }
+
+    glslang_spv_options_t spv_options = {
+        .generate_debug_info = false,
+        .disable_optimizer = false,
+        .optimize_size = false,
+        .disassemble = false,
+        .validate = false,
+    };
+
+    glslang_program_SPIRV_generate_with_options(program, input.stage, &spv_options);
+
+    std::vector<uint32_t> words(glslang_program_SPIRV_get_size(program));
+    glslang_program_SPIRV_get(program, words.data());
+
+    const char *spirv_messages = glslang_program_SPIRV_get_messages(program);
+    if (spirv_messages) std::cout << "(" << name << ") " << spirv_messages << std::endl;
+
+    glslang_program_delete(program);
+    glslang_shader_delete(shader);
+    return words;
+}
+
+// p_texel_buffer_type replaces p_type for the images of dimension buffer
+void addBindings(
+    const spirv_cross::SmallVector<spirv_cross::Resource> &p_resources,
+    const spirv_cross::Compiler &p_comp,
+    VkDescriptorType p_type,
+    VkDescriptorType p_texel_buffer_type,
+    ShaderReflection &p_reflection) {
+    for (const spirv_cross::Resource &resource : p_resources) {
+        const spirv_cross::SPIRType &type = p_comp.get_type(resource.type_id);
+        ShaderReflection::Binding binding;
+        binding.set = p_comp.get_decoration(resource.id, spv::DecorationDescriptorSet);
+        binding.binding = p_comp.get_decoration(resource.id, spv::DecorationBinding);
+        binding.type = (type.image.dim == spv::DimBuffer) ? p_texel_buffer_type : p_type;
+
+        // product of the dimensions, an array sized by a specialization constant takes its default value
+        binding.count = 1;
+        for (size_t i = 0; i < type.array.size(); i++) {
+            binding.count *= type.array_size_literal[i] ? type.array[i] : p_comp.get_constant(type.array[i]).scalar();
+        }
+        p_reflection.bindings.push_back(binding);
+    }
+}
+
+ShaderReflection reflect(const std::vector<uint32_t> &p_spirv, VkShaderStageFlagBits p_stage) {
+    ShaderReflection reflection;
+    spirv_cross::Compiler comp(p_spirv);
+    spirv_cross::ShaderResources res = comp.get_shader_resources();
+
+    addBindings(res.separate_samplers, comp, VK_DESCRIPTOR_TYPE_SAMPLER, VK_DESCRIPTOR_TYPE_SAMPLER, reflection);
+    addBindings(res.sampled_images, comp, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, reflection);
+    addBindings(res.separate_images, comp, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER, reflection);
+    addBindings(res.storage_images, comp, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER, reflection);
+    addBindings(res.uniform_buffers, comp, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, reflection);
+    addBindings(res.storage_buffers, comp, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, reflection);
+    addBindings(res.acceleration_structures, comp, VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR,
+                VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR, reflection);
+
+    for (auto &push_constant : res.push_constant_buffers) {
+        reflection.push_constant_size = comp.get_declared_struct_size(comp.get_type(push_constant.base_type_id));
+    }
+    if (p_stage == VK_SHADER_STAGE_COMPUTE_BIT) {
+        reflection.work_group_size.width = comp.get_execution_mode_argument(spv::ExecutionMode::ExecutionModeLocalSize, 0);
+        reflection.work_group_size.height = comp.get_execution_mode_argument(spv::ExecutionMode::ExecutionModeLocalSize, 1);
+        reflection.work_group_size.depth = comp.get_execution_mode_argument(spv::ExecutionMode::ExecutionModeLocalSize, 2);
+    }
+    return reflection;
+}
+
+template <typename T>
+void write(std::vector<char> &p_out, const T &p_value) {
+    const char *bytes = reinterpret_cast<const char *>(&p_value);
+    p_out.insert(p_out.end(), bytes, bytes + sizeof(T));
+}
+
+void writeBytes(std::vector<char> &p_out, const void *p_data, size_t p_size) {
+    const char *bytes = static_cast<const char *>(p_data);
+    p_out.insert(p_out.end(), bytes, bytes + p_size);
+}
+
+// reads a cache file or an entry, every read is bounds checked and a truncated input only sets ok to false
+struct Reader {
+    const char *data;
+    size_t size;
+    size_t pos = 0;
+    bool ok = true;
+
+    template <typename T>
+    T read() {
+        T value{};
+        readBytes(&value, sizeof(T));
+        return value;
+    }
+    void readBytes(void *p_out, size_t p_size) {
+        if (!ok || p_size > size - pos) {
+            ok = false;
+            return;
+        }
+        std::memcpy(p_out, data + pos, p_size);
+        pos += p_size;
+    }
+    std::string readString() {
+        std::string value(read<uint32_t>(), '\0');
+        readBytes(value.data(), value.size());
+        return value;
+    }
+};
+
+void serialize(const CompiledShader &p_shader, std::vector<char> &p_out) {
+    write(p_out, uint32_t(p_shader.spirv.size()));
+    writeBytes(p_out, p_shader.spirv.data(), p_shader.spirv.size() * sizeof(uint32_t));
+    write(p_out, uint32_t(p_shader.reflection.bindings.size()));
+    for (const ShaderReflection::Binding &binding : p_shader.reflection.bindings) {
+        write(p_out, binding.set);
+        write(p_out, binding.binding);
+        write(p_out, uint32_t(binding.type));
+        write(p_out, binding.count);
+    }
+    write(p_out, p_shader.reflection.push_constant_size);
+    write(p_out, p_shader.reflection.work_group_size);
+}
+
+std::shared_ptr<const CompiledShader> deserialize(const char *p_data, size_t p_size) {
+    Reader reader{p_data, p_size};
+    auto shader = std::make_shared<CompiledShader>();
+    shader->spirv.resize(std::min<size_t>(reader.read<uint32_t>(), p_size / sizeof(uint32_t)));
+    reader.readBytes(shader->spirv.data(), shader->spirv.size() * sizeof(uint32_t));
+    shader->reflection.bindings.resize(std::min<size_t>(reader.read<uint32_t>(), p_size / sizeof(ShaderReflection::Binding)));
+    for (ShaderReflection::Binding &binding : shader->reflection.bindings) {
+        binding.set = reader.read<uint32_t>();
+        binding.binding = reader.read<uint32_t>();
+        binding.type = VkDescriptorType(reader.read<uint32_t>());
+        binding.count = reader.read<uint32_t>();
+    }
+    shader->reflection.push_constant_size = reader.read<uint32_t>();
+    shader->reflection.work_group_size = reader.read<VkExtent3D>();
+    if (!reader.ok || shader->spirv.empty()) return nullptr;
+    return shader;
+}
+
+}  // namespace
+
+void ShaderManager::init(const std::filesystem::path &p_cache_file) {
+    glslang_initialize_process();
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_cache_file = p_cache_file;
+    loadCacheFile();
+}
+
+void ShaderManager::shutdown() {
+    save();
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_entries.clear();
+    s_cache_records.clear();
+    s_cache_data.clear();
+    s_cache_file.clear();
+    glslang_finalize_process();
+}
+
+std::string ShaderManager::getLabel(const std::filesystem::path &p_shader, const std::vector<std::string> &p_defines) {
+    std::string label = p_shader.lexically_normal().generic_string();
+    for (const std::string &define : p_defines) label += "|" + define;
+    return label;
+}
+
+ShaderManager::Entry ShaderManager::load(
+    const std::filesystem::path &p_shader, const std::vector<std::string> &p_defines, bool &p_compiled) {
+    Entry entry;
+    p_compiled = false;
+    try {
+        ShaderSources sources;
+        sources.shader = p_shader.lexically_normal();
+        readSources(sources.shader, sources);
+        entry.dependencies = sources.files;
+        entry.key = computeKey(sources, p_defines);
+
+        // the cache records are only written by init, they can be read without lock
+        auto record = s_cache_records.find(entry.key);
+        if (record != s_cache_records.end()) {
+            entry.shader = deserialize(s_cache_data.data() + record->second.offset, record->second.size);
+            if (entry.shader) return entry;
+        }
+
+        VkShaderStageFlagBits stage = Shader::getShaderStageFlagsBitFromFileName(sources.shader);
+        auto shader = std::make_shared<CompiledShader>();
+        shader->spirv = compileToSPIRV(sources, p_defines, stage);
+        shader->reflection = reflect(shader->spirv, stage);
+        entry.shader = shader;
+        p_compiled = true;
+        std::cout << "Shader compiled to SPIR-V: " + getLabel(p_shader, p_defines) + "\n" << std::flush;
+    } catch (const std::exception &e) {
+        entry.shader = nullptr;
+        entry.error = e.what();
+    }
+    return entry;
+}
+
+std::shared_ptr<const CompiledShader> ShaderManager::get(const std::filesystem::path &p_shader, const std::vector<std::string> &p_defines) {
+    std::string label = getLabel(p_shader, p_defines);
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        auto entry = s_entries.find(label);
+        if (entry != s_entries.end()) {
+            if (!entry->second.shader) throw std::runtime_error(entry->second.error);
+            return entry->second.shader;
+        }
+    }
+
+    bool compiled = false;
+    Entry entry = load(p_shader, p_defines, compiled);
+    std::shared_ptr<const CompiledShader> shader = entry.shader;
+    std::string error = entry.error;
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        if (compiled) s_dirty = true;
+        s_entries[label] = std::move(entry);
+    }
+    if (!shader) throw std::runtime_error(error);
+    return shader;
+}
+
+std::vector<std::filesystem::path> ShaderManager::getDependencies(
+    const std::filesystem::path &p_shader, const std::vector<std::string> &p_defines) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    auto entry = s_entries.find(getLabel(p_shader, p_defines));
+    if (entry == s_entries.end()) return {};
+    return entry->second.dependencies;
+}
+
+void ShaderManager::invalidate(const std::vector<std::filesystem::path> &p_files) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    for (auto entry = s_entries.begin(); entry != s_entries.end();) {
+        // a shader in error may not know all its includes, it is always read again
+        bool changed = !entry->second.shader || std::any_of(p_files.begin(), p_files.end(), [&](const std::filesystem::path &p_file) {
+            return std::find(entry->second.dependencies.begin(), entry->second.dependencies.end(), p_file.lexically_normal()) !=
+                   entry->second.dependencies.end();
+        });
+        entry = changed ? s_entries.erase(entry) : std::next(entry);
+    }
+}
+
+void ShaderManager::precompile(const std::vector<std::filesystem::path> &p_shaders) {
+    auto start = std::chrono::high_resolution_clock::now();
+    std::atomic<uint32_t> nb_compiled{0};
+    JobSystem::parallelFor(0, p_shaders.size(), 1, [&](uint32_t i) {
+        std::string label = getLabel(p_shaders[i], {});
+        {
+            std::lock_guard<std::mutex> lock(s_mutex);
+            if (s_entries.count(label)) return;
+        }
+        bool compiled = false;
+        Entry entry = load(p_shaders[i], {}, compiled);
+        if (compiled) nb_compiled++;
+        std::lock_guard<std::mutex> lock(s_mutex);
+        if (compiled) s_dirty = true;
+        s_entries.emplace(label, std::move(entry));
+    });
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+    std::cout << p_shaders.size() << " shaders ready in " << elapsed.count() << " ms (" << nb_compiled << " compiled, "
+              << JobSystem::getWorkerCount() << " workers)" << std::endl;
+}
+
+void ShaderManager::precompile(const std::filesystem::path &p_folder) {
+    std::vector<std::filesystem::path> shaders;
+    for (const auto &file : std::filesystem::directory_iterator(std::filesystem::path(ENGINE_DIR) / p_folder)) {
+        if (!file.is_regular_file()) continue;
+        try {
+            Shader::getShaderStageFlagsBitFromFileName(file.path());
+        } catch (const std::runtime_error &) {
+            continue;
+        }
+        shaders.push_back(p_folder / file.path().filename());
+    }
+    std::sort(shaders.begin(), shaders.end());
+    precompile(shaders);
+}
+
+void ShaderManager::loadCacheFile() {
+    s_cache_records.clear();
+    s_cache_data.clear();
+    std::string content;
+    if (s_cache_file.empty() || !readFile(s_cache_file, content)) return;
+
+    Reader reader{content.data(), content.size()};
+    char magic[4];
+    reader.readBytes(magic, sizeof(magic));
+    if (!reader.ok || std::memcmp(magic, s_cache_magic, sizeof(magic)) != 0 || reader.read<uint32_t>() != s_cache_version) return;
+
+    uint32_t nb_records = reader.read<uint32_t>();
+    std::unordered_map<std::string, CacheRecord> records;
+    for (uint32_t i = 0; i < nb_records && reader.ok; i++) {
+        std::string key = reader.readString();
+        CacheRecord record;
+        record.label = reader.readString();
+        record.offset = reader.read<uint64_t>();
+        record.size = reader.read<uint64_t>();
+        records[key] = record;
+    }
+    if (!reader.ok) return;
+
+    s_cache_data.assign(content.begin() + reader.pos, content.end());
+    for (auto &record : records) {
+        if (record.second.offset <= s_cache_data.size() && record.second.size <= s_cache_data.size() - record.second.offset) {
+            s_cache_records.insert(record);
+        }
+    }
+}
+
+void ShaderManager::save() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (!s_dirty || s_cache_file.empty()) return;
+
+    // one entry per shader and defines : the ones resolved since init, then the ones of the file this run did not use
+    std::vector<std::pair<std::string, CacheRecord>> records;
+    std::vector<char> data;
+    std::set<std::string> labels;
+    for (auto &entry : s_entries) {
+        if (!entry.second.shader) continue;
+        CacheRecord record{entry.first, data.size(), 0};
+        serialize(*entry.second.shader, data);
+        record.size = data.size() - record.offset;
+        records.emplace_back(entry.second.key, record);
+        labels.insert(entry.first);
+    }
+    for (auto &cached : s_cache_records) {
+        if (!labels.insert(cached.second.label).second) continue;
+        CacheRecord record{cached.second.label, data.size(), cached.second.size};
+        writeBytes(data, s_cache_data.data() + cached.second.offset, cached.second.size);
+        records.emplace_back(cached.first, record);
+    }
+
+    std::vector<char> header;
+    writeBytes(header, s_cache_magic, sizeof(s_cache_magic));
+    write(header, s_cache_version);
+    write(header, uint32_t(records.size()));
+    for (auto &record : records) {
+        write(header, uint32_t(record.first.size()));
+        writeBytes(header, record.first.data(), record.first.size());
+        write(header, uint32_t(record.second.label.size()));
+        writeBytes(header, record.second.label.data(), record.second.label.size());
+        write(header, record.second.offset);
+        write(header, record.second.size);
+    }
+
+    // written next to the cache then renamed, an interrupted write never leaves a truncated cache
+    std::filesystem::path path = std::filesystem::path(ENGINE_DIR) / s_cache_file;
+    std::filesystem::path temporary = std::filesystem::path(path).concat(".tmp");
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        file.write(header.data(), header.size());
+        file.write(data.data(), data.size());
+        if (!file) {
+            std::cerr << "failed to write shader cache: " << path << std::endl;
+            return;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+    if (error) {
+        std::cerr << "failed to write shader cache: " << path << " (" << error.message() << ")" << std::endl;
+        return;
+    }
+    s_dirty = false;
+}
+
+}  // namespace TTe
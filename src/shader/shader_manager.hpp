@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "volk.h"
+
+namespace TTe {
+
+// descriptors, push constants and work group size read from the SPIR-V when it is compiled, saved with it in the cache
+struct ShaderReflection {
+    struct Binding {
+        uint32_t set = 0;
+        uint32_t binding = 0;
+        VkDescriptorType type = VK_DESCRIPTOR_TYPE_SAMPLER;
+        // descriptors of the binding, 0 for a runtime array
+        uint32_t count = 1;
+    };
+
+    std::vector<Binding> bindings;
+    uint32_t push_constant_size = 0;
+    VkExtent3D work_group_size = {1, 1, 1};
+};
+
+struct CompiledShader {
+    std::vector<uint32_t> spirv;
+    ShaderReflection reflection;
+};
+
+// compiles the GLSL shaders to SPIR-V, on the job system workers, and keeps them in a single cache file : an index of
+// entries keyed by the hash of the compiler version, the stage, the defines, the source and every file it includes.
+// A warm start only reads the sources and their includes to hash them, nothing is compiled or reflected again
+class ShaderManager {
+   public:
+    // p_cache_file is relative to the engine directory, like the shader paths
+    static void init(const std::filesystem::path &p_cache_file);
+    // writes the cache file if a shader was compiled since init
+    static void shutdown();
+
+    // compiles in parallel every shader of p_folder missing from the cache. The compilation errors are kept and thrown
+    // by get, for the shaders actually used
+    static void precompile(const std::filesystem::path &p_folder);
+    static void precompile(const std::vector<std::filesystem::path> &p_shaders);
+
+    // SPIR-V and reflection of p_shader compiled with p_defines ("NAME" or "NAME=VALUE"), compiled now if no cache entry
+    // matches. Throws std::runtime_error with the compiler log when the shader does not compile
+    static std::shared_ptr<const CompiledShader> get(
+        const std::filesystem::path &p_shader, const std::vector<std::string> &p_defines = {});
+
+    // source file then every file it includes, as resolved by the last get of p_shader
+    static std::vector<std::filesystem::path> getDependencies(
+        const std::filesystem::path &p_shader, const std::vector<std::string> &p_defines = {});
+
+    // forgets the shaders including one of p_files, the next get reads their sources again and compiles them if they
+    // changed. Used by the hot reload, the shaders already created keep their SPIR-V
+    static void invalidate(const std::vector<std::filesystem::path> &p_files);
+
+    static void save();
+
+   private:
+    struct Entry {
+        std::string key;
+        std::shared_ptr<const CompiledShader> shader;
+        std::string error;
+        std::vector<std::filesystem::path> dependencies;
+    };
+
+    struct CacheRecord {
+        std::string label;
+        uint64_t offset = 0;
+        uint64_t size = 0;
+    };
+
+    static std::string getLabel(const std::filesystem::path &p_shader, const std::vector<std::string> &p_defines);
+    static Entry load(const std::filesystem::path &p_shader, const std::vector<std::string> &p_defines, bool &p_compiled);
+    static void loadCacheFile();
+
+    static std::mutex s_mutex;
+    static std::filesystem::path s_cache_file;
+    // shaders resolved since init, by path and defines
+    static std::unordered_map<std::string, Entry> s_entries;
+    // entries of the cache file read by init, decoded on first use
+    static std::vector<char> s_cache_data;
+    static std::unordered_map<std::string, CacheRecord> s_cache_records;
+    static bool s_dirty;
+};
+
+}  // namespace TTe
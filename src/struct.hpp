@@ -4,6 +4,7 @@
 #include <functional>
 #include <glm/fwd.hpp>
 #include <glm/glm.hpp>
+#include <limits>
 #include <string>
 
 namespace TTe {
@@ -30,8 +31,9 @@ struct MeshBlock{
     glm::vec3 pmax;
     uint indexOffset;
     uint indexSize;
-    int instancesID;
-    glm::vec2 padding;
+    uint firstInstance;  // offset in the instance id list, shared by every block of the same mesh
+    uint instanceCount;
+    uint visibleOffset;  // offset of the block's slots in the visible instance list written by cull.comp
 };
 
 struct MaterialGPU {
@@ -50,6 +52,17 @@ struct Vertex {
     uint32_t material_id;
 };
 
+// collider shape read by the GPU simulations (cloth_step.comp)
+struct ColliderGPU {
+    enum Type : uint32_t { PLANE, SPHERE, CUBE, CAPSULE };
+    glm::mat4 world_matrix;  // unit shape space to world space
+    glm::mat4 inv_world_matrix;
+    glm::vec4 a{0};  // capsule : first end in world space, w = radius
+    glm::vec4 b{0};  // capsule : second end in world space
+    uint32_t type = PLANE;
+    glm::uvec3 padding{0};
+};
+
 struct Ubo {
     glm::mat4 projection;
     glm::mat4 view;
@@ -60,6 +73,36 @@ struct BoundingBox {
     glm::vec3 pmin = {0,0,0};
     glm::vec3 pmax = {0,0,0};
 
+    // box containing everything, for unbounded shapes (planes...)
+    static BoundingBox infinite() {
+        return {glm::vec3(-std::numeric_limits<float>::max()), glm::vec3(std::numeric_limits<float>::max())};
+    }
+    // empty box, to grow with expand
+    static BoundingBox empty() {
+        return {glm::vec3(std::numeric_limits<float>::max()), glm::vec3(-std::numeric_limits<float>::max())};
+    }
+
+    void expand(const glm::vec3 &p) {
+        pmin = glm::min(pmin, p);
+        pmax = glm::max(pmax, p);
+    }
+
+    bool contains(const glm::vec3 &p) const { return glm::all(glm::greaterThanEqual(p, pmin)) && glm::all(glm::lessThanEqual(p, pmax)); }
+
+    bool overlaps(const BoundingBox &other) const {
+        return glm::all(glm::lessThanEqual(pmin, other.pmax)) && glm::all(glm::greaterThanEqual(pmax, other.pmin));
+    }
+
+    // bounds of this box once transformed by p_matrix
+    BoundingBox transform(const glm::mat4 &p_matrix) const {
+        BoundingBox result = empty();
+        for (int i = 0; i < 8; i++) {
+            glm::vec3 corner = {(i & 1) ? pmax.x : pmin.x, (i & 2) ? pmax.y : pmin.y, (i & 4) ? pmax.z : pmin.z};
+            result.expand(glm::vec3(p_matrix * glm::vec4(corner, 1.f)));
+        }
+        return result;
+    }
+
     float intersect(const glm::vec3 &origin, const glm::vec3 &direction) {
         float txpmin = (pmin.x - origin.x) / direction.x;
         float txpmax = (pmax.x - origin.x) / direction.x;